@@ -0,0 +1,64 @@
+#ifndef CHESS_BENCH_UTILS_H
+#define CHESS_BENCH_UTILS_H
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../engine/engineProtocol.h"
+
+/**
+ * Helpers shared by the benchmarks
+ */
+class BenchUtils {
+public:
+	/**
+	 * Read the moves listed by the engine protocol's "moves" command
+	 *
+	 * @param distance only keep the moves that move a piece by this distance, or 0 to keep every move
+	 */
+	inline static std::vector<std::string> readMoves(
+		EngineProtocol& protocol, std::ostringstream& output, int distance = 0
+	) {
+		output.str("");
+		protocol.handleCommand("moves");
+
+		std::istringstream line(output.str());
+		std::vector<std::string> moves;
+		std::string word;
+		line >> word;
+		while (line >> word) {
+			int fromX, fromY, toX, toY;
+			if (distance == 0 || (
+				std::sscanf(word.c_str(), "%d,%d:%d,%d", &fromX, &fromY, &toX, &toY) == 4 &&
+				std::max(std::abs(toX - fromX), std::abs(toY - fromY)) == distance
+			)) {
+				moves.push_back(word);
+			}
+		}
+
+		return moves;
+	}
+
+	/**
+	 * Draw a number of frames offscreen and get the mean time taken for each in milliseconds. The texture is copied
+	 * back after the last frame, so that the frames queued on the GPU are counted too.
+	 */
+	template <typename Draw>
+	inline static float timeFrames(sf::RenderTexture& target, unsigned int numFrames, Draw draw) {
+		sf::Clock timer;
+		for (unsigned int i = 0; i < numFrames; i++) {
+			target.clear(sf::Color::Black);
+			draw();
+			target.display();
+		}
+
+		target.getTexture().copyToImage();
+		return timer.getElapsedTime().asMicroseconds() / 1000.f / numFrames;
+	}
+};
+
+#endif // CHESS_BENCH_UTILS_H
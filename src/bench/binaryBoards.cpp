@@ -0,0 +1,116 @@
+#include <SFML/Graphics.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <tuple>
+#include "syntheticBoards.h"
+#include "../components/piece.h"
+#include "../components/pieceDef.h"
+#include "../io/binaryBoard.h"
+#include "../io/boardLoader.h"
+#include "../io/pieceDefLoader.h"
+#include "../io/resourceLoader.h"
+#include "../utils/vectorUtils.h"
+
+// Helpers
+
+/**
+ * Delete a loaded board
+ */
+void deleteBoard(
+	std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams,
+	std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces
+) {
+	for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::iterator i = pieces->begin();
+		i != pieces->end(); ++i
+	) {
+		delete i->second;
+	}
+
+	delete pieces;
+	delete teams;
+}
+
+/**
+ * Benchmark comparing the binary board format with the text format on generated boards of 10^3 pieces and up. Each
+ * board is saved in both formats, and the size of each file and the mean time taken to load it, including building
+ * the pieces, are reported.
+ *
+ * Usage: binaryBoards [--pieces N] [--runs R] [--seed S]
+ */
+int main(int argc, char* argv[]) {
+	unsigned int maxPieces = 1000000;
+	unsigned int numRuns = 3;
+	unsigned int seed = 0;
+
+	// Read the options
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		const unsigned int value = std::strtoul(argv[i + 1], nullptr, 10);
+		if (option == "--pieces") {
+			maxPieces = value;
+		} else if (option == "--runs") {
+			numRuns = value;
+		} else if (option == "--seed") {
+			seed = value;
+		} else {
+			std::cerr << "Invalid option: " << option << std::endl;
+			return 1;
+		}
+	}
+
+	if (numRuns == 0) {
+		numRuns = 1;
+	}
+
+	const std::string TEXT_FILE = "binaryBoards.chess";
+	const std::string BINARY_FILE = "binaryBoards" + BinaryBoard::getExtension();
+	std::map<std::string, const PieceDef*>* pieceDefs = PieceDefLoader::loadPieceDefs("res/pieces.def");
+	std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams;
+	unsigned int curTurn;
+	std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces;
+
+	std::cout << std::fixed << std::setprecision(2);
+
+	for (unsigned int numPieces = 1000; numPieces <= maxPieces; numPieces *= 10) {
+		// Save the board in both formats
+		const std::string board = SyntheticBoards::army(numPieces, numPieces / 100, 2, seed);
+		ResourceLoader::write(TEXT_FILE, board);
+		std::tie(teams, curTurn, pieces) = BoardLoader::loadBoardFromString(board, pieceDefs);
+		const std::size_t binarySize = BinaryBoard::toBytes(teams, curTurn, pieces).length();
+		BinaryBoard::saveBoard(BINARY_FILE, teams, curTurn, pieces);
+		deleteBoard(teams, pieces);
+
+		sf::Clock timer;
+		for (unsigned int run = 0; run < numRuns; run++) {
+			std::tie(teams, curTurn, pieces) = BoardLoader::loadBoard(TEXT_FILE, pieceDefs);
+			deleteBoard(teams, pieces);
+		}
+		const float textMillis = timer.getElapsedTime().asMicroseconds() / 1000.f / numRuns;
+
+		timer.restart();
+		for (unsigned int run = 0; run < numRuns; run++) {
+			std::tie(teams, curTurn, pieces) = BinaryBoard::loadBoard(BINARY_FILE, pieceDefs);
+			deleteBoard(teams, pieces);
+		}
+		const float binaryMillis = timer.getElapsedTime().asMicroseconds() / 1000.f / numRuns;
+
+		std::cout << (numPieces + 2) << " pieces: text " << (board.length() / 1024) << " KB in " << textMillis <<
+			" ms, binary " << (binarySize / 1024) << " KB in " << binaryMillis << " ms, " <<
+			((float) board.length() / binarySize) << "x smaller, " << (textMillis / binaryMillis) << "x faster" <<
+			std::endl;
+	}
+
+	// Clean up
+	std::remove(TEXT_FILE.c_str());
+	std::remove(BINARY_FILE.c_str());
+	for (std::map<std::string, const PieceDef*>::iterator i = pieceDefs->begin(); i != pieceDefs->end(); ++i) {
+		delete i->second;
+	}
+	delete pieceDefs;
+
+	return 0;
+}
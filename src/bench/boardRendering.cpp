@@ -0,0 +1,104 @@
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "benchUtils.h"
+#include "../renderer.h"
+
+// Helpers
+
+/**
+ * Draw the board with one call for each coloured tile, as the renderer did before the tiles were batched
+ */
+void drawTiles(sf::RenderTarget& target, sf::Vector2u dimensions, unsigned int parity, float tileSize, sf::Color color) {
+	sf::RectangleShape tile(sf::Vector2f(tileSize, tileSize));
+	tile.setFillColor(color);
+
+	for (unsigned int x = 0; x < dimensions.x; x++) {
+		for (unsigned int y = 0; y < dimensions.y; y++) {
+			if ((x + y) % 2 == parity) {
+				tile.setPosition(tileSize * x, tileSize * y);
+				target.draw(tile);
+			}
+		}
+	}
+}
+
+/**
+ * Draw the board from a vertex array in one call
+ */
+void drawVertices(sf::RenderTarget& target, const sf::VertexArray& vertices) {
+	target.draw(vertices);
+}
+
+/**
+ * Benchmark for drawing the board offscreen at several tile sizes, comparing one draw call for each tile with the
+ * single vertex array that the renderer draws. The time taken to rebuild the vertex array, which is only done when
+ * the window is resized or zoomed, is reported separately.
+ *
+ * Usage: boardRendering [--width W] [--height H] [--frames N]
+ */
+int main(int argc, char* argv[]) {
+	unsigned int width = 3840;
+	unsigned int height = 2160;
+	unsigned int numFrames = 100;
+
+	// Read the options
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		const unsigned int value = std::strtoul(argv[i + 1], nullptr, 10);
+		if (option == "--width") {
+			width = value;
+		} else if (option == "--height") {
+			height = value;
+		} else if (option == "--frames") {
+			numFrames = value;
+		} else {
+			std::cerr << "Invalid option: " << option << std::endl;
+			return 1;
+		}
+	}
+
+	sf::RenderTexture target;
+	if (numFrames == 0 || !target.create(width, height)) {
+		std::cerr << "Could not create a " << width << "x" << height << " render texture" << std::endl;
+		return 1;
+	}
+
+	const unsigned int TILE_PADDING = 3;
+	const float TILE_SIZES[] = {16.f, 32.f, 64.f, 128.f, 256.f};
+	const sf::Color color(50, 50, 50, 255);
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << width << "x" << height << ", " << numFrames << " frames" << std::endl;
+	for (float tileSize : TILE_SIZES) {
+		// Find the dimensions of the board as the renderer does
+		sf::Vector2u dimensions(
+			2 * (TILE_PADDING + std::floor(width / tileSize / 2.f)),
+			2 * (TILE_PADDING + std::floor(height / tileSize / 2.f))
+		);
+		const unsigned int parity = ((dimensions.x + dimensions.y) / 2) % 2;
+
+		sf::Clock timer;
+		sf::VertexArray vertices;
+		Renderer::buildBoard(vertices, dimensions, parity, tileSize, color);
+		const float buildMillis = timer.getElapsedTime().asMicroseconds() / 1000.f;
+
+		const float tileMillis = BenchUtils::timeFrames(target, numFrames, [&]() {
+			drawTiles(target, dimensions, parity, tileSize, color);
+		});
+		const float vertexMillis = BenchUtils::timeFrames(target, numFrames, [&]() {
+			drawVertices(target, vertices);
+		});
+
+		std::cout << "tile size " << std::setprecision(0) << tileSize << ": " << (vertices.getVertexCount() / 4) <<
+			" tiles, per tile " << std::setprecision(3) << tileMillis << " ms, vertex array " << vertexMillis <<
+			" ms per frame, speedup " << std::setprecision(1) << (tileMillis / vertexMillis) << "x, rebuild " <<
+			std::setprecision(3) << buildMillis << " ms" << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,182 @@
+#include <SFML/Graphics.hpp>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "benchUtils.h"
+#include "../game.h"
+#include "../components/event.h"
+#include "../engine/engineProtocol.h"
+#include "../utils/stringUtils.h"
+#include "../utils/vectorUtils.h"
+
+// Helpers
+
+/**
+ * An event as it was stored before events were typed, with its arguments written as a string
+ */
+struct StringEvent {
+	const std::string action;
+	const std::string args;
+};
+
+/**
+ * Queue and dispatch the events for a move in the string format, returning a checksum of the decoded values
+ */
+long long runStringEvents(int moveIndex, sf::Vector2i dest) {
+	std::vector<StringEvent*> queue;
+	queue.push_back(new StringEvent{ "leave", "" });
+	queue.push_back(new StringEvent{ "move", std::to_string(moveIndex) + "," + VectorUtils::toString(dest) + "," });
+	queue.push_back(new StringEvent{ "enter", "" });
+
+	long long checksum = 0;
+	for (std::vector<StringEvent*>::iterator i = queue.begin(); i != queue.end(); ++i) {
+		if ("enter" == (*i)->action) {
+			checksum += 1;
+		} else if ("leave" == (*i)->action) {
+			checksum += 2;
+		} else if ("move" == (*i)->action) {
+			std::vector<std::string>* args = StringUtils::getList((*i)->args, ',', '[', ']');
+			const sf::Vector2i pos = VectorUtils::fromString((*args)[1]);
+			checksum += std::stoi((*args)[0]) + pos.x + pos.y;
+			delete args;
+		}
+
+		delete *i;
+	}
+
+	return checksum;
+}
+
+/**
+ * Queue and dispatch the events for a move in the typed format, returning a checksum of the decoded values
+ */
+long long runTypedEvents(std::vector<Event>& queue, int moveIndex, sf::Vector2i dest) {
+	queue.push_back(Event(nullptr, Event::LEAVE));
+	queue.push_back(Event(nullptr, Event::MOVE, moveIndex, dest));
+	queue.push_back(Event(nullptr, Event::ENTER));
+
+	long long checksum = 0;
+	for (std::vector<Event>::const_iterator i = queue.begin(); i != queue.end(); ++i) {
+		switch (i->action) {
+		case Event::ENTER:
+			checksum += 1;
+			break;
+		case Event::LEAVE:
+			checksum += 2;
+			break;
+		case Event::MOVE:
+			checksum += i->moveIndex + i->dest.x + i->dest.y;
+			break;
+		default:
+			break;
+		}
+	}
+
+	queue.clear();
+	return checksum;
+}
+
+/**
+ * Benchmark for the event queues
+ *
+ * Measures encoding and dispatching the events for a move in the old string format and the typed format, then the
+ * number of moves per second made through the controller on a saved board.
+ *
+ * Usage: eventThroughput [board.chess] [--moves N] [--plies P]
+ */
+int main(int argc, char* argv[]) {
+	std::string boardFileName = "saves/original.chess";
+	unsigned int numEvents = 1000000;
+	unsigned int numMoves = 2000;
+	unsigned int maxPlies = 40;
+
+	// Read the options
+	int argIndex = 1;
+	if (argIndex < argc && argv[argIndex][0] != '-') {
+		boardFileName = argv[argIndex++];
+	}
+
+	for (; argIndex + 1 < argc; argIndex += 2) {
+		const std::string option = argv[argIndex];
+		const unsigned int value = std::strtoul(argv[argIndex + 1], nullptr, 10);
+		if (option == "--moves") {
+			numMoves = value;
+		} else if (option == "--plies") {
+			maxPlies = value;
+		} else if (option == "--events") {
+			numEvents = value;
+		} else {
+			std::cerr << "Invalid option: " << option << std::endl;
+			return 1;
+		}
+	}
+
+	std::cout << std::fixed << std::setprecision(1);
+
+	// Encode and dispatch events without touching the board
+	sf::Clock timer;
+	long long stringChecksum = 0;
+	for (unsigned int i = 0; i < numEvents; i++) {
+		stringChecksum += runStringEvents(i % 64, sf::Vector2i(i % 17 - 8, i % 13 - 6));
+	}
+	const float stringSeconds = timer.restart().asSeconds();
+
+	std::vector<Event> queue;
+	long long typedChecksum = 0;
+	for (unsigned int i = 0; i < numEvents; i++) {
+		typedChecksum += runTypedEvents(queue, i % 64, sf::Vector2i(i % 17 - 8, i % 13 - 6));
+	}
+	const float typedSeconds = timer.restart().asSeconds();
+
+	if (stringChecksum != typedChecksum) {
+		std::cerr << "Checksums differ: " << stringChecksum << " " << typedChecksum << std::endl;
+		return 1;
+	}
+
+	std::cout << std::setw(8) << std::left << "string" << std::setw(14) << std::right <<
+		(3 * numEvents / stringSeconds / 1e6) << " M events/s" << std::endl;
+	std::cout << std::setw(8) << std::left << "typed" << std::setw(14) << std::right <<
+		(3 * numEvents / typedSeconds / 1e6) << " M events/s" << std::endl;
+
+	// Make moves through the controller, restarting the game every few moves
+	const unsigned int GENERATION_MARGIN = 8;
+	Game game(GENERATION_MARGIN);
+	std::ostringstream output;
+	EngineProtocol protocol(&game, output);
+
+	float moveSeconds = 0;
+	unsigned int movesMade = 0;
+	unsigned int ply = maxPlies;
+	while (movesMade < numMoves) {
+		if (ply >= maxPlies) {
+			protocol.handleCommand("load " + boardFileName);
+			ply = 0;
+		}
+
+		const std::vector<std::string> moves = BenchUtils::readMoves(protocol, output);
+		if (moves.empty()) {
+			ply = maxPlies;
+			if (movesMade == 0) {
+				std::cerr << "No moves on " << boardFileName << ": " << output.str();
+				return 1;
+			}
+
+			continue;
+		}
+
+		timer.restart();
+		protocol.handleCommand("move " + moves[(movesMade * 7 + ply) % moves.size()]);
+		moveSeconds += timer.getElapsedTime().asSeconds();
+
+		movesMade++;
+		ply++;
+	}
+
+	std::cout << std::setw(8) << std::left << "moves" << std::setw(14) << std::right <<
+		((moveSeconds > 0) ? (movesMade / moveSeconds) : (0)) << " moves/s" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,303 @@
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "syntheticBoards.h"
+#include "../component_trackers/actionListenerTracker.h"
+#include "../components/event.h"
+#include "../components/moveDef.h"
+#include "../components/moveMarker.h"
+#include "../components/piece.h"
+#include "../io/boardLoader.h"
+#include "../io/pieceDefLoader.h"
+
+// Allocation counting
+
+namespace {
+	/**
+	 * The number of bytes allocated with new and not yet deleted
+	 */
+	std::size_t liveBytes = 0;
+
+	/**
+	 * Room in front of each allocation for its size, keeping the alignment that new guarantees
+	 */
+	const std::size_t HEADER_SIZE = alignof(std::max_align_t);
+}
+
+void* operator new(std::size_t size) {
+	char* block = static_cast<char*>(std::malloc(size + HEADER_SIZE));
+	if (block == nullptr) throw std::bad_alloc();
+
+	*reinterpret_cast<std::size_t*>(block) = size;
+	liveBytes += size;
+	return block + HEADER_SIZE;
+}
+
+/**
+ * Not inlined, so that the compiler does not mistake freeing the block for freeing the pointer returned by new
+ */
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+	if (p == nullptr) return;
+
+	char* block = static_cast<char*>(p) - HEADER_SIZE;
+	liveBytes -= *reinterpret_cast<std::size_t*>(block);
+	std::free(block);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	operator delete(p);
+}
+
+// Helper classes
+
+/**
+ * The listener tables that ActionListenerTracker used before listeners were grouped by chunk: a set of listeners
+ * for each position
+ */
+class PerSquareListeners {
+private:
+	std::map<sf::Vector2i, std::unordered_set<MoveMarker*>*, VectorUtils::cmpVectorLexicographically> actionListeners;
+	std::unordered_map<MoveMarker*, std::vector<sf::Vector2i>> listenerPositions;
+
+public:
+	~PerSquareListeners() {
+		for (std::map<
+			sf::Vector2i, std::unordered_set<MoveMarker*>*, VectorUtils::cmpVectorLexicographically
+		>::iterator i = actionListeners.begin(); i != actionListeners.end(); ++i) {
+			delete i->second;
+		}
+	}
+
+	void addListeners(MoveMarker* marker) {
+		const std::vector<sf::Vector2i>* targetPositions = marker->getTargetedPositions();
+		for (std::vector<sf::Vector2i>::const_iterator i = targetPositions->begin(); i != targetPositions->end(); ++i) {
+			std::unordered_set<MoveMarker*>*& positionListeners = actionListeners[*i];
+			if (positionListeners == nullptr) {
+				positionListeners = new std::unordered_set<MoveMarker*>();
+			}
+
+			if (positionListeners->insert(marker).second) {
+				listenerPositions[marker].push_back(*i);
+			}
+		}
+
+		delete targetPositions;
+	}
+
+	void removeListeners(MoveMarker* marker) {
+		std::unordered_map<MoveMarker*, std::vector<sf::Vector2i>>::iterator positionsIter =
+			listenerPositions.find(marker);
+		if (positionsIter == listenerPositions.end()) return;
+
+		for (std::vector<sf::Vector2i>::const_iterator i = positionsIter->second.begin();
+			i != positionsIter->second.end(); ++i
+		) {
+			std::map<
+				sf::Vector2i, std::unordered_set<MoveMarker*>*, VectorUtils::cmpVectorLexicographically
+			>::iterator triggerIter = actionListeners.find(*i);
+			if (triggerIter->second->erase(marker) != 0 && triggerIter->second->empty()) {
+				delete triggerIter->second;
+				actionListeners.erase(triggerIter);
+			}
+		}
+
+		listenerPositions.erase(positionsIter);
+	}
+
+	void notify(sf::Vector2i positionToNotify, const Event& event) {
+		std::map<
+			sf::Vector2i, std::unordered_set<MoveMarker*>*, VectorUtils::cmpVectorLexicographically
+		>::iterator triggerIter = actionListeners.find(positionToNotify);
+		if (triggerIter == actionListeners.end()) return;
+
+		for (std::unordered_set<MoveMarker*>::iterator i = triggerIter->second->begin();
+			i != triggerIter->second->end(); ++i
+		) {
+			(*i)->handleEvent(event);
+		}
+	}
+};
+
+// Helpers
+
+/**
+ * Generate the rays of every piece on a board, ignoring obstructions, up to the given number of steps
+ */
+std::vector<MoveMarker*> generateRays(const std::vector<Piece*>& pieces, unsigned int range) {
+	std::vector<MoveMarker*> markers;
+	for (std::vector<Piece*>::const_iterator i = pieces.begin(); i != pieces.end(); ++i) {
+		const std::map<int, const MoveDef*>* moves = (*i)->getDef()->moves;
+		for (std::map<int, const MoveDef*>::const_iterator j = moves->begin(); j != moves->end(); ++j) {
+			const MoveDef* move = j->second;
+			const unsigned int length = (move->constantMultiple == 0) ? (range) : (move->constantMultiple);
+
+			const std::vector<MoveMarker*>* firstMarkers = move->generateMarkers(*i);
+			for (std::vector<MoveMarker*>::const_iterator k = firstMarkers->begin(); k != firstMarkers->end(); ++k) {
+				const MoveMarker* first = *k;
+				markers.push_back(*k);
+				for (unsigned int lambda = 2; lambda <= length; lambda++) {
+					markers.push_back(new MoveMarker(
+						*i, move, first->getBaseVector(), first->getPos() + first->getBaseVector() * (int) (lambda - 1),
+						first->switchedX, first->switchedY, first->switchedXY, lambda
+					));
+				}
+			}
+
+			delete firstMarkers;
+		}
+	}
+
+	return markers;
+}
+
+/**
+ * Register every marker's listeners, notify random positions, then remove every marker's listeners, reporting the
+ * memory taken by the listeners and the time taken by each step
+ */
+template <typename Listeners>
+void run(
+	const std::string& name, const std::vector<MoveMarker*>& markers, const std::vector<sf::Vector2i>& positions,
+	const Event& event
+) {
+	sf::Clock timer;
+	const std::size_t before = liveBytes;
+	Listeners* listeners = new Listeners();
+	for (std::vector<MoveMarker*>::const_iterator i = markers.begin(); i != markers.end(); ++i) {
+		listeners->addListeners(*i);
+	}
+
+	const float addMillis = timer.getElapsedTime().asMicroseconds() / 1000.f;
+	const std::size_t bytes = liveBytes - before;
+
+	timer.restart();
+	for (std::vector<sf::Vector2i>::const_iterator i = positions.begin(); i != positions.end(); ++i) {
+		listeners->notify(*i, event);
+	}
+
+	const float notifyMicros = timer.getElapsedTime().asMicroseconds();
+
+	timer.restart();
+	for (std::vector<MoveMarker*>::const_iterator i = markers.begin(); i != markers.end(); ++i) {
+		listeners->removeListeners(*i);
+	}
+
+	const float removeMillis = timer.getElapsedTime().asMicroseconds() / 1000.f;
+	delete listeners;
+
+	std::cout << name << ": " << (bytes / 1024.f) << " KiB, add " << addMillis << " ms, notify " <<
+		(notifyMicros * 1000 / positions.size()) << " ns, remove " << removeMillis << " ms" << std::endl;
+}
+
+/**
+ * Benchmark for the memory taken by the action listeners and the time taken to notify them, comparing the listeners
+ * grouped by chunk with a set of listeners for each position
+ *
+ * Every piece's rays are generated up to the given range, ignoring obstructions, as they are when the window is
+ * zoomed out. Positions within the range of the pieces are notified at random.
+ *
+ * Usage: listenerFootprint [board.chess] [--riders N] [--spacing S] [--range R] [--notifies N] [--seed S]
+ */
+int main(int argc, char* argv[]) {
+	std::string fileName;
+	unsigned int riders = 300;
+	unsigned int spacing = 3;
+	unsigned int range = 64;
+	unsigned int numNotifies = 1000000;
+	unsigned int seed = 0;
+
+	// Read the options
+	int firstOption = 1;
+	if (argc > 1 && argv[1][0] != '-') {
+		fileName = argv[1];
+		firstOption = 2;
+	}
+
+	for (int i = firstOption; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		const unsigned int value = std::strtoul(argv[i + 1], nullptr, 10);
+		if (option == "--riders") {
+			riders = value;
+		} else if (option == "--spacing") {
+			spacing = value;
+		} else if (option == "--range") {
+			range = value;
+		} else if (option == "--notifies") {
+			numNotifies = value;
+		} else if (option == "--seed") {
+			seed = value;
+		} else {
+			std::cerr << "Invalid option: " << option << std::endl;
+			return 1;
+		}
+	}
+
+	// Load the board
+	std::map<std::string, const PieceDef*>* pieceDefs = PieceDefLoader::loadPieceDefs("res/pieces.def");
+	std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams;
+	unsigned int curTurn;
+	std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* board;
+	std::tie(teams, curTurn, board) = fileName.empty() ?
+		(BoardLoader::loadBoardFromString(SyntheticBoards::riders(riders / 2, spacing, seed), pieceDefs)) :
+		(BoardLoader::loadBoard(fileName, pieceDefs));
+
+	std::vector<Piece*> pieces;
+	sf::IntRect bounds(board->begin()->first, sf::Vector2i(1, 1));
+	for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::const_iterator i = board->begin();
+		i != board->end(); ++i
+	) {
+		pieces.push_back(i->second);
+		const int right = std::max(bounds.left + bounds.width, i->first.x + 1);
+		const int bottom = std::max(bounds.top + bounds.height, i->first.y + 1);
+		bounds.left = std::min(bounds.left, i->first.x);
+		bounds.top = std::min(bounds.top, i->first.y);
+		bounds.width = right - bounds.left;
+		bounds.height = bottom - bounds.top;
+	}
+
+	const std::vector<MoveMarker*> markers = generateRays(pieces, range);
+
+	// Notify positions around the pieces, most of which are listened to by a few rays
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<int> x(bounds.left - (int) range, bounds.left + bounds.width + (int) range);
+	std::uniform_int_distribution<int> y(bounds.top - (int) range, bounds.top + bounds.height + (int) range);
+	std::vector<sf::Vector2i> positions;
+	for (unsigned int i = 0; i < numNotifies; i++) {
+		positions.push_back(sf::Vector2i(x(random), y(random)));
+	}
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << pieces.size() << " pieces, " << markers.size() << " markers, " <<
+		ActionListenerTracker::CHUNK_SIZE << "x" << ActionListenerTracker::CHUNK_SIZE << " chunks" << std::endl;
+
+	const Event event(pieces.front(), Event::NOTHING);
+	run<PerSquareListeners>("per square", markers, positions, event);
+	run<ActionListenerTracker>("per chunk", markers, positions, event);
+
+	// Clean up
+	for (std::vector<MoveMarker*>::const_iterator i = markers.begin(); i != markers.end(); ++i) {
+		delete *i;
+	}
+
+	for (std::vector<Piece*>::const_iterator i = pieces.begin(); i != pieces.end(); ++i) {
+		delete *i;
+	}
+
+	delete board;
+	delete teams;
+	for (std::map<std::string, const PieceDef*>::iterator i = pieceDefs->begin(); i != pieceDefs->end(); ++i) {
+		delete i->second;
+	}
+
+	delete pieceDefs;
+	return 0;
+}
@@ -0,0 +1,100 @@
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "benchUtils.h"
+#include "syntheticBoards.h"
+#include "../game.h"
+#include "../engine/engineProtocol.h"
+
+/**
+ * Stress benchmark for moves that cross long rays
+ *
+ * Scatters knights among a few riders that are far apart, and generates the riders' markers far past the board as a
+ * zoomed-out window would. Only the knights' moves are timed, so that the time is spent updating the obstructions on
+ * rays that are hundreds of markers long rather than regenerating the moving piece's markers.
+ *
+ * Usage: longRays [--riders N] [--knights N] [--spacing S] [--margin M] [--moves N] [--seed S]
+ */
+int main(int argc, char* argv[]) {
+	unsigned int riders = 16;
+	unsigned int knights = 16;
+	unsigned int spacing = 32;
+	unsigned int margin = 512;
+	unsigned int numMoves = 100;
+	unsigned int seed = 0;
+
+	// Read the options
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		const unsigned int value = std::strtoul(argv[i + 1], nullptr, 10);
+		if (option == "--riders") {
+			riders = value;
+		} else if (option == "--knights") {
+			knights = value;
+		} else if (option == "--spacing") {
+			spacing = value;
+		} else if (option == "--margin") {
+			margin = value;
+		} else if (option == "--moves") {
+			numMoves = value;
+		} else if (option == "--seed") {
+			seed = value;
+		} else {
+			std::cerr << "Invalid option: " << option << std::endl;
+			return 1;
+		}
+	}
+
+	// Load the board
+	Game game(margin);
+	std::ostringstream output;
+	EngineProtocol protocol(&game, output);
+
+	sf::Clock timer;
+	protocol.handleCommand("position " + SyntheticBoards::crossing(riders, knights, spacing, seed));
+	const float loadSeconds = timer.getElapsedTime().asSeconds();
+	if (!output.str().empty()) {
+		std::cerr << output.str();
+		return 1;
+	}
+
+	// Make the moves for both teams, timing the knights' moves
+	std::vector<float> latencies;
+	for (unsigned int i = 0; i < 2 * numMoves; i++) {
+		const std::vector<std::string> moves = BenchUtils::readMoves(protocol, output);
+		if (moves.empty()) break;
+
+		timer.restart();
+		protocol.handleCommand("move " + moves[(i * 7) % moves.size()]);
+		if (i % 2 == 0) {
+			latencies.push_back(timer.getElapsedTime().asMicroseconds() / 1000.f);
+		}
+	}
+
+	if (latencies.empty()) {
+		std::cerr << "No moves" << std::endl;
+		return 1;
+	}
+
+	// Report the latencies
+	float total = 0;
+	for (std::vector<float>::const_iterator i = latencies.begin(); i != latencies.end(); ++i) {
+		total += *i;
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << riders << " riders and " << knights << " knights with a margin of " << margin << ", loaded in " <<
+		(loadSeconds * 1000) << " ms" << std::endl;
+	std::cout << latencies.size() << " moves: mean " << (total / latencies.size()) <<
+		" ms, median " << latencies[latencies.size() / 2] <<
+		" ms, p95 " << latencies[latencies.size() * 95 / 100] <<
+		" ms, max " << latencies.back() << " ms" << std::endl;
+
+	return 0;
+}
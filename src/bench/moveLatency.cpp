@@ -0,0 +1,91 @@
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "benchUtils.h"
+#include "syntheticBoards.h"
+#include "../game.h"
+#include "../engine/engineProtocol.h"
+
+/**
+ * Benchmark for the time taken to make a move on a board full of riders
+ *
+ * Usage: moveLatency [--pieces N] [--spacing S] [--moves M] [--distance D] [--seed S]
+ */
+int main(int argc, char* argv[]) {
+	unsigned int piecesPerTeam = 64;
+	unsigned int spacing = 4;
+	unsigned int numMoves = 200;
+	unsigned int distance = 1;
+	unsigned int seed = 0;
+
+	// Read the options
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		const unsigned int value = std::strtoul(argv[i + 1], nullptr, 10);
+		if (option == "--pieces") {
+			piecesPerTeam = value;
+		} else if (option == "--spacing") {
+			spacing = value;
+		} else if (option == "--moves") {
+			numMoves = value;
+		} else if (option == "--distance") {
+			distance = value;
+		} else if (option == "--seed") {
+			seed = value;
+		} else {
+			std::cerr << "Invalid option: " << option << std::endl;
+			return 1;
+		}
+	}
+
+	// Load the board
+	const unsigned int GENERATION_MARGIN = 8;
+	Game game(GENERATION_MARGIN);
+	std::ostringstream output;
+	EngineProtocol protocol(&game, output);
+
+	sf::Clock timer;
+	protocol.handleCommand("position " + SyntheticBoards::riders(piecesPerTeam, spacing, seed));
+	const float loadSeconds = timer.getElapsedTime().asSeconds();
+	if (!output.str().empty()) {
+		std::cerr << output.str();
+		return 1;
+	}
+
+	// Make the moves, timing each one
+	std::vector<float> latencies;
+	for (unsigned int i = 0; i < numMoves; i++) {
+		const std::vector<std::string> moves = BenchUtils::readMoves(protocol, output, distance);
+		if (moves.empty()) break;
+
+		timer.restart();
+		protocol.handleCommand("move " + moves[(i * 7) % moves.size()]);
+		latencies.push_back(timer.getElapsedTime().asMicroseconds() / 1000.f);
+	}
+
+	if (latencies.empty()) {
+		std::cerr << "No moves of distance " << distance << std::endl;
+		return 1;
+	}
+
+	// Report the latencies
+	float total = 0;
+	for (std::vector<float>::const_iterator i = latencies.begin(); i != latencies.end(); ++i) {
+		total += *i;
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << (2 * piecesPerTeam) << " riders, loaded in " << (loadSeconds * 1000) << " ms" << std::endl;
+	std::cout << latencies.size() << " moves: mean " << (total / latencies.size()) <<
+		" ms, median " << latencies[latencies.size() / 2] <<
+		" ms, p95 " << latencies[latencies.size() * 95 / 100] <<
+		" ms, max " << latencies.back() << " ms" << std::endl;
+
+	return 0;
+}
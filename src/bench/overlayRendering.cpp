@@ -0,0 +1,138 @@
+#include <SFML/Graphics.hpp>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "benchUtils.h"
+#include "../game.h"
+#include "../component_trackers/moveTracker.h"
+#include "../components/moveMarker.h"
+#include "../components/piece.h"
+#include "../engine/engineProtocol.h"
+
+// Helpers
+
+/**
+ * Draw the selected piece's moves with a rule evaluation and draw call for each marker, as the renderer did before the
+ * overlay was cached
+ */
+void drawMarkers(
+	sf::RenderTarget& target, const std::vector<MoveMarker*>* markers, sf::Vector2f origin, float tileSize,
+	sf::Color color
+) {
+	for (std::vector<MoveMarker*>::const_iterator i = markers->begin(); i != markers->end(); ++i) {
+		if (!(*i)->canMove(false)) continue;
+
+		sf::RectangleShape s(sf::Vector2f(tileSize, tileSize));
+		s.setFillColor(color);
+		s.setPosition(origin + sf::Vector2f((*i)->getPos()) * tileSize);
+		target.draw(s);
+	}
+}
+
+/**
+ * Build the overlay for the selected piece's moves, as the renderer does when the selection, board or camera changes
+ */
+void buildOverlay(
+	sf::VertexArray& vertices, const std::vector<MoveMarker*>* markers, sf::Vector2f origin, float tileSize,
+	sf::Color color
+) {
+	vertices.clear();
+	for (std::vector<MoveMarker*>::const_iterator i = markers->begin(); i != markers->end(); ++i) {
+		if (!(*i)->canMove(false)) continue;
+
+		Renderer::appendTile(vertices, origin + sf::Vector2f((*i)->getPos()) * tileSize, tileSize, color);
+	}
+}
+
+/**
+ * Benchmark for drawing the overlay of a selected piece's moves offscreen on a zoomed-out view, comparing a rule
+ * evaluation and draw call for each move marker with the cached overlay that the renderer draws in one call
+ *
+ * The piece stands alone in the middle of the view, with its markers generated up to the margin. The time taken to
+ * rebuild the cached overlay, which is only done when the selection, board or camera changes, is reported separately.
+ *
+ * Usage: overlayRendering [--piece NAME] [--margin M] [--tile-size T] [--width W] [--height H] [--frames N]
+ */
+int main(int argc, char* argv[]) {
+	std::string pieceName = "Amazon";
+	unsigned int margin = 128;
+	unsigned int tileSize = 16;
+	unsigned int width = 3840;
+	unsigned int height = 2160;
+	unsigned int numFrames = 100;
+
+	// Read the options
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		const unsigned int value = std::strtoul(argv[i + 1], nullptr, 10);
+		if (option == "--piece") {
+			pieceName = argv[i + 1];
+		} else if (option == "--margin") {
+			margin = value;
+		} else if (option == "--tile-size") {
+			tileSize = value;
+		} else if (option == "--width") {
+			width = value;
+		} else if (option == "--height") {
+			height = value;
+		} else if (option == "--frames") {
+			numFrames = value;
+		} else {
+			std::cerr << "Invalid option: " << option << std::endl;
+			return 1;
+		}
+	}
+
+	// Load a board with the piece in the middle, far from the kings
+	Game game(margin);
+	std::ostringstream output;
+	EngineProtocol protocol(&game, output);
+	protocol.handleCommand(
+		"position [[[0,White,[255,255,255,255,],],[1,Black,[32,32,32,255,],],],0,[" +
+		std::string("[") + pieceName + ",0,[0,0,],0,0,-1,]," +
+		"[King,0,[" + std::to_string(2 * margin) + ",0,],0,0,-1,]," +
+		"[King,1,[" + std::to_string(2 * margin) + ",2,],1,0,-1,]," +
+		"],]"
+	);
+	if (!output.str().empty()) {
+		std::cerr << output.str();
+		return 1;
+	}
+
+	sf::RenderTexture target;
+	if (numFrames == 0 || !target.create(width, height)) {
+		std::cerr << "Could not create a " << width << "x" << height << " render texture" << std::endl;
+		return 1;
+	}
+
+	const std::vector<MoveMarker*>* markers = game.getPiece(sf::Vector2i(0, 0))->getMoveTracker()->getMoveMarkers();
+	const sf::Vector2f origin(width / 2.f, height / 2.f);
+	const sf::Color color(0, 255, 255, 100);
+
+	// Time rebuilding the overlay and each way of drawing it
+	sf::Clock timer;
+	sf::VertexArray vertices(sf::Quads);
+	buildOverlay(vertices, markers, origin, tileSize, color);
+	const float buildMillis = timer.getElapsedTime().asMicroseconds() / 1000.f;
+
+	const float markerMillis = BenchUtils::timeFrames(target, numFrames, [&]() {
+		drawMarkers(target, markers, origin, tileSize, color);
+	});
+	const float cachedMillis = BenchUtils::timeFrames(target, numFrames, [&]() {
+		target.draw(vertices);
+	});
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << pieceName << ", " << markers->size() << " markers, " << (vertices.getVertexCount() / 4) <<
+		" highlighted tiles of " << tileSize << "px" << std::endl;
+	std::cout << "per marker: " << markerMillis << " ms per frame" << std::endl;
+	std::cout << "cached: " << cachedMillis << " ms per frame, speedup " << std::setprecision(1) <<
+		(markerMillis / cachedMillis) << "x, rebuild " << std::setprecision(3) << buildMillis << " ms" << std::endl;
+
+	// Clean up
+	delete markers;
+	return 0;
+}
@@ -0,0 +1,176 @@
+#include <SFML/Graphics.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "syntheticBoards.h"
+#include "../components/piece.h"
+#include "../components/pieceDef.h"
+#include "../io/boardLoader.h"
+#include "../io/pieceDefLoader.h"
+#include "../utils/stringUtils.h"
+#include "../utils/vectorUtils.h"
+
+// Helpers
+
+/**
+ * Delete a loaded board
+ */
+void deleteBoard(
+	std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams,
+	std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces
+) {
+	for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::iterator i = pieces->begin();
+		i != pieces->end(); ++i
+	) {
+		delete i->second;
+	}
+
+	delete pieces;
+	delete teams;
+}
+
+/**
+ * Parse the pieces of a board by splitting the lists into copied substrings at each level, as the board loader did
+ * before it read the board in one pass. The teams are not checked.
+ */
+std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* splitBoard(
+	const std::string& board, const std::map<std::string, const PieceDef*>* pieceDefs
+) {
+	std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces =
+		new std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>();
+
+	std::vector<std::string>* properties = StringUtils::getList(board.substr(1, board.length() - 2), ',', '[', ']');
+	const std::string& piecesString = (*properties)[2];
+	std::vector<std::string>* pieceStrings =
+		StringUtils::getList(piecesString.substr(1, piecesString.length() - 2), ',', '[', ']');
+
+	for (std::vector<std::string>::const_iterator i = pieceStrings->begin(); i != pieceStrings->end(); ++i) {
+		std::vector<std::string>* args = StringUtils::getList(i->substr(1, i->length() - 2), ',', '[', ']');
+		const sf::Vector2i pos = VectorUtils::fromString((*args)[2]);
+		Piece* piece = new Piece(
+			pieceDefs->find((*args)[0])->second, std::stoi((*args)[1]), pos,
+			(PieceDef::Direction) (std::stoi((*args)[3]) % 4), std::stoi((*args)[4]), std::stoi((*args)[5])
+		);
+		pieces->insert(std::make_pair(pos, piece));
+		delete args;
+	}
+
+	delete pieceStrings;
+	delete properties;
+	return pieces;
+}
+
+/**
+ * Get a throughput in MB/s
+ */
+float getThroughput(std::size_t bytes, unsigned int runs, float seconds) {
+	return (seconds > 0) ? (bytes * runs / seconds / 1e6f) : (0);
+}
+
+/**
+ * Benchmark for the throughput of the board and piece definition parsers on generated boards of 10^3 pieces and up,
+ * in MB/s. The boards are parsed from a string and loaded from a file, and compared with splitting them into copied
+ * substrings at each level as the loaders did before. The piece definitions are parsed from the contents of their
+ * file.
+ *
+ * Usage: parseThroughput [--pieces N] [--runs R] [--seed S]
+ */
+int main(int argc, char* argv[]) {
+	unsigned int maxPieces = 1000000;
+	unsigned int numRuns = 3;
+	unsigned int seed = 0;
+
+	// Read the options
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		const unsigned int value = std::strtoul(argv[i + 1], nullptr, 10);
+		if (option == "--pieces") {
+			maxPieces = value;
+		} else if (option == "--runs") {
+			numRuns = value;
+		} else if (option == "--seed") {
+			seed = value;
+		} else {
+			std::cerr << "Invalid option: " << option << std::endl;
+			return 1;
+		}
+	}
+
+	if (numRuns == 0) {
+		numRuns = 1;
+	}
+
+	const std::string DEFS_FILE = "res/pieces.def";
+	const std::string BOARD_FILE = "parseThroughput.chess";
+	std::map<std::string, const PieceDef*>* pieceDefs = PieceDefLoader::loadPieceDefs(DEFS_FILE);
+	std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams;
+	unsigned int curTurn;
+	std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces;
+
+	std::cout << std::fixed << std::setprecision(1);
+
+	// Time the piece definitions
+	std::ifstream defsFile(DEFS_FILE, std::ios::in | std::ios::binary);
+	std::ostringstream defsStream;
+	defsStream << defsFile.rdbuf();
+	const std::string defs = defsStream.str();
+
+	sf::Clock timer;
+	for (unsigned int run = 0; run < numRuns; run++) {
+		std::map<std::string, const PieceDef*>* loaded = PieceDefLoader::loadPieceDefsFromString(defs);
+		for (std::map<std::string, const PieceDef*>::iterator i = loaded->begin(); i != loaded->end(); ++i) {
+			delete i->second;
+		}
+		delete loaded;
+	}
+	std::cout << "piece definitions: " << defs.length() << " bytes, " <<
+		getThroughput(defs.length(), numRuns, timer.getElapsedTime().asSeconds()) << " MB/s" << std::endl;
+
+	// Time boards of each size
+	for (unsigned int numPieces = 1000; numPieces <= maxPieces; numPieces *= 10) {
+		const std::string board = SyntheticBoards::army(numPieces, numPieces / 100, 2, seed);
+		ResourceLoader::write(BOARD_FILE, board);
+
+		timer.restart();
+		for (unsigned int run = 0; run < numRuns; run++) {
+			std::tie(teams, curTurn, pieces) = BoardLoader::loadBoardFromString(board, pieceDefs);
+			deleteBoard(teams, pieces);
+		}
+		const float parseSeconds = timer.getElapsedTime().asSeconds();
+
+		timer.restart();
+		for (unsigned int run = 0; run < numRuns; run++) {
+			std::tie(teams, curTurn, pieces) = BoardLoader::loadBoard(BOARD_FILE, pieceDefs);
+			deleteBoard(teams, pieces);
+		}
+		const float loadSeconds = timer.getElapsedTime().asSeconds();
+
+		timer.restart();
+		for (unsigned int run = 0; run < numRuns; run++) {
+			deleteBoard(nullptr, splitBoard(board, pieceDefs));
+		}
+		const float splitSeconds = timer.getElapsedTime().asSeconds();
+
+		std::cout << (numPieces + 2) << " pieces, " << (board.length() / 1024) << " KB: parse " <<
+			getThroughput(board.length(), numRuns, parseSeconds) << " MB/s, load from file " <<
+			getThroughput(board.length(), numRuns, loadSeconds) << " MB/s, split " <<
+			getThroughput(board.length(), numRuns, splitSeconds) << " MB/s, speedup " <<
+			(splitSeconds / parseSeconds) << "x" << std::endl;
+	}
+
+	// Clean up
+	std::remove(BOARD_FILE.c_str());
+	for (std::map<std::string, const PieceDef*>::iterator i = pieceDefs->begin(); i != pieceDefs->end(); ++i) {
+		delete i->second;
+	}
+	delete pieceDefs;
+
+	return 0;
+}
@@ -0,0 +1,164 @@
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "benchUtils.h"
+#include "../renderer.h"
+#include "../components/pieceDef.h"
+#include "../io/pieceDefLoader.h"
+#include "../io/resourceLoader.h"
+
+// Helper structs
+
+/**
+ * A piece to draw: its position on screen, its texture and its team color
+ */
+struct Sprite {
+	sf::Vector2f pos;
+	std::string name;
+	sf::Color color;
+};
+
+// Helpers
+
+/**
+ * Draw each piece with its own texture and draw call, as the renderer did before the textures were packed
+ */
+void drawSprites(
+	sf::RenderTarget& target, const std::vector<Sprite>& sprites, const std::map<std::string, sf::Texture*>* textures,
+	float scale
+) {
+	for (std::vector<Sprite>::const_iterator i = sprites.begin(); i != sprites.end(); ++i) {
+		sf::Sprite s;
+		s.setTexture(*(textures->find(i->name)->second));
+		s.setColor(i->color);
+		s.setScale(sf::Vector2f(scale, scale));
+		s.setPosition(i->pos);
+		target.draw(s);
+	}
+}
+
+/**
+ * Rebuild the vertices for the pieces and draw them from the atlas in one call, as the renderer does each frame
+ */
+void drawAtlas(
+	sf::RenderTarget& target, sf::VertexArray& vertices, const std::vector<Sprite>& sprites, const sf::Texture* atlas,
+	const std::map<std::string, sf::IntRect>* regions, float scale
+) {
+	vertices.clear();
+	for (std::vector<Sprite>::const_iterator i = sprites.begin(); i != sprites.end(); ++i) {
+		Renderer::appendPiece(vertices, i->pos, scale, regions->find(i->name)->second, i->color);
+	}
+
+	target.draw(vertices, sf::RenderStates(atlas));
+}
+
+/**
+ * Benchmark for drawing a square of visible pieces offscreen, comparing a sprite and draw call for each piece with
+ * the single pass over the texture atlas that the renderer makes. Each piece is given a random texture and team.
+ *
+ * Usage: pieceRendering [--pieces N] [--tile-size T] [--frames N] [--seed S]
+ */
+int main(int argc, char* argv[]) {
+	unsigned int numPieces = 10000;
+	unsigned int tileSize = 16;
+	unsigned int numFrames = 100;
+	unsigned int seed = 0;
+
+	// Read the options
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		const unsigned int value = std::strtoul(argv[i + 1], nullptr, 10);
+		if (option == "--pieces") {
+			numPieces = value;
+		} else if (option == "--tile-size") {
+			tileSize = value;
+		} else if (option == "--frames") {
+			numFrames = value;
+		} else if (option == "--seed") {
+			seed = value;
+		} else {
+			std::cerr << "Invalid option: " << option << std::endl;
+			return 1;
+		}
+	}
+
+	// Load the piece textures
+	std::map<std::string, const PieceDef*>* pieceDefs = PieceDefLoader::loadPieceDefs("res/pieces.def");
+	std::vector<std::string>* names = new std::vector<std::string>();
+	for (std::map<std::string, const PieceDef*>::const_iterator i = pieceDefs->begin(); i != pieceDefs->end(); ++i) {
+		names->push_back(i->first);
+	}
+
+	std::map<std::string, sf::Texture*>* textures =
+		ResourceLoader::loadTextures(names, "res/textures/pieces/", ".png");
+	if (textures->empty()) {
+		std::cerr << "Could not load the piece textures" << std::endl;
+		return 1;
+	}
+
+	sf::Clock timer;
+	std::map<std::string, sf::IntRect>* regions = new std::map<std::string, sf::IntRect>();
+	sf::Texture* atlas = ResourceLoader::packTextures(textures, regions);
+	const float packMillis = timer.getElapsedTime().asMicroseconds() / 1000.f;
+
+	// Lay the pieces out in a square that fills the texture
+	const unsigned int side = std::ceil(std::sqrt((float) numPieces));
+	sf::RenderTexture target;
+	if (numFrames == 0 || !target.create(side * tileSize, side * tileSize)) {
+		std::cerr << "Could not create a " << (side * tileSize) << "x" << (side * tileSize) << " render texture" <<
+			std::endl;
+		return 1;
+	}
+
+	const sf::Color TEAM_COLORS[] = {sf::Color(255, 255, 255, 255), sf::Color(32, 32, 32, 255)};
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<unsigned int> randomTexture(0, textures->size() - 1);
+	std::uniform_int_distribution<unsigned int> randomTeam(0, 1);
+	std::vector<Sprite> sprites;
+	for (unsigned int i = 0; i < numPieces; i++) {
+		std::map<std::string, sf::Texture*>::const_iterator texture = textures->begin();
+		std::advance(texture, randomTexture(random));
+		sprites.push_back(Sprite{
+			sf::Vector2f((i % side) * tileSize, (i / side) * tileSize), texture->first, TEAM_COLORS[randomTeam(random)]
+		});
+	}
+
+	// Time each way of drawing the pieces
+	const float scale = tileSize / 16.f;
+	sf::VertexArray vertices(sf::Quads);
+	const float spriteMillis = BenchUtils::timeFrames(target, numFrames, [&]() {
+		drawSprites(target, sprites, textures, scale);
+	});
+	const float atlasMillis = BenchUtils::timeFrames(target, numFrames, [&]() {
+		drawAtlas(target, vertices, sprites, atlas, regions, scale);
+	});
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << numPieces << " pieces, " << textures->size() << " textures, " << atlas->getSize().x << "x" <<
+		atlas->getSize().y << " atlas packed in " << packMillis << " ms" << std::endl;
+	std::cout << "per sprite: " << spriteMillis << " ms per frame" << std::endl;
+	std::cout << "atlas: " << atlasMillis << " ms per frame, speedup " << std::setprecision(1) <<
+		(spriteMillis / atlasMillis) << "x" << std::endl;
+
+	// Clean up
+	delete atlas;
+	delete regions;
+	for (std::map<std::string, sf::Texture*>::iterator i = textures->begin(); i != textures->end(); ++i) {
+		delete i->second;
+	}
+
+	delete textures;
+	delete names;
+	for (std::map<std::string, const PieceDef*>::iterator i = pieceDefs->begin(); i != pieceDefs->end(); ++i) {
+		delete i->second;
+	}
+
+	delete pieceDefs;
+	return 0;
+}
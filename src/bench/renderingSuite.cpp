@@ -0,0 +1,299 @@
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "syntheticBoards.h"
+#include "../game.h"
+#include "../renderer.h"
+#include "../engine/engineProtocol.h"
+#include "../io/pieceDefLoader.h"
+#include "../io/resourceLoader.h"
+#include "../ui/clickable.h"
+#include "../ui/button.h"
+#include "../ui/windowLayer.h"
+#include "../utils/metrics.h"
+
+// Helper structs
+
+/**
+ * A generated board and the tile that the camera scripts start from
+ */
+struct Scenario {
+	std::string name;
+	std::string board;
+	sf::Vector2f focus;
+};
+
+/**
+ * The phases of a frame that are timed, with their columns in the results
+ */
+struct Phase {
+	Metrics::Probe probe;
+	std::string column;
+};
+
+const Phase PHASES[] = {
+	{ Metrics::DRAW_BOARD,    "board"    },
+	{ Metrics::DRAW_PIECES,   "pieces"   },
+	{ Metrics::DRAW_OVERLAYS, "overlays" },
+	{ Metrics::DRAW_UI,       "ui"       },
+	{ Metrics::DRAW_DISPLAY,  "display"  }
+};
+const unsigned int NUM_PHASES = sizeof(PHASES) / sizeof(PHASES[0]);
+
+const std::string SCRIPTS[] = { "still", "pan", "zoom", "select" };
+const unsigned int NUM_SCRIPTS = sizeof(SCRIPTS) / sizeof(SCRIPTS[0]);
+
+// Helpers
+
+/**
+ * Get the calls to a probe that were recorded since its histogram was read
+ */
+Metrics::Histogram since(Metrics::Probe probe, const Metrics::Histogram& before) {
+	Metrics::Histogram after = Metrics::read(probe);
+	after.count -= before.count;
+	after.totalNanos -= before.totalNanos;
+	for (unsigned int i = 0; i < Metrics::NUM_BUCKETS; i++) {
+		after.buckets[i] -= before.buckets[i];
+	}
+
+	return after;
+}
+
+/**
+ * Move the camera for a frame of a script. The camera circles the focus while panning, and the tile size sweeps from
+ * the largest to the smallest and back while zooming, by the same factor each frame.
+ */
+void moveCamera(
+	Renderer& renderer, const std::string& script, sf::Vector2f focus, float radius, unsigned int frame,
+	unsigned int numFrames
+) {
+	const float PI = 3.14159265f;
+	const float MIN_TILE_SIZE = 0.01f;
+	const float MAX_TILE_SIZE = 256.f;
+
+	if (script == "pan" || script == "select") {
+		const float angle = 2 * PI * frame / numFrames;
+		renderer.setCameraPos(focus + radius * sf::Vector2f(std::cos(angle), std::sin(angle)));
+	} else if (script == "zoom") {
+		const float progress = 1 - std::abs(2.f * frame / numFrames - 1);
+		renderer.setTileSize(MAX_TILE_SIZE * std::pow(MIN_TILE_SIZE / MAX_TILE_SIZE, progress));
+	}
+
+	renderer.needsRedraw = true;
+}
+
+/**
+ * Select the piece of the team whose turn it is that is nearest to the focus, searching outwards ring by ring
+ *
+ * @return false if there is no such piece within the range
+ */
+bool selectNearest(Game& game, sf::Vector2f focus, int range) {
+	const sf::Vector2i centre(std::floor(focus.x), std::floor(focus.y));
+	for (int ring = 0; ring <= range; ring++) {
+		for (int x = -ring; x <= ring; x++) {
+			for (int y = -ring; y <= ring; y++) {
+				if (std::max(std::abs(x), std::abs(y)) == ring && game.select(centre + sf::Vector2i(x, y))) {
+					return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Benchmark suite for the renderer, drawing generated boards offscreen through the same phases as a window over fixed
+ * camera scripts, and writing the time taken by each phase to a CSV file for tracking regressions
+ *
+ * The boards are a dense cluster of pawns and knights with a few riders, the same pieces spread uniformly, pawns and
+ * knights in two clusters around (10^8, 10^8) and (-10^8, -10^8), and a board of rooks, bishops and queens. Each is
+ * drawn with the menu open over these scripts:
+ *   still:  the camera stays on the pieces and every frame is redrawn
+ *   pan:    the camera circles the pieces
+ *   zoom:   the tile size sweeps from 256 down to 0.01, where chunks of pieces are drawn, and back
+ *   select: the camera circles the pieces with the nearest piece selected, so its moves are redrawn every frame
+ *
+ * The phases are timed by the renderer's own probes. The mean and 99th percentile of each phase are written in
+ * microseconds, along with the mean time taken for each frame in milliseconds, which includes waiting for the GPU.
+ *
+ * Usage: renderingSuite [--csv FILE] [--pieces N] [--margin M] [--width W] [--height H] [--frames N] [--radius R]
+ *                       [--seed S]
+ */
+int main(int argc, char* argv[]) {
+	std::string csvFileName = "render.csv";
+	unsigned int numPieces = 10000;
+	unsigned int margin = 64;
+	unsigned int width = 1920;
+	unsigned int height = 1080;
+	unsigned int numFrames = 120;
+	unsigned int radius = 16;
+	unsigned int seed = 1;
+
+	// Read the options
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		const unsigned int value = std::strtoul(argv[i + 1], nullptr, 10);
+		if (option == "--csv") {
+			csvFileName = argv[i + 1];
+		} else if (option == "--pieces") {
+			numPieces = value;
+		} else if (option == "--margin") {
+			margin = value;
+		} else if (option == "--width") {
+			width = value;
+		} else if (option == "--height") {
+			height = value;
+		} else if (option == "--frames") {
+			numFrames = value;
+		} else if (option == "--radius") {
+			radius = value;
+		} else if (option == "--seed") {
+			seed = value;
+		} else {
+			std::cerr << "Invalid option: " << option << std::endl;
+			return 1;
+		}
+	}
+
+	sf::RenderTexture texture;
+	if (numFrames == 0 || !texture.create(width, height)) {
+		std::cerr << "Could not create a " << width << "x" << height << " render texture" << std::endl;
+		return 1;
+	}
+
+	// Generate the boards
+	const int DISTANCE = 100000000;
+	const float denseWidth = SyntheticBoards::getWidth(numPieces, 1);
+	const float uniformWidth = SyntheticBoards::getWidth(numPieces, 8);
+	const float farWidth = SyntheticBoards::getWidth(numPieces / 2, 2);
+	const float ridersWidth = SyntheticBoards::getWidth(numPieces / 2, 4);
+
+	const Scenario scenarios[] = {
+		{ "dense", SyntheticBoards::army(numPieces, numPieces / 20, 1, seed),
+			sf::Vector2f(denseWidth / 2, denseWidth / 2) },
+		{ "uniform", SyntheticBoards::army(numPieces, numPieces / 20, 8, seed),
+			sf::Vector2f(uniformWidth / 2, uniformWidth / 2) },
+		{ "far", SyntheticBoards::far(numPieces, DISTANCE, 2, seed),
+			sf::Vector2f(DISTANCE + farWidth / 2, DISTANCE + farWidth / 2) },
+		{ "riders", SyntheticBoards::riders(numPieces / 2, 4, seed),
+			sf::Vector2f(ridersWidth / 2, 0) }
+	};
+
+	// Load the textures, which the renderer takes ownership of along with the teams
+	std::map<std::string, const PieceDef*>* pieceDefs = PieceDefLoader::loadPieceDefs("res/pieces.def");
+	std::vector<std::string>* names = new std::vector<std::string>();
+	for (std::map<std::string, const PieceDef*>::const_iterator i = pieceDefs->begin(); i != pieceDefs->end(); ++i) {
+		names->push_back(i->first);
+	}
+
+	std::vector<std::string>* uiNames = new std::vector<std::string>(1, "button");
+	std::map<std::string, sf::Texture*>* uiTextures = ResourceLoader::loadTextures(uiNames, "res/textures/ui/", ".png");
+	std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams =
+		new std::map<const unsigned int, std::pair<const std::string, sf::Color>>();
+	teams->insert(std::make_pair(0, std::make_pair(std::string("White"), sf::Color(255, 255, 255))));
+	teams->insert(std::make_pair(1, std::make_pair(std::string("Black"), sf::Color(32, 32, 32))));
+
+	// Draw the game offscreen, with the menu open
+	Game game(margin);
+	std::ostringstream output;
+	EngineProtocol protocol(&game, output);
+
+	Renderer renderer(&game, &texture);
+	renderer.onStartup(ResourceLoader::loadTextures(names, "res/textures/pieces/", ".png"), uiTextures, teams);
+
+	WindowLayer menuLayer;
+	Button loadButton(0, 0, 80, 40, "Load", "button", []{});
+	Button saveButton(0, 50, 80, 40, "Save", "button", []{});
+	Button exitButton(0, 100, 80, 40, "Exit", "button", []{});
+	menuLayer.addClickable(&loadButton);
+	menuLayer.addClickable(&saveButton);
+	menuLayer.addClickable(&exitButton);
+	renderer.addLayer(&menuLayer);
+	renderer.toggleMenu();
+
+	std::ofstream csv(csvFileName);
+	if (!csv) {
+		std::cerr << "Could not open " << csvFileName << std::endl;
+		return 1;
+	}
+
+	csv << "scenario,script,pieces,frames,frame_ms";
+	for (unsigned int i = 0; i < NUM_PHASES; i++) {
+		csv << "," << PHASES[i].column << "_us," << PHASES[i].column << "_p99_us";
+	}
+	csv << std::endl;
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "Drawing " << numFrames << " frames at " << width << "x" << height << " for each script" << std::endl;
+
+	for (unsigned int s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++) {
+		const Scenario& scenario = scenarios[s];
+		protocol.handleCommand("position " + scenario.board);
+		if (!output.str().empty()) {
+			std::cerr << output.str();
+			return 1;
+		}
+
+		for (unsigned int t = 0; t < NUM_SCRIPTS; t++) {
+			const std::string& script = SCRIPTS[t];
+			// Start each script from the same view
+			renderer.setTileSize(50);
+			renderer.setCameraPos(scenario.focus);
+			if (script == "select" && !selectNearest(game, scenario.focus, radius)) {
+				std::cerr << "No piece to select near the camera on the " << scenario.name << " board" << std::endl;
+				return 1;
+			}
+			renderer.onBoardChange();
+			renderer.draw();
+
+			Metrics::Histogram before[NUM_PHASES];
+			for (unsigned int i = 0; i < NUM_PHASES; i++) {
+				before[i] = Metrics::read(PHASES[i].probe);
+			}
+
+			// Copy the texture back after the last frame, so that the frames queued on the GPU are counted too
+			sf::Clock timer;
+			for (unsigned int frame = 0; frame < numFrames; frame++) {
+				moveCamera(renderer, script, scenario.focus, radius, frame, numFrames);
+				renderer.draw();
+			}
+			texture.getTexture().copyToImage();
+			const float frameMillis = timer.getElapsedTime().asMicroseconds() / 1000.f / numFrames;
+
+			csv << scenario.name << "," << script << "," << (numPieces + 2) << "," << numFrames << "," << frameMillis;
+			std::cout << scenario.name << " " << script << ": " << frameMillis << " ms per frame";
+			for (unsigned int i = 0; i < NUM_PHASES; i++) {
+				const Metrics::Histogram phase = since(PHASES[i].probe, before[i]);
+				csv << "," << (phase.mean() / 1000) << "," << (phase.percentile(0.99) / 1000.);
+				std::cout << ", " << PHASES[i].column << " " << (phase.mean() / 1000) << " us";
+			}
+			csv << std::endl;
+			std::cout << std::endl;
+		}
+	}
+
+	std::cout << "Results written to " << csvFileName << std::endl;
+
+	// Clean up
+	for (std::map<std::string, sf::Texture*>::iterator i = uiTextures->begin(); i != uiTextures->end(); ++i) {
+		delete i->second;
+	}
+	delete uiTextures;
+	delete uiNames;
+	delete names;
+	for (std::map<std::string, const PieceDef*>::iterator i = pieceDefs->begin(); i != pieceDefs->end(); ++i) {
+		delete i->second;
+	}
+	delete pieceDefs;
+
+	return 0;
+}
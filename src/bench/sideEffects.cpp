@@ -0,0 +1,180 @@
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../game.h"
+#include "../components/pieceDef.h"
+#include "../engine/engineProtocol.h"
+#include "../io/pieceDefLoader.h"
+#include "../utils/vectorUtils.h"
+
+// Helpers
+
+/**
+ * Get the targeting rules for a move one step forward that pushes the enemy pieces around its destination two steps
+ * further away. The destination and the squares that the pieces are pushed to must be empty.
+ *
+ * @param back the offset from the destination to the square that the piece moved from, which is not pushed
+ */
+std::string getShoveRules(sf::Vector2i back) {
+	std::string rules = "[[0,0,],!,[],[[nothing,\"\",],],],";
+	for (int x = -1; x <= 1; x++) {
+		for (int y = -1; y <= 1; y++) {
+			const sf::Vector2i offset(x, y);
+			if (offset == sf::Vector2i(0, 0) || offset == back) continue;
+
+			rules +=
+				"[" + VectorUtils::toString(offset) + ",*,[[SameTeam,=0,],],[[move," +
+				VectorUtils::toString(offset * 2) + ",],],],";
+			rules += "[" + VectorUtils::toString(offset * 3) + ",!,[],[[nothing,\"\",],],],";
+		}
+	}
+
+	return rules;
+}
+
+/**
+ * Load the standard piece definitions with a shover, which steps to an empty square next to it and pushes the enemy
+ * pieces around that square away
+ */
+std::map<std::string, const PieceDef*>* loadPieceDefs() {
+	std::map<std::string, const PieceDef*>* pieceDefs = PieceDefLoader::loadPieceDefs("res/pieces.def");
+	const std::map<std::string, const PieceDef*>* shover = PieceDefLoader::loadPieceDefsFromString(
+		"[[Shover,00,["
+			"[0,[0,1,],1011,[],[=0,],[=1,],[!=-1,],[" + getShoveRules(sf::Vector2i(0, -1)) + "],],"
+			"[1,[1,1,],1110,[],[=0,],[=1,],[!=-1,],[" + getShoveRules(sf::Vector2i(-1, -1)) + "],],"
+		"],],]"
+	);
+
+	pieceDefs->insert(shover->begin(), shover->end());
+	delete shover;
+	return pieceDefs;
+}
+
+/**
+ * Write a piece in the save file format
+ */
+std::string pieceToString(const std::string& name, unsigned int team, sf::Vector2i pos) {
+	return "[" + name + "," + std::to_string(team) + "," + VectorUtils::toString(pos) + "," +
+		std::to_string(team) + ",0,-1,],";
+}
+
+/**
+ * Create a board where each shover stands below seven enemy queens, which are all pushed away when it steps forward
+ */
+std::string getBoard(unsigned int numShovers, unsigned int spacing) {
+	std::string board = "[[[0,White,[255,255,255,255,],],[1,Black,[32,32,32,255,],],],0,[";
+	board += pieceToString("King", 0, sf::Vector2i(0, -2 * (int) spacing));
+	board += pieceToString("King", 1, sf::Vector2i(0, 2 * (int) spacing));
+
+	for (unsigned int i = 0; i < numShovers; i++) {
+		const sf::Vector2i pos(i * spacing, 0);
+		board += pieceToString("Shover", 0, pos);
+		for (int x = -1; x <= 1; x++) {
+			for (int y = 0; y <= 2; y++) {
+				if (x != 0 || y == 2) {
+					board += pieceToString("Queen", 1, pos + sf::Vector2i(x, y));
+				}
+			}
+		}
+	}
+
+	return board + "],]";
+}
+
+/**
+ * Benchmark for moves with many side effects: each move pushes seven queens, whose move markers are updated on 1, 2,
+ * 4 and more threads. Each move is taken back before the next one, and the board after each move is checked against
+ * the board after the same move on one thread.
+ *
+ * Usage: sideEffects [--shovers N] [--spacing S] [--margin M] [--moves N] [--threads T]
+ */
+int main(int argc, char* argv[]) {
+	unsigned int numShovers = 16;
+	unsigned int spacing = 8;
+	unsigned int margin = 32;
+	unsigned int numMoves = 200;
+	unsigned int maxThreads = std::max(8u, std::thread::hardware_concurrency());
+
+	// Read the options
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		const unsigned int value = std::strtoul(argv[i + 1], nullptr, 10);
+		if (option == "--shovers") {
+			numShovers = value;
+		} else if (option == "--spacing") {
+			spacing = value;
+		} else if (option == "--margin") {
+			margin = value;
+		} else if (option == "--moves") {
+			numMoves = value;
+		} else if (option == "--threads") {
+			maxThreads = value;
+		} else {
+			std::cerr << "Invalid option: " << option << std::endl;
+			return 1;
+		}
+	}
+
+	// The queens are pushed up to three squares, so the shovers must be far enough apart not to push each other's
+	if (numShovers == 0 || spacing < 7) {
+		std::cerr << "Expected at least one shover and a spacing of at least 7" << std::endl;
+		return 1;
+	}
+
+	const std::string board = getBoard(numShovers, spacing);
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << numShovers << " shovers, " << (7 * numShovers) << " queens, " <<
+		std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+
+	// Make the moves with each number of threads
+	std::vector<std::string> expected;
+	float serialMillis = 0;
+	for (unsigned int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+		Game game(margin);
+		game.setPieceDefs(loadPieceDefs());
+		game.setThreads(numThreads);
+		std::ostringstream output;
+		EngineProtocol protocol(&game, output);
+		protocol.handleCommand("position " + board);
+
+		float totalMillis = 0;
+		for (unsigned int i = 0; i < numMoves; i++) {
+			const int x = (i % numShovers) * spacing;
+			output.str("");
+			sf::Clock timer;
+			protocol.handleCommand("move " + std::to_string(x) + ",0:" + std::to_string(x) + ",1");
+			totalMillis += timer.getElapsedTime().asMicroseconds() / 1000.f;
+			if (!output.str().empty()) {
+				std::cerr << output.str();
+				return 1;
+			}
+
+			// Check the result before taking the move back
+			protocol.handleCommand("board");
+			if (numThreads == 1) {
+				expected.push_back(output.str());
+			} else if (output.str() != expected[i]) {
+				std::cerr << "Move " << i << " on " << numThreads << " threads differs from one thread" << std::endl;
+				return 1;
+			}
+
+			protocol.handleCommand("undo");
+		}
+
+		if (numThreads == 1) {
+			serialMillis = totalMillis;
+		}
+
+		std::cout << numThreads << " threads: mean " << (totalMillis / numMoves) << " ms per move, speedup " <<
+			std::setprecision(2) << (serialMillis / totalMillis) << std::setprecision(3) << "x" << std::endl;
+	}
+
+	return 0;
+}
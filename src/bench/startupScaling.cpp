@@ -0,0 +1,119 @@
+#include <SFML/Graphics.hpp>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include "syntheticBoards.h"
+#include "../game.h"
+#include "../components/pieceDef.h"
+#include "../engine/engineProtocol.h"
+#include "../io/boardLoader.h"
+#include "../io/pieceDefLoader.h"
+
+/**
+ * Benchmark for how the time taken to load a large board scales with the number of threads that generate the move
+ * markers
+ *
+ * The time taken to parse the board, which is always done on one thread, is reported separately.
+ *
+ * Usage: startupScaling [--pieces N] [--riders N] [--spacing S] [--threads T] [--runs R] [--seed S]
+ */
+int main(int argc, char* argv[]) {
+	unsigned int numPieces = 100000;
+	unsigned int riders = 100;
+	unsigned int spacing = 2;
+	unsigned int maxThreads = std::max(8u, std::thread::hardware_concurrency());
+	unsigned int numRuns = 3;
+	unsigned int seed = 0;
+
+	// Read the options
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		const unsigned int value = std::strtoul(argv[i + 1], nullptr, 10);
+		if (option == "--pieces") {
+			numPieces = value;
+		} else if (option == "--riders") {
+			riders = value;
+		} else if (option == "--spacing") {
+			spacing = value;
+		} else if (option == "--threads") {
+			maxThreads = value;
+		} else if (option == "--runs") {
+			numRuns = value;
+		} else if (option == "--seed") {
+			seed = value;
+		} else {
+			std::cerr << "Invalid option: " << option << std::endl;
+			return 1;
+		}
+	}
+
+	const std::string board = SyntheticBoards::army(numPieces, riders, spacing, seed);
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << (numPieces + 2) << " pieces, " << riders << " riders, " <<
+		std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+
+	// Time parsing the board on its own
+	std::map<std::string, const PieceDef*>* pieceDefs = PieceDefLoader::loadPieceDefs("res/pieces.def");
+	sf::Clock timer;
+	std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams;
+	unsigned int curTurn;
+	std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces;
+	std::tie(teams, curTurn, pieces) = BoardLoader::loadBoardFromString(board, pieceDefs);
+	const float parseSeconds = timer.getElapsedTime().asSeconds();
+	std::cout << "parse: " << (parseSeconds * 1000) << " ms" << std::endl;
+
+	// Clean up
+	for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::iterator i = pieces->begin();
+		i != pieces->end(); ++i
+	) {
+		delete i->second;
+	}
+
+	delete pieces;
+	delete teams;
+	for (std::map<std::string, const PieceDef*>::iterator i = pieceDefs->begin(); i != pieceDefs->end(); ++i) {
+		delete i->second;
+	}
+
+	delete pieceDefs;
+
+	// Time loading the board with each number of threads, keeping the fastest run
+	float serialSeconds = 0;
+	for (unsigned int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+		float bestSeconds = 0;
+		for (unsigned int run = 0; run < numRuns; run++) {
+			const unsigned int GENERATION_MARGIN = 8;
+			Game game(GENERATION_MARGIN);
+			game.setThreads(numThreads);
+			std::ostringstream output;
+			EngineProtocol protocol(&game, output);
+
+			timer.restart();
+			protocol.handleCommand("position " + board);
+			const float seconds = timer.getElapsedTime().asSeconds();
+			if (!output.str().empty()) {
+				std::cerr << output.str();
+				return 1;
+			}
+
+			if (run == 0 || seconds < bestSeconds) {
+				bestSeconds = seconds;
+			}
+		}
+
+		if (numThreads == 1) {
+			serialSeconds = bestSeconds;
+		}
+
+		std::cout << numThreads << " threads: load " << (bestSeconds * 1000) << " ms, speedup " <<
+			std::setprecision(2) << (serialSeconds / bestSeconds) << std::setprecision(1) << "x" << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,199 @@
+#ifndef CHESS_SYNTHETIC_BOARDS_H
+#define CHESS_SYNTHETIC_BOARDS_H
+
+#include <SFML/Graphics.hpp>
+#include <random>
+#include <set>
+#include <string>
+#include "../utils/vectorUtils.h"
+
+/**
+ * Generates boards in the save file format for the benchmarks
+ */
+class SyntheticBoards {
+private:
+	/**
+	 * Write a piece in the save file format
+	 */
+	inline static std::string pieceToString(
+		const std::string& name, unsigned int team, sf::Vector2i pos, unsigned int dir
+	) {
+		return
+			"[" + name + "," + std::to_string(team) + "," + VectorUtils::toString(pos) + "," +
+			std::to_string(dir) + ",0,-1,],";
+	}
+
+public:
+	/**
+	 * Get the width of the square that a number of pieces are scattered over
+	 */
+	inline static int getWidth(unsigned int numPieces, unsigned int spacing) {
+		unsigned int side = 1;
+		while (side * side < numPieces) {
+			side++;
+		}
+
+		return side * spacing;
+	}
+
+	/**
+	 * Create a board of rooks, bishops and queens scattered over a square for each team, with a king for each team
+	 *
+	 * @param piecesPerTeam the number of riders for each team
+	 * @param spacing the average distance between neighbouring riders
+	 * @param seed the seed for scattering the riders
+	 */
+	inline static std::string riders(unsigned int piecesPerTeam, unsigned int spacing, unsigned int seed) {
+		static const std::string RIDERS[] = { "Rook", "Bishop", "Queen" };
+
+		const int width = getWidth(piecesPerTeam, spacing);
+		std::mt19937 random(seed);
+		std::uniform_int_distribution<int> offset(0, width - 1);
+		std::set<sf::Vector2i, VectorUtils::cmpVectorLexicographically> used;
+
+		std::string board = "[[[0,White,[255,255,255,255,],],[1,Black,[32,32,32,255,],],],0,[";
+		for (unsigned int team = 0; team < 2; team++) {
+			// Keep the teams on opposite sides of the x axis
+			const int top = (team == 0) ? (1) : (-width - 1);
+
+			sf::Vector2i kingPos(width / 2, (team == 0) ? (top + width) : (top - 1));
+			used.insert(kingPos);
+			board += pieceToString("King", team, kingPos, team);
+
+			for (unsigned int i = 0; i < piecesPerTeam; i++) {
+				sf::Vector2i pos;
+				do {
+					pos = sf::Vector2i(offset(random), top + offset(random));
+				} while (!used.insert(pos).second);
+
+				board += pieceToString(RIDERS[i % 3], team, pos, team);
+			}
+		}
+
+		return board + "],]";
+	}
+
+	/**
+	 * Create a board where one team's knights are scattered among the other team's rooks, bishops and queens, with a
+	 * king for each team
+	 *
+	 * @param riders the number of riders for the second team
+	 * @param knights the number of knights for the first team
+	 * @param spacing the average distance between neighbouring riders
+	 * @param seed the seed for scattering the pieces
+	 */
+	inline static std::string crossing(
+		unsigned int riders, unsigned int knights, unsigned int spacing, unsigned int seed
+	) {
+		static const std::string RIDERS[] = { "Rook", "Bishop", "Queen" };
+
+		const int width = getWidth(riders, spacing);
+		std::mt19937 random(seed);
+		std::uniform_int_distribution<int> offset(0, width - 1);
+		std::set<sf::Vector2i, VectorUtils::cmpVectorLexicographically> used;
+
+		// Keep the kings outside the square so that neither team starts in check
+		const sf::Vector2i kingPos[] = { sf::Vector2i(-2 * width, -3 * width), sf::Vector2i(3 * width, 3 * width) };
+		used.insert(kingPos[0]);
+		used.insert(kingPos[1]);
+
+		std::string board = "[[[0,White,[255,255,255,255,],],[1,Black,[32,32,32,255,],],],0,[";
+		board += pieceToString("King", 0, kingPos[0], 0);
+		board += pieceToString("King", 1, kingPos[1], 1);
+
+		for (unsigned int i = 0; i < riders + knights; i++) {
+			sf::Vector2i pos;
+			do {
+				pos = sf::Vector2i(offset(random), offset(random));
+			} while (!used.insert(pos).second);
+
+			board += (i < riders) ? (pieceToString(RIDERS[i % 3], 1, pos, 1)) : (pieceToString("Knight", 0, pos, 0));
+		}
+
+		return board + "],]";
+	}
+
+	/**
+	 * Create a board of pawns and knights scattered over a square, with a few rooks, bishops and queens among them
+	 * and a king for each team. Each team's pawns face the other team's half of the square.
+	 *
+	 * @param numPieces the number of pieces other than the kings
+	 * @param riders the number of those pieces that are riders
+	 * @param spacing the average distance between neighbouring pieces
+	 * @param seed the seed for scattering the pieces
+	 */
+	inline static std::string army(unsigned int numPieces, unsigned int riders, unsigned int spacing, unsigned int seed) {
+		static const std::string RIDERS[] = { "Rook", "Bishop", "Queen" };
+		static const std::string LEAPERS[] = { "Pawn", "Knight" };
+
+		const int width = getWidth(numPieces, spacing);
+		std::mt19937 random(seed);
+		std::uniform_int_distribution<int> offset(0, width - 1);
+		std::set<sf::Vector2i, VectorUtils::cmpVectorLexicographically> used;
+
+		// Keep the kings outside the square so that neither team starts in check
+		const sf::Vector2i kingPos[] = { sf::Vector2i(width / 2, width + 1), sf::Vector2i(width / 2, -2) };
+		used.insert(kingPos[0]);
+		used.insert(kingPos[1]);
+
+		std::string board = "[[[0,White,[255,255,255,255,],],[1,Black,[32,32,32,255,],],],0,[";
+		board += pieceToString("King", 0, kingPos[0], 0);
+		board += pieceToString("King", 1, kingPos[1], 1);
+
+		for (unsigned int i = 0; i < numPieces; i++) {
+			sf::Vector2i pos;
+			do {
+				pos = sf::Vector2i(offset(random), offset(random));
+			} while (!used.insert(pos).second);
+
+			const unsigned int team = (pos.y < width / 2) ? (1) : (0);
+			board += pieceToString((i < riders) ? (RIDERS[i % 3]) : (LEAPERS[i % 2]), team, pos, team);
+		}
+
+		return board + "],]";
+	}
+
+	/**
+	 * Create a board of pawns and knights in two squares far from the origin, with a king beside each. The first team
+	 * is scattered below and to the right of (distance, distance), and the second team above and to the left of
+	 * (-distance, -distance).
+	 *
+	 * @param numPieces the number of pieces other than the kings
+	 * @param distance the distance of each square from the origin along each axis
+	 * @param spacing the average distance between neighbouring pieces
+	 * @param seed the seed for scattering the pieces
+	 */
+	inline static std::string far(unsigned int numPieces, int distance, unsigned int spacing, unsigned int seed) {
+		static const std::string LEAPERS[] = { "Pawn", "Knight" };
+
+		const unsigned int piecesPerTeam = numPieces / 2;
+		const int width = getWidth(piecesPerTeam, spacing);
+		std::mt19937 random(seed);
+		std::uniform_int_distribution<int> offset(0, width - 1);
+		std::set<sf::Vector2i, VectorUtils::cmpVectorLexicographically> used;
+
+		std::string board = "[[[0,White,[255,255,255,255,],],[1,Black,[32,32,32,255,],],],0,[";
+		for (unsigned int team = 0; team < 2; team++) {
+			const sf::Vector2i corner = (team == 0) ? (sf::Vector2i(distance, distance)) :
+				(sf::Vector2i(-distance - width, -distance - width));
+
+			const sf::Vector2i kingPos = (team == 0) ? (corner - sf::Vector2i(2, 2)) :
+				(corner + sf::Vector2i(width + 1, width + 1));
+			used.insert(kingPos);
+			board += pieceToString("King", team, kingPos, team);
+
+			for (unsigned int i = 0; i < piecesPerTeam; i++) {
+				sf::Vector2i pos;
+				do {
+					pos = corner + sf::Vector2i(offset(random), offset(random));
+				} while (!used.insert(pos).second);
+
+				board += pieceToString(LEAPERS[i % 2], team, pos, team);
+			}
+		}
+
+		return board + "],]";
+	}
+};
+
+#endif // CHESS_SYNTHETIC_BOARDS_H
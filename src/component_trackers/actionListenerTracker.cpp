@@ -1,73 +1,60 @@
 #include "actionListenerTracker.h"
 
+#include <algorithm>
 #include "../components/moveDef.h"
 #include "../components/moveMarker.h"
 #include "../components/piece.h"
+#include "../utils/metrics.h"
 #include "../utils/vectorUtils.h"
 
 // Constructors
-ActionListenerTracker::ActionListenerTracker() {
+ActionListenerTracker::ActionListenerTracker() :
+	numListeners{0}
+{
 }
 
 /**
  * Destructor
  */
 ActionListenerTracker::~ActionListenerTracker() {
-	for (std::map<
-		sf::Vector2i,
-		std::map<std::string, MoveMarker*>*,
-		VectorUtils::cmpVectorLexicographically
-	>::iterator i = actionListeners.begin();
-		i != actionListeners.end(); ++i
-	) {
-        delete i->second;
-	}
-
-	actionListeners.clear();
 }
 
 // Helpers
 
 /**
- * Add a move listener
+ * Record that a move marker listens to a position
  *
  * @param positionToNotify the position to listen to
  * @param listener the move marker to notify upon update of the trigger position
+ *
+ * @return false if it is already listening to the position
  */
-void ActionListenerTracker::addListener(sf::Vector2i positionToNotify, MoveMarker* listener) {
-    // Get the existing listeners for the trigger position
-    std::map<
-		sf::Vector2i,
-		std::map<std::string, MoveMarker*>*,
-		VectorUtils::cmpVectorLexicographically
-	>::iterator triggerIter =
-		actionListeners.find(positionToNotify);
-
-	std::map<std::string, MoveMarker*>* positionListeners;
-
-	// Check if there are existing listeners for the trigger position
-    if (triggerIter == actionListeners.end()) {
-        positionListeners = new std::map<std::string, MoveMarker*>();
-        actionListeners.insert(std::make_pair(positionToNotify, positionListeners));
-    } else {
-		positionListeners = triggerIter->second;
-    }
+bool ActionListenerTracker::addListenerPosition(sf::Vector2i positionToNotify, MoveMarker* listener) {
+	std::vector<sf::Vector2i>& positions = listenerPositions[listener];
+	if (std::find(positions.begin(), positions.end(), positionToNotify) != positions.end()) {
+		return false;
+	}
 
-    // Add the listener
-    std::string key = generateKey(listener);
-    if (positionListeners->find(key) == positionListeners->end()) {
-		positionListeners->insert(std::make_pair(key, listener));
-    }
+	positions.push_back(positionToNotify);
+	numListeners++;
+	return true;
 }
 
 /**
- * Generate a key from a move marker
+ * Add a move listener
+ *
+ * @param positionToNotify the position to listen to
+ * @param listener the move marker to notify upon update of the trigger position
  */
-std::string ActionListenerTracker::generateKey(MoveMarker* marker) {
-	return
-		VectorUtils::toString(marker->getRootPiece()->getPos()) +
-		VectorUtils::toString(marker->getPos()) +
-		std::to_string(marker->getRootMove()->index);
+void ActionListenerTracker::addListener(sf::Vector2i positionToNotify, MoveMarker* listener) {
+	if (!addListenerPosition(positionToNotify, listener)) return;
+
+	// Add the listener after the other listeners for the position
+	std::vector<Listener>& chunkListeners = chunks[getChunk(positionToNotify)];
+	chunkListeners.insert(
+		std::upper_bound(chunkListeners.begin(), chunkListeners.end(), positionToNotify, cmpListenerPositions()),
+		Listener{positionToNotify, listener}
+	);
 }
 
 // Public API
@@ -87,44 +74,81 @@ void ActionListenerTracker::addListeners(MoveMarker* marker) {
 	delete targetPositions;
 }
 
+/**
+ * Add move listeners in bulk, as collected while a board is loaded
+ *
+ * The listeners are sorted by position, so the listeners for each chunk are appended in order with one search for
+ * the chunk, then merged with the listeners that the chunk already had.
+ *
+ * @param listeners the positions to listen to and their move markers, sorted by position
+ */
+void ActionListenerTracker::addListeners(const std::vector<std::pair<sf::Vector2i, MoveMarker*>>* listeners) {
+	listenerPositions.reserve(listenerPositions.size() + listeners->size());
+
+	// The chunks that were added to, and the number of listeners that they had before
+	std::map<std::vector<Listener>*, std::size_t> changedChunks;
+
+	std::vector<Listener>* chunkListeners = nullptr;
+	sf::Vector2i chunk;
+	for (std::vector<std::pair<sf::Vector2i, MoveMarker*>>::const_iterator i = listeners->begin();
+		i != listeners->end(); ++i
+	) {
+		if (!addListenerPosition(i->first, i->second)) continue;
+
+		// Find the listeners for the chunk, unless it is the same as the previous one
+		if (chunkListeners == nullptr || getChunk(i->first) != chunk) {
+			chunk = getChunk(i->first);
+			chunkListeners = &chunks[chunk];
+			changedChunks.insert(std::make_pair(chunkListeners, chunkListeners->size()));
+		}
+
+		chunkListeners->push_back(Listener{i->first, i->second});
+	}
+
+	// Positions in different columns of a chunk are interleaved, so sort each chunk again
+	for (std::map<std::vector<Listener>*, std::size_t>::const_iterator i = changedChunks.begin();
+		i != changedChunks.end(); ++i
+	) {
+		std::vector<Listener>& changed = *(i->first);
+		std::stable_sort(changed.begin() + i->second, changed.end(), cmpListenerPositions());
+		std::inplace_merge(changed.begin(), changed.begin() + i->second, changed.end(), cmpListenerPositions());
+	}
+}
+
 /**
  * Remove all the action listeners for a given move marker
  *
  * @param listener the move marker to remove move listeners for
  */
 void ActionListenerTracker::removeListeners(MoveMarker* listener) {
-	// A list of all the positions to erase
-	std::vector<sf::Vector2i> toDelete;
+	std::unordered_map<MoveMarker*, std::vector<sf::Vector2i>>::iterator positionsIter = listenerPositions.find(listener);
+	if (positionsIter == listenerPositions.end()) return;
+
+    // Iterate through the positions that the listener is registered at
+    for (std::vector<sf::Vector2i>::const_iterator i = positionsIter->second.begin(); i != positionsIter->second.end(); ++i) {
+		std::map<sf::Vector2i, std::vector<Listener>, VectorUtils::cmpVectorLexicographically>::iterator chunkIter =
+			chunks.find(getChunk(*i));
+		if (chunkIter == chunks.end()) continue;
+
+		// Find the listener among the listeners for the position
+		std::vector<Listener>& chunkListeners = chunkIter->second;
+		std::pair<std::vector<Listener>::iterator, std::vector<Listener>::iterator> range =
+			std::equal_range(chunkListeners.begin(), chunkListeners.end(), *i, cmpListenerPositions());
+		for (std::vector<Listener>::iterator j = range.first; j != range.second; ++j) {
+			if (j->marker == listener) {
+				chunkListeners.erase(j);
+				break;
+			}
+		}
 
-    // Iterate through all the tracked positions
-    for (std::map<sf::Vector2i, std::map<std::string, MoveMarker*>*>::iterator i = actionListeners.begin();
-		i != actionListeners.end(); ++i
-	) {
-		std::map<std::string, MoveMarker*>* positionListeners = i->second;
-		std::map<std::string, MoveMarker*>::iterator j = positionListeners->begin();
-
-        // Iterate through all the listeners for the positions
-        while (j != positionListeners->end() && j->second != listener) {
-			++j;
-        }
-
-        // Remove the listener if it is listening to the position
-        if (j != positionListeners->end()) {
-            positionListeners->erase(j);
-
-            // Mark the list to be deleted if there are no more listeners at the position
-            if (positionListeners->empty()) {
-				toDelete.push_back(i->first);
-            }
-        }
+		// Delete the chunk if there are no more listeners in it
+		if (chunkListeners.empty()) {
+			chunks.erase(chunkIter);
+		}
     }
 
-    // Delete all the lists that were marked to be deleted
-    for (std::vector<sf::Vector2i>::iterator i = toDelete.begin();
-		i != toDelete.end(); ++i
-    ) {
-		actionListeners.erase(*i);
-    }
+    numListeners -= positionsIter->second.size();
+    listenerPositions.erase(positionsIter);
 }
 
 /**
@@ -133,43 +157,28 @@ void ActionListenerTracker::removeListeners(MoveMarker* listener) {
  * @param positionToNotify the position to notify
  * @param event the action that triggered the notification
  */
-void ActionListenerTracker::notify(sf::Vector2i positionToNotify, Event* event) {
-	// Get the existing listeners for the trigger position
-    std::map<
-		sf::Vector2i,
-		std::map<std::string, MoveMarker*>*,
-		VectorUtils::cmpVectorLexicographically
-	>::iterator triggerIter =
-		actionListeners.find(positionToNotify);
-
-
-
-	// Check if there are existing listeners for the trigger position
-    if (triggerIter != actionListeners.end()) {
-		std::map<std::string, MoveMarker*>* positionListeners = triggerIter->second;
-
-		// Notify each of the listeners at the position
-		for (std::map<std::string, MoveMarker*>::iterator i = positionListeners->begin();
-			i != positionListeners->end(); ++i
-		) {
-            i->second->handleEvent(event);
-		}
-    }
+void ActionListenerTracker::notify(sf::Vector2i positionToNotify, const Event& event) {
+	Metrics::Timer timer(Metrics::NOTIFY);
+
+	// Get the listeners for the chunk that contains the trigger position
+	std::map<sf::Vector2i, std::vector<Listener>, VectorUtils::cmpVectorLexicographically>::const_iterator chunkIter =
+		chunks.find(getChunk(positionToNotify));
+	if (chunkIter == chunks.end()) return;
+
+	// Notify each of the listeners at the position, which only update their own targets
+	std::pair<std::vector<Listener>::const_iterator, std::vector<Listener>::const_iterator> range = std::equal_range(
+		chunkIter->second.begin(), chunkIter->second.end(), positionToNotify, cmpListenerPositions()
+	);
+	for (std::vector<Listener>::const_iterator i = range.first; i != range.second; ++i) {
+		i->marker->handleEvent(event);
+	}
 }
 
 /**
  * Clear everything on startup
  */
 void ActionListenerTracker::onStartup() {
-	for (std::map<
-		sf::Vector2i,
-		std::map<std::string, MoveMarker*>*,
-		VectorUtils::cmpVectorLexicographically
-	>::iterator i = actionListeners.begin();
-		i != actionListeners.end(); ++i
-	) {
-        delete i->second;
-	}
-
-	actionListeners.clear();
+	chunks.clear();
+	listenerPositions.clear();
+	numListeners = 0;
 }
@@ -3,6 +3,7 @@
 
 #include <SFML/Graphics.hpp>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include "../utils/vectorUtils.h"
 
@@ -12,10 +13,82 @@ class MoveMarker;
 
 // Class declaration
 class ActionListenerTracker {
+public:
+	// Constants
+
+	/**
+	 * The width and height of the square chunks that listeners are grouped by
+	 */
+	static const int CHUNK_SIZE = 8;
+
 private:
-    std::map<sf::Vector2i, std::map<std::string, MoveMarker*>*, VectorUtils::cmpVectorLexicographically> actionListeners;
+	// Helper structs
+
+	/**
+	 * A position and a move marker listening to it
+	 */
+	struct Listener {
+		sf::Vector2i pos;
+		MoveMarker* marker;
+	};
+
+	/**
+	 * Orders listeners by position, which keeps the listeners for each position next to each other
+	 */
+	struct cmpListenerPositions {
+		bool operator()(const Listener& a, const Listener& b) const {
+			return VectorUtils::cmpVectorLexicographically()(a.pos, b.pos);
+		}
+
+		bool operator()(const Listener& a, const sf::Vector2i b) const {
+			return VectorUtils::cmpVectorLexicographically()(a.pos, b);
+		}
+
+		bool operator()(const sf::Vector2i a, const Listener& b) const {
+			return VectorUtils::cmpVectorLexicographically()(a, b.pos);
+		}
+	};
+
+	// Members
+
+	/**
+	 * The listeners in each chunk, sorted by position. A marker stays registered while its piece moves along the
+	 * marker's ray, so listeners are identified by the marker itself rather than by any position.
+	 *
+	 * Long rays listen to a few positions on every tile they cross, so one list for each chunk takes far less memory
+	 * than a set for each position, and the listeners for a position are found by a binary search in its chunk.
+	 */
+	std::map<sf::Vector2i, std::vector<Listener>, VectorUtils::cmpVectorLexicographically> chunks;
+
+    /**
+     * The positions that each listener is registered at, so that it can be removed without searching
+     */
+    std::unordered_map<MoveMarker*, std::vector<sf::Vector2i>> listenerPositions;
+
+    /**
+     * The number of positions listened to by all the listeners
+     */
+    std::size_t numListeners;
 
     // Helpers
+
+    /**
+	 * Get the chunk that contains a position
+	 */
+	inline static sf::Vector2i getChunk(sf::Vector2i pos) {
+		return sf::Vector2i(
+			(pos.x >= 0) ? (pos.x / CHUNK_SIZE) : ((pos.x + 1) / CHUNK_SIZE - 1),
+			(pos.y >= 0) ? (pos.y / CHUNK_SIZE) : ((pos.y + 1) / CHUNK_SIZE - 1)
+		);
+	}
+
+    /**
+	 * Record that a move marker listens to a position
+	 *
+	 * @return false if it is already listening to the position
+	 */
+	bool addListenerPosition(sf::Vector2i positionToNotify, MoveMarker* listener);
+
     /**
 	 * Add a move listener
 	 *
@@ -24,11 +97,6 @@ private:
 	 */
     void addListener(sf::Vector2i positionToNotify, MoveMarker* listener);
 
-    /**
-     * Generate a key from a move marker
-     */
-    static std::string generateKey(MoveMarker* marker);
-
 public:
     // Constructors
     ActionListenerTracker();
@@ -43,6 +111,13 @@ public:
 	 */
 	void addListeners(MoveMarker* marker);
 
+    /**
+	 * Add move listeners in bulk, as collected while a board is loaded
+	 *
+	 * @param listeners the positions to listen to and their move markers, sorted by position
+	 */
+	void addListeners(const std::vector<std::pair<sf::Vector2i, MoveMarker*>>* listeners);
+
     /**
 	* Remove all the action listeners for a given move marker
 	*
@@ -56,7 +131,14 @@ public:
      * @param positionToNotify the position to notify
      * @param event the action that triggered the notification
      */
-    void notify(sf::Vector2i positionToNotify, Event* event);
+    void notify(sf::Vector2i positionToNotify, const Event& event);
+
+    /**
+	 * Get the number of positions listened to by all the listeners
+	 */
+	inline std::size_t getNumListeners() const {
+		return numListeners;
+	}
 
     /**
 	 * Clear everything on startup
@@ -1,13 +1,19 @@
 #include "eventProcessor.h"
 
 #include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <map>
+#include <thread>
 #include "actionListenerTracker.h"
 #include "../controller.h"
-#include "../components/event.h"
 #include "../components/moveMarker.h"
+#include "../components/moveRecord.h"
 #include "moveTracker.h"
 #include "../components/piece.h"
 #include "pieceTracker.h"
+#include "../utils/metrics.h"
+#include "../utils/trace.h"
+#include "../io/journal.h"
 #include "../utils/vectorUtils.h"
 
 // Constructors
@@ -16,104 +22,327 @@ EventProcessor::EventProcessor(
 ):
 	pieceTracker{pieceTracker_},
 	actionListenerTracker{actionListenerTracker_},
-	controller{controller_}
+	controller{controller_},
+	journal{nullptr},
+	record{nullptr},
+	numThreads{std::thread::hardware_concurrency()}
 {
 }
 
 EventProcessor::~EventProcessor() {
-	// Delete each event queue
-	for (std::vector<std::vector<Event*>*>::const_iterator i = eventQueues.begin(); i != eventQueues.end(); ++i) {
-		// Delete each stored event
-        for (std::vector<Event*>::iterator j = (*i)->begin(); j != (*i)->end(); ++j) {
-            delete *j;
-        }
-
-        (*i)->clear();
-        delete *i;
-	}
 }
 
 
 
 // Helpers
 
+/**
+ * Record an event in the journal and the move record before it is executed, since the piece may be deleted
+ */
+void EventProcessor::recordEvent(const Event& event) {
+	if (journal != nullptr && !(event.flags & Event::UNDO)) {
+		journal->onEvent(event);
+	}
+
+	if (record != nullptr) {
+		record->events.push_back(event);
+		record->onChange(event.piece, pieceTracker->getPiece(event.piece->getPos()) == event.piece);
+	}
+}
+
 /**
  * Execute an event
  */
-void EventProcessor::execute(Event* event) {
-	Piece* piece = event->piece;
+void EventProcessor::execute(const Event& event) {
+	Metrics::Timer timer((Metrics::Probe) (Metrics::EXECUTE_ENTER + event.action));
+	recordEvent(event);
+
+	if (event.action == Event::ENTER) {
+		event.piece->onMove(pieceTracker);
+		event.piece->onCameraChange(pieceTracker);
+		arrive(event);
+	} else {
+		apply(event);
+	}
+}
+
+/**
+ * Execute an event that does not enter the board
+ */
+void EventProcessor::apply(const Event& event) {
+	Piece* piece = event.piece;
 
-	if ("enter" == event->action) {
+	switch (event.action) {
+	case Event::LEAVE: {
 		// Update the piece
-        piece->onMove();
-        piece->onStartup(pieceTracker);
-        piece->onCameraChange(pieceTracker);
-
-        // Update other markers only if this is not an initialization event
-        if (event->args != "initialization") {
-			// Update the other move markers
-			std::vector<MoveMarker*>* enterPos = pieceTracker->getMoveMarkers(piece->getPos());
-			for (std::vector<MoveMarker*>::iterator i = enterPos->begin(); i != enterPos->end(); ++i) {
-				(*i)->onPieceEnter(piece, pieceTracker);
+        pieceTracker->removePiece(piece->getPos());
+		changedPositions.push_back(piece->getPos());
+
+		// Alert action listeners
+		actionListenerTracker.notify(piece->getPos(), event);
+		break;
+	}
+
+	case Event::MOVE:
+		// Move the piece
+        piece->setPos(event.dest);
+        piece->setLastMove(event.moveIndex);
+        pieceTracker->addPiece(piece);
+		break;
+
+	case Event::DESTROY:
+        // Decrement the piece count for the team
+        controller->removePiece(piece->getTeam());
+
+		// Unregister the piece's action listeners and delete the piece, unless the move may be taken back
+		piece->onDestroy(pieceTracker);
+		if (record != nullptr) {
+			record->destroyed.push_back(piece);
+		} else {
+			delete piece;
+		}
+		break;
+
+	case Event::ENTER:
+	case Event::NOTHING:
+		break;
+	}
+}
+
+/**
+ * Alert the action listeners after a piece enters the board and its move markers have been updated
+ */
+void EventProcessor::arrive(const Event& event) {
+	changedPositions.push_back(event.piece->getPos());
+	actionListenerTracker.notify(event.piece->getPos(), event);
+}
+
+/**
+ * Group the events into waves, where the events in a wave only depend on events in earlier waves
+ *
+ * The events for each piece depend on the events added before them for the same piece. Events for different pieces
+ * at the same position are ordered by what they do there: a piece leaves a position before another piece moves to
+ * it, and moves to it before entering it. Events that do the same thing at the same position keep the order that
+ * they were added in. If the events cannot be ordered, such as when pieces move through each other's positions, the
+ * earliest added event that is left is executed on its own.
+ */
+void EventProcessor::schedule(std::vector<std::vector<std::size_t>>& waves) const {
+	const std::size_t numEvents = events.size();
+
+	// Find the position that each event changes, following each piece's moves
+	std::vector<sf::Vector2i> positions(numEvents);
+	std::map<const Piece*, sf::Vector2i> piecePositions;
+	for (std::size_t i = 0; i < numEvents; i++) {
+		const Piece* piece = events[i].piece;
+		std::map<const Piece*, sf::Vector2i>::iterator found =
+			piecePositions.insert(std::make_pair(piece, piece->getPos())).first;
+
+		if (events[i].action == Event::MOVE) {
+			found->second = events[i].dest;
+		}
+
+		positions[i] = found->second;
+	}
+
+	// Find the order in which events that conflict must be executed
+	std::vector<std::vector<std::size_t>> dependents(numEvents);
+	std::vector<std::size_t> numDependencies(numEvents, 0);
+	for (std::size_t i = 0; i < numEvents; i++) {
+		const Event& a = events[i];
+		for (std::size_t j = i + 1; j < numEvents; j++) {
+			const Event& b = events[j];
+			std::size_t first = i;
+			std::size_t second = j;
+
+			if (a.piece != b.piece) {
+				// Only leaving, moving and entering conflict at a position
+				if (a.action > Event::MOVE || b.action > Event::MOVE || positions[i] != positions[j]) continue;
+				if (getStage(b.action) < getStage(a.action)) std::swap(first, second);
 			}
 
-			// Clean up
-			delete enterPos;
-        }
+			dependents[first].push_back(second);
+			numDependencies[second]++;
+		}
+	}
 
-		// Alert action listeners
-        actionListenerTracker.notify(piece->getPos(), event);
+	// Execute each event in the first wave after the waves of the events that it depends on
+	std::vector<bool> scheduled(numEvents, false);
+	std::vector<std::size_t> wave;
+	for (std::size_t i = 0; i < numEvents; i++) {
+		if (numDependencies[i] == 0) wave.push_back(i);
+	}
 
-        // Register action listeners
-        const std::vector<MoveMarker*>* moveMarkers = piece->getMoveTracker()->getMoveMarkers();
-        for (std::vector<MoveMarker*>::const_iterator i = moveMarkers->begin(); i != moveMarkers->end(); ++i) {
-            actionListenerTracker.addListeners(*i);
-        }
+	std::size_t numScheduled = 0;
+	while (numScheduled < numEvents) {
+		// Break a cycle with the earliest event that is left
+		if (wave.empty()) {
+			wave.push_back(std::find(scheduled.begin(), scheduled.end(), false) - scheduled.begin());
+		}
 
-		// Clean up
-		delete moveMarkers;
+		std::vector<std::size_t> next;
+		for (std::vector<std::size_t>::const_iterator i = wave.begin(); i != wave.end(); ++i) {
+			scheduled[*i] = true;
+			for (std::vector<std::size_t>::const_iterator j = dependents[*i].begin(); j != dependents[*i].end(); ++j) {
+				if (--numDependencies[*j] == 0 && !scheduled[*j]) next.push_back(*j);
+			}
+		}
 
-	} else if ("leave" == event->action) {
-		// Unregister action listeners
-        const std::vector<MoveMarker*>* moveMarkers = piece->getMoveTracker()->getMoveMarkers();
-        for (std::vector<MoveMarker*>::const_iterator i = moveMarkers->begin(); i != moveMarkers->end(); ++i) {
-			actionListenerTracker.removeListeners(*i);
-        }
+		numScheduled += wave.size();
+		waves.push_back(wave);
+		std::sort(next.begin(), next.end());
+		wave.swap(next);
+	}
+}
 
-		// Update the piece
-        pieceTracker->removePiece(piece->getPos());
+/**
+ * Execute a wave of events that do not depend on each other
+ *
+ * The events that do not enter the board change it in the order that they were added. The move markers of the pieces
+ * entering the board are then updated from the same board, on several threads if there are enough pieces. Their
+ * generated and deleted markers are registered and unregistered in the order that the events were added, so the
+ * result does not depend on the number of threads.
+ */
+void EventProcessor::executeWave(const std::vector<std::size_t>& wave) {
+	std::vector<const Event*> entering;
+	for (std::vector<std::size_t>::const_iterator i = wave.begin(); i != wave.end(); ++i) {
+		const Event& event = events[*i];
+		if (event.action == Event::ENTER) {
+			recordEvent(event);
+			entering.push_back(&event);
+		} else {
+			execute(event);
+		}
+	}
 
-        // Update the other move markers
-		std::vector<MoveMarker*>* leavePos = pieceTracker->getMoveMarkers(piece->getPos());
-		for (std::vector<MoveMarker*>::iterator i = leavePos->begin(); i != leavePos->end(); ++i) {
-			(*i)->onPieceLeave(piece, pieceTracker);
+	// Update the pieces one after another if there are not enough of them for threads
+	const unsigned int threadsUsed = std::min<std::size_t>(numThreads, entering.size());
+	if (entering.size() < MIN_PARALLEL_ENTERS || threadsUsed < 2) {
+		for (std::vector<const Event*>::const_iterator i = entering.begin(); i != entering.end(); ++i) {
+			Metrics::Timer timer(Metrics::EXECUTE_ENTER);
+			(*i)->piece->onMove(pieceTracker);
+			(*i)->piece->onCameraChange(pieceTracker);
+			arrive(**i);
 		}
 
-		// Alert action listeners
-		actionListenerTracker.notify(piece->getPos(), event);
+		return;
+	}
+
+	std::vector<std::vector<MoveMarker*>> generated(entering.size());
+	std::vector<std::vector<MoveMarker*>> deleted(entering.size());
+	std::atomic<std::size_t> nextPiece(0);
+	workers.run(threadsUsed, [&](unsigned int) {
+		updateMarkers(&entering, &nextPiece, &generated, &deleted);
+	});
+
+	// Register the changes to the markers in the order that the events were added
+	for (std::size_t i = 0; i < entering.size(); i++) {
+		for (std::vector<MoveMarker*>::const_iterator j = deleted[i].begin(); j != deleted[i].end(); ++j) {
+			actionListenerTracker.removeListeners(*j);
+			delete *j;
+		}
+	}
+
+	for (std::size_t i = 0; i < entering.size(); i++) {
+		for (std::vector<MoveMarker*>::const_iterator j = generated[i].begin(); j != generated[i].end(); ++j) {
+			actionListenerTracker.addListeners(*j);
+		}
+	}
+
+	for (std::vector<const Event*>::const_iterator i = entering.begin(); i != entering.end(); ++i) {
+		arrive(**i);
+	}
+}
+
+/**
+ * Update the move markers for pieces entering the board taken from a shared counter
+ *
+ * The piece tracker is only read, and each piece only changes its own markers, so this can run on several threads at
+ * once.
+ */
+void EventProcessor::updateMarkers(
+	const std::vector<const Event*>* entering,
+	std::atomic<std::size_t>* nextPiece,
+	std::vector<std::vector<MoveMarker*>>* generated,
+	std::vector<std::vector<MoveMarker*>>* deleted
+) const {
+	for (std::size_t i = nextPiece->fetch_add(1); i < entering->size(); i = nextPiece->fetch_add(1)) {
+		Metrics::Timer timer(Metrics::EXECUTE_ENTER);
+		(*entering)[i]->piece->onDeferredMove(pieceTracker, &(*generated)[i], &(*deleted)[i]);
+	}
+}
+
+/**
+ * Update the obstruction counts of the move markers past each changed position
+ *
+ * This runs once after all of a move's events, so that a position that is left and entered again is only handled
+ * once, and a ray crossed by several changes is updated from its nearest change first.
+ */
+void EventProcessor::propagateObstructions() {
+	Trace::Span span("propagate obstructions");
+	std::sort(changedPositions.begin(), changedPositions.end(), VectorUtils::cmpVectorLexicographically());
+	changedPositions.erase(std::unique(changedPositions.begin(), changedPositions.end()), changedPositions.end());
+
+	// Find the move markers at the changed positions
+	std::vector<MoveMarker*> changed;
+	for (std::vector<sf::Vector2i>::const_iterator i = changedPositions.begin(); i != changedPositions.end(); ++i) {
+		std::vector<MoveMarker*>* markers = pieceTracker->getMoveMarkers(*i);
+		changed.insert(changed.end(), markers->begin(), markers->end());
 
 		// Clean up
-		delete leavePos;
+		delete markers;
+	}
 
-	} else if ("move" == event->action) {
-		// Get the arguments
-		std::vector<std::string>* args = StringUtils::getList(event->args, ',', '[', ']');
+	changedPositions.clear();
 
-		// Move the piece
-        sf::Vector2i destPos = VectorUtils::fromString((*args)[1]);
-        piece->setPos(destPos);
-        piece->setLastMove(std::stoi((*args)[0]));
-        pieceTracker->addPiece(piece);
+	// Update the markers nearest to their pieces first, since updating a ray stops once the counts are unchanged
+	std::sort(changed.begin(), changed.end(), [](const MoveMarker* a, const MoveMarker* b) {
+		return a->lambda < b->lambda;
+	});
 
-	} else if ("destroy" == event->action) {
-        // Decrement the piece count for the team
-        controller->removePiece(piece->getTeam());
+	for (std::vector<MoveMarker*>::iterator i = changed.begin(); i != changed.end(); ++i) {
+		(*i)->onObstructionChange(pieceTracker);
+	}
+}
+
+
+
+/**
+ * Generate the move markers for pieces taken from a shared counter, collecting the positions that each marker listens
+ * to so that they can be registered as action listeners afterwards
+ *
+ * The piece tracker is only read, so this can run on several threads at once. The listeners are sorted by position so
+ * that they can be merged into the action listener tracker in order.
+ */
+void EventProcessor::generateMarkers(
+	const std::vector<Piece*>* pieces,
+	std::atomic<std::size_t>* nextPiece,
+	std::vector<std::pair<sf::Vector2i, MoveMarker*>>* listeners
+) const {
+	Trace::Span span("generate startup markers");
+	std::vector<MoveMarker*> generated;
+	const std::size_t numPieces = pieces->size();
+	for (std::size_t i = nextPiece->fetch_add(PIECES_PER_TASK); i < numPieces; i = nextPiece->fetch_add(PIECES_PER_TASK)) {
+		const std::size_t end = std::min(i + PIECES_PER_TASK, numPieces);
+		for (std::size_t j = i; j < end; j++) {
+			(*pieces)[j]->onStartup(pieceTracker, &generated);
+		}
+	}
+
+	// Collect the positions that each marker listens to
+	for (std::vector<MoveMarker*>::const_iterator i = generated.begin(); i != generated.end(); ++i) {
+		const std::vector<sf::Vector2i>* targetPositions = (*i)->getTargetedPositions();
+		for (std::vector<sf::Vector2i>::const_iterator j = targetPositions->begin(); j != targetPositions->end(); ++j) {
+			listeners->push_back(std::make_pair(*j, *i));
+		}
 
-		// Delete the piece
-		delete piece;
+		delete targetPositions;
 	}
 
-	delete event;
+	std::sort(listeners->begin(), listeners->end(),
+		[](const std::pair<sf::Vector2i, MoveMarker*>& a, const std::pair<sf::Vector2i, MoveMarker*>& b) {
+			return VectorUtils::cmpVectorLexicographically()(a.first, b.first);
+		}
+	);
 }
 
 
@@ -121,27 +350,52 @@ void EventProcessor::execute(Event* event) {
 // Public API
 
 /**
- * Add an event to an event queue
+ * Add an event for the move being made. The events for each piece are executed in the order that they are added.
  *
- * @param queueIndex the index of the queue to add to
- * @param event the event to add to the queue
+ * @param event the event to add
  */
-void EventProcessor::insertInQueue(int queueIndex, Event* event) {
-    eventQueues[queueIndex]->push_back(event);
+void EventProcessor::addEvent(const Event& event) {
+	events.push_back(event);
 }
 
 /**
- * Execute all of the events
+ * Execute all of the events, in waves of events that do not depend on each other
  */
 void EventProcessor::executeEvents() {
-	// Execute the events in each event queue
-	for (std::vector<std::vector<Event*>*>::const_iterator i = eventQueues.begin(); i != eventQueues.end(); ++i) {
-		// Delete each stored event
-        for (std::vector<Event*>::iterator j = (*i)->begin(); j != (*i)->end(); ++j) {
-            execute(*j);
-        }
+	Trace::Span span("execute events");
+
+	std::vector<std::vector<std::size_t>> waves;
+	schedule(waves);
+	for (std::vector<std::vector<std::size_t>>::const_iterator i = waves.begin(); i != waves.end(); ++i) {
+		executeWave(*i);
+	}
 
-        (*i)->clear();
+	events.clear();
+	propagateObstructions();
+}
+
+/**
+ * Generate the move markers for all the pieces of a board that was just loaded
+ *
+ * Each piece only reads the board to generate its own markers, so the pieces are split between threads. Their
+ * markers are registered as action listeners once every thread has finished.
+ */
+void EventProcessor::initializePieces(const std::vector<Piece*>* pieces) {
+	Trace::Span span("initialize pieces");
+
+	// Small boards are not worth splitting between threads
+	const unsigned int threadsUsed =
+		std::max(1u, std::min<unsigned int>(numThreads, pieces->size() / MIN_PIECES_PER_THREAD));
+
+	std::vector<std::vector<std::pair<sf::Vector2i, MoveMarker*>>> listeners(threadsUsed);
+	std::atomic<std::size_t> nextPiece(0);
+	workers.run(threadsUsed, [&](unsigned int thread) {
+		generateMarkers(pieces, &nextPiece, &listeners[thread]);
+	});
+
+	// Register the markers as action listeners
+	for (unsigned int i = 0; i < threadsUsed; i++) {
+		actionListenerTracker.addListeners(&listeners[i]);
 	}
 }
 
@@ -149,14 +403,51 @@ void EventProcessor::executeEvents() {
  * Clear everything on startup
  */
 void EventProcessor::onStartup() {
-	// Delete stored events
-	for (std::vector<std::vector<Event*>*>::const_iterator i = eventQueues.begin(); i != eventQueues.end(); ++i) {
-        for (std::vector<Event*>::iterator j = (*i)->begin(); j != (*i)->end(); ++j) {
-            delete *j;
-        }
+	// Discard stored events
+	events.clear();
+
+	changedPositions.clear();
+    actionListenerTracker.onStartup();
+}
 
-        (*i)->clear();
+/**
+ * Take back the events in a record, restoring the pieces that they changed or destroyed
+ *
+ * Only the changed pieces leave and enter the board again, so the move markers and action listeners are updated in
+ * the same way as for a move.
+ */
+void EventProcessor::undo(MoveRecord* undone) {
+	// Take the changed pieces off the board
+	for (std::vector<MoveRecord::PieceState>::const_iterator i = undone->pieces.begin(); i != undone->pieces.end(); ++i) {
+		if (pieceTracker->getPiece(i->piece->getPos()) == i->piece) {
+			execute(Event(i->piece, Event::LEAVE, 0, sf::Vector2i(), Event::UNDO));
+		}
 	}
 
-    actionListenerTracker.onStartup();
+	// Put them back as they were
+	for (std::vector<MoveRecord::PieceState>::const_iterator i = undone->pieces.begin(); i != undone->pieces.end(); ++i) {
+		i->piece->setPos(i->pos);
+		i->piece->setMoveCount(i->moveCount);
+		i->piece->setLastMove(i->lastMove);
+
+		if (i->onBoard) {
+			pieceTracker->addPiece(i->piece);
+		}
+	}
+
+	// Restore the destroyed pieces, which are owned by the board again
+	for (std::vector<Piece*>::const_iterator i = undone->destroyed.begin(); i != undone->destroyed.end(); ++i) {
+		controller->addPiece((*i)->getTeam());
+		(*i)->onRestore(pieceTracker);
+	}
+
+	undone->destroyed.clear();
+
+	for (std::vector<MoveRecord::PieceState>::const_iterator i = undone->pieces.begin(); i != undone->pieces.end(); ++i) {
+		if (i->onBoard) {
+			execute(Event(i->piece, Event::ENTER, 0, sf::Vector2i(), Event::UNDO));
+		}
+	}
+
+	propagateObstructions();
 }
@@ -1,12 +1,19 @@
 #ifndef CHESS_EVENT_PROCESSOR
 #define CHESS_EVENT_PROCESSOR
 
+#include <SFML/Graphics.hpp>
+#include <atomic>
 #include <vector>
+#include "../components/event.h"
+#include "../utils/workerPool.h"
 
 // Forward declarations
 class ActionListenerTracker;
 class Controller;
-class Event;
+class Journal;
+class MoveMarker;
+class MoveRecord;
+class Piece;
 class PieceTracker;
 
 
@@ -18,30 +25,98 @@ private:
 	PieceTracker* pieceTracker;
 	ActionListenerTracker& actionListenerTracker;
 	Controller* controller;
+	Journal* journal;
+	MoveRecord* record;
 
 	// Constants
-	static const int NUM_QUEUES = 3;
 
-	// Event queues
-	const std::vector<std::vector<Event*>*> eventQueues = {
-		new std::vector<Event*>(),
-		new std::vector<Event*>(),
-		new std::vector<Event*>(),
-	};
+	/**
+	 * The number of pieces that a thread takes at a time when a board is loaded, and the fewest pieces for each thread
+	 */
+	static const std::size_t PIECES_PER_TASK = 64;
+	static const std::size_t MIN_PIECES_PER_THREAD = 1024;
+
+	/**
+	 * The fewest pieces entering the board at once for their move markers to be updated on several threads
+	 */
+	static const std::size_t MIN_PARALLEL_ENTERS = 4;
+
+	// The events for the move being made in the order that they were added, which keeps its capacity between moves
+	std::vector<Event> events;
+
+	// The number of threads used to update the move markers of pieces entering the board, and the workers that they
+	// are run on when a board is loaded and when pieces enter it
+	unsigned int numThreads;
+	WorkerPool workers;
+
+	// The positions that pieces entered or left while executing the events
+	std::vector<sf::Vector2i> changedPositions;
 
 	// Helpers
 
+	/**
+	 * Record an event in the journal and the move record before it is executed
+	 */
+	void recordEvent(const Event& event);
+
 	/**
 	 * Execute an event
 	 */
-	void execute(Event* event);
+	void execute(const Event& event);
 
-public:
-	// Constants
-	static const int START = 0;
-	static const int EVENT = 1;
-	static const int AFTER = 2;
+	/**
+	 * Execute an event that does not enter the board
+	 */
+	void apply(const Event& event);
+
+	/**
+	 * Alert the action listeners after a piece enters the board and its move markers have been updated
+	 */
+	void arrive(const Event& event);
+
+	/**
+	 * Get when an event happens at its position compared to the events of other pieces there: leaving, then moving to
+	 * it, then entering it
+	 */
+	static inline int getStage(Event::Action action) {
+		return action == Event::LEAVE ? 0 : action == Event::MOVE ? 1 : 2;
+	}
+
+	/**
+	 * Group the events into waves, where the events in a wave only depend on events in earlier waves
+	 */
+	void schedule(std::vector<std::vector<std::size_t>>& waves) const;
+
+	/**
+	 * Execute a wave of events that do not depend on each other
+	 */
+	void executeWave(const std::vector<std::size_t>& wave);
+
+	/**
+	 * Update the move markers for pieces entering the board taken from a shared counter
+	 */
+	void updateMarkers(
+		const std::vector<const Event*>* entering,
+		std::atomic<std::size_t>* nextPiece,
+		std::vector<std::vector<MoveMarker*>>* generated,
+		std::vector<std::vector<MoveMarker*>>* deleted
+	) const;
+
+	/**
+	 * Update the obstruction counts of the move markers past each changed position
+	 */
+	void propagateObstructions();
 
+	/**
+	 * Generate the move markers for pieces taken from a shared counter, collecting their listeners sorted by position
+	 */
+	void generateMarkers(
+		const std::vector<Piece*>* pieces,
+		std::atomic<std::size_t>* nextPiece,
+		std::vector<std::pair<sf::Vector2i, MoveMarker*>>* listeners
+	) const;
+
+public:
 	// Constructors
     EventProcessor(PieceTracker* pieceTracker_, ActionListenerTracker& actionListenerTracker_, Controller* controller_);
     ~EventProcessor();
@@ -49,22 +124,46 @@ public:
 	// Public API
 
 	/**
-	 * Add an event to an event queue
+	 * Add an event for the move being made. The events for each piece are executed in the order that they are added.
 	 *
-	 * @param queueIndex the index of the queue to add to
-	 * @param event the event to add to the queue
+	 * @param event the event to add
 	 */
-	void insertInQueue(int queueIndex, Event* event);
+	void addEvent(const Event& event);
 
 	/**
 	 * Execute all of the events
 	 */
     void executeEvents();
 
+    /**
+	 * Generate the move markers for all the pieces of a board that was just loaded
+	 */
+    void initializePieces(const std::vector<Piece*>* pieces);
+
     /**
 	 * Clear everything on startup
 	 */
     void onStartup();
+
+    /**
+	 * Take back the events in a record, restoring the pieces that they changed or destroyed
+	 */
+    void undo(MoveRecord* undone);
+
+    /**
+	 * Set the number of threads used to update the move markers of pieces entering the board
+	 */
+    inline void setThreads(unsigned int numThreads_) { numThreads = numThreads_; }
+
+    /**
+	 * Record the executed events in a journal, or stop recording them if the journal is null
+	 */
+    inline void setJournal(Journal* journal_) { journal = journal_; }
+
+    /**
+	 * Record the executed events so that they can be taken back, or stop recording them if the record is null
+	 */
+    inline void setRecord(MoveRecord* record_) { record = record_; }
 };
 
 #endif // CHESS_EVENT_PROCESSOR
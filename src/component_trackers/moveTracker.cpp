@@ -4,6 +4,8 @@
 #include "../components/piece.h"
 #include "../components/pieceDef.h"
 #include "../components/moveDef.h"
+#include "../utils/metrics.h"
+#include "../utils/trace.h"
 
 // Private methods
 
@@ -11,48 +13,201 @@
  * Delete all of the piece's move markers
  */
 void MoveTracker::clearMarkers() {
+	// Delete the markers in each ray, including the ones hidden in the maps by overlapping rays
+	for (std::vector<MoveMarker*>::iterator i = terminalMoveMarkers->begin(); i != terminalMoveMarkers->end(); ++i) {
+		MoveMarker* marker = *i;
+		while (marker != nullptr) {
+			MoveMarker* prev = marker->prev;
+			delete marker;
+			marker = prev;
+		}
+	}
+
 	// Remove all the markers from the list of terminal move markers
 	terminalMoveMarkers->clear();
 
-	// Delete the markers
+	// Clear the maps
 	for (std::map<
 			const MoveDef*,
 			std::map<sf::Vector2i, MoveMarker*, VectorUtils::cmpVectorLexicographically>*
 		>::iterator i = moveMarkers->begin(); i != moveMarkers->end(); ++i
 	) {
-		for (std::map<
-				sf::Vector2i,
-				MoveMarker*,
-				VectorUtils::cmpVectorLexicographically
-			>::iterator j = i->second->begin(); j != i->second->end(); ++j
-		) {
-            delete j->second;
-		}
-
 		i->second->clear();
     }
 }
 
 /**
- * Generate the piece's move markers
+ * Register a generated marker as an action listener, or keep it to be registered later if the piece is being set up
+ * on a worker thread
  */
-void MoveTracker::generateMarkers() {
-	// Generate the initial move markers for each move
-	for (std::map<
-			const MoveDef*,
-			std::map<sf::Vector2i, MoveMarker*, VectorUtils::cmpVectorLexicographically>*
-		>::iterator i = moveMarkers->begin(); i != moveMarkers->end(); ++i
-	) {
-		// Add the initial move markers for the move
-		const std::vector<MoveMarker*>* markers = i->first->generateMarkers(piece);
-		for (std::vector<MoveMarker*>::const_iterator j = markers->begin(); j != markers->end(); ++j) {
-			i->second->insert(std::make_pair((*j)->getPos(), *j));
-            terminalMoveMarkers->push_back(*j);
+void MoveTracker::registerMarker(MoveMarker* marker, PieceTracker* pieceTracker) {
+	if (generatedMarkers != nullptr) {
+		generatedMarkers->push_back(marker);
+	} else {
+		pieceTracker->onGeneration(marker);
+	}
+}
+
+/**
+ * Unregister a marker as an action listener and delete it, or keep it to be unregistered and deleted later if the
+ * piece is being updated on a worker thread
+ */
+void MoveTracker::unregisterMarker(MoveMarker* marker, PieceTracker* pieceTracker) {
+	if (deletedMarkers != nullptr) {
+		deletedMarkers->push_back(marker);
+	} else {
+		pieceTracker->onDeletion(marker);
+		delete marker;
+	}
+}
+
+/**
+ * Generate the initial move markers for a move
+ */
+void MoveTracker::generateMarkers(const MoveDef* move, PieceTracker* pieceTracker) {
+	std::map<sf::Vector2i, MoveMarker*, VectorUtils::cmpVectorLexicographically>* markers =
+		moveMarkers->find(move)->second;
+
+	// Add the initial move markers for the move
+	const std::vector<MoveMarker*>* generated = move->generateMarkers(piece);
+	for (std::vector<MoveMarker*>::const_iterator i = generated->begin(); i != generated->end(); ++i) {
+		markers->insert(std::make_pair((*i)->getPos(), *i));
+		terminalMoveMarkers->push_back(*i);
+
+		// Update the move marker on generation
+		(*i)->onGeneration(pieceTracker);
+		registerMarker(*i, pieceTracker);
+	}
+
+	delete generated;
+	generated = nullptr;
+}
+
+/**
+ * Delete a ray of move markers, starting from the given marker
+ */
+void MoveTracker::deleteRay(
+	std::map<sf::Vector2i, MoveMarker*, VectorUtils::cmpVectorLexicographically>* markers,
+	MoveMarker* first, PieceTracker* pieceTracker
+) {
+	while (first != nullptr) {
+		MoveMarker* next = first->next;
+
+		// Only remove the map entry if it belongs to this ray
+		std::map<sf::Vector2i, MoveMarker*, VectorUtils::cmpVectorLexicographically>::iterator found =
+			markers->find(first->getPos());
+		if (found != markers->end() && found->second == first) {
+			markers->erase(found);
 		}
 
-		delete markers;
-		markers = nullptr;
-    }
+		unregisterMarker(first, pieceTracker);
+		first = next;
+	}
+}
+
+/**
+ * Fit a ray to the piece's new position, keeping the markers whose positions are still on the ray
+ *
+ * A piece that moves along one of its own rays keeps that ray's markers: moving forward removes the markers up to
+ * the new position, and moving backward adds markers up to the old position. Any other ray is generated again.
+ * Added markers replace the map entries of other rays of the move that have not been updated yet. Kept markers
+ * stay registered as action listeners, since the positions they listen to do not depend on the piece's position.
+ *
+ * @return the first marker of the ray
+ */
+MoveMarker* MoveTracker::shiftRay(
+	const MoveDef* move,
+	std::map<sf::Vector2i, MoveMarker*, VectorUtils::cmpVectorLexicographically>* markers,
+	MoveMarker* first, PieceTracker* pieceTracker
+) {
+	const sf::Vector2i baseVector = first->getBaseVector();
+	const bool switchedX = first->switchedX;
+	const bool switchedY = first->switchedY;
+	const bool switchedXY = first->switchedXY;
+
+	// Find how many steps along the ray the piece moved
+	const sf::Vector2i offset = piece->getPos() - (first->getPos() - baseVector);
+	const int cross = baseVector.x * offset.y - baseVector.y * offset.x;
+	const int dot = baseVector.x * offset.x + baseVector.y * offset.y;
+	const int lengthSquared = baseVector.x * baseVector.x + baseVector.y * baseVector.y;
+	int steps = dot / lengthSquared;
+
+	// Rays with a fixed length or that the piece did not move along are generated again
+	if (move->constantMultiple || cross != 0 || dot % lengthSquared != 0) {
+		deleteRay(markers, first, pieceTracker);
+		first = nullptr;
+		steps = 0;
+	}
+
+	// Remove the markers up to the new position
+	while (steps > 0 && first != nullptr) {
+		MoveMarker* next = first->next;
+		first->next = nullptr;
+		deleteRay(markers, first, pieceTracker);
+
+		first = next;
+		steps--;
+	}
+
+	if (first == nullptr) {
+		first = new MoveMarker(
+			piece, move, baseVector, piece->getPos() + baseVector, switchedX, switchedY, switchedXY, 1
+		);
+		(*markers)[first->getPos()] = first;
+		registerMarker(first, pieceTracker);
+		return first;
+	}
+
+	first->prev = nullptr;
+
+	// Add markers up to the old position
+	for (; steps < 0; steps++) {
+		MoveMarker* added = new MoveMarker(
+			piece, move, baseVector, first->getPos() - baseVector, switchedX, switchedY, switchedXY, 1
+		);
+		added->setNext(first);
+		(*markers)[added->getPos()] = added;
+		registerMarker(added, pieceTracker);
+		first = added;
+	}
+
+	return first;
+}
+
+/**
+ * Recompute the scaling, obstructions and targets for each marker in a ray, and cut the ray off where it should
+ * no longer be generated
+ *
+ * @return the terminal marker of the ray
+ */
+MoveMarker* MoveTracker::updateRay(
+	std::map<sf::Vector2i, MoveMarker*, VectorUtils::cmpVectorLexicographically>* markers,
+	MoveMarker* first, PieceTracker* pieceTracker
+) {
+	MoveMarker* marker = first;
+	unsigned int lambda = 1;
+	unsigned int numObstructions = 0;
+
+	while (true) {
+		marker->setLambda(lambda);
+		marker->setNumObstructions(numObstructions);
+		marker->onGeneration(pieceTracker);
+
+		if (marker->next == nullptr) {
+			return marker;
+		}
+
+		// Remove the rest of the ray if it extends past where it would be generated
+		if (marker->getNextPos() == marker->getPos() || !pieceTracker->shouldGenerate(marker)) {
+			deleteRay(markers, marker->next, pieceTracker);
+			marker->next = nullptr;
+			return marker;
+		}
+
+		numObstructions += (pieceTracker->getPiece(marker->getPos()) != nullptr);
+		lambda++;
+		marker = marker->next;
+	}
 }
 
 
@@ -68,7 +223,9 @@ MoveTracker::MoveTracker(Piece* piece_) :
 		const MoveDef*,
 		std::map<sf::Vector2i, MoveMarker*, VectorUtils::cmpVectorLexicographically>*
 	>()},
-	terminalMoveMarkers{new std::vector<MoveMarker*>()}
+	terminalMoveMarkers{new std::vector<MoveMarker*>()},
+	generatedMarkers{nullptr},
+	deletedMarkers{nullptr}
 {
 	// Create a map for each move
 	const std::map<int, const MoveDef*>* moves = piece->getDef()->moves;
@@ -107,20 +264,12 @@ MoveTracker::~MoveTracker() {
 
 // Event handlers
 
-/**
- * Update the move markers on generation
- */
-void MoveTracker::onStartup(PieceTracker* pieceTracker) {
-	// Update the move marker on generation
-	for (std::vector<MoveMarker*>::iterator i = terminalMoveMarkers->begin(); i != terminalMoveMarkers->end(); ++i) {
-		(*i)->onGeneration(pieceTracker);
-	}
-}
-
 /**
  * Update the move markers when the camera changes
  */
 void MoveTracker::onCameraChange(PieceTracker* pieceTracker) {
+	Metrics::Timer timer(Metrics::CAMERA_CHANGE);
+	Trace::Span span("camera change");
     std::vector<MoveMarker*> temp;
 
 	// Update the terminal markers
@@ -147,7 +296,7 @@ void MoveTracker::onCameraChange(PieceTracker* pieceTracker) {
 
             // Update the move marker on generation
             terminal->onGeneration(pieceTracker);
-            pieceTracker->onGeneration(terminal);
+            registerMarker(terminal, pieceTracker);
         }
 
         // Add the new terminal move marker to a temporary list
@@ -162,14 +311,99 @@ void MoveTracker::onCameraChange(PieceTracker* pieceTracker) {
 }
 
 /**
- * Update the move markers when the piece moves
+ * Update the move markers when the piece moves, keeping the rays that the piece moved along
  */
-void MoveTracker::onMove() {
-	// Clear all of the piece's old move markers
-	clearMarkers();
+void MoveTracker::onMove(PieceTracker* pieceTracker) {
+	Trace::Span span("generate markers");
 
-	// Generate new move markers
-	generateMarkers();
+	// Find the first marker of each ray
+	std::vector<MoveMarker*> firstMarkers;
+	for (std::vector<MoveMarker*>::iterator i = terminalMoveMarkers->begin(); i != terminalMoveMarkers->end(); ++i) {
+		MoveMarker* first = *i;
+		while (first->prev != nullptr) {
+			first = first->prev;
+		}
+
+		firstMarkers.push_back(first);
+	}
+
+	terminalMoveMarkers->clear();
+
+	// Update each ray
+	for (std::vector<MoveMarker*>::iterator i = firstMarkers.begin(); i != firstMarkers.end(); ++i) {
+		const MoveDef* move = (*i)->getRootMove();
+		std::map<sf::Vector2i, MoveMarker*, VectorUtils::cmpVectorLexicographically>* markers =
+			moveMarkers->find(move)->second;
+
+		// Remove the rays for moves that the piece can no longer make
+		if (!move->meetsNthStepRules(piece->getMoveCount())) {
+			deleteRay(markers, *i, pieceTracker);
+			continue;
+		}
+
+		terminalMoveMarkers->push_back(updateRay(markers, shiftRay(move, markers, *i, pieceTracker), pieceTracker));
+	}
+
+	// Generate the markers for moves that the piece could not make before
+	for (std::map<
+			const MoveDef*,
+			std::map<sf::Vector2i, MoveMarker*, VectorUtils::cmpVectorLexicographically>*
+		>::iterator i = moveMarkers->begin(); i != moveMarkers->end(); ++i
+	) {
+		if (i->second->empty()) {
+			generateMarkers(i->first, pieceTracker);
+		}
+	}
+}
+
+/**
+ * Unregister the move markers before the piece is destroyed
+ */
+void MoveTracker::onDestroy(PieceTracker* pieceTracker) {
+	for (std::vector<MoveMarker*>::iterator i = terminalMoveMarkers->begin(); i != terminalMoveMarkers->end(); ++i) {
+		for (MoveMarker* marker = *i; marker != nullptr; marker = marker->prev) {
+			pieceTracker->onDeletion(marker);
+		}
+	}
+}
+
+/**
+ * Generate the move markers when a board is loaded, keeping the generated markers in a list instead of registering
+ * them, since other pieces may be set up at the same time
+ */
+void MoveTracker::onStartup(PieceTracker* pieceTracker, std::vector<MoveMarker*>* generated) {
+	generatedMarkers = generated;
+	onMove(pieceTracker);
+	onCameraChange(pieceTracker);
+	generatedMarkers = nullptr;
+}
+
+/**
+ * Update the move markers after the piece moves, keeping the generated and deleted markers in lists instead of
+ * registering and unregistering them, since other pieces may be updated at the same time. The deleted markers are
+ * not deleted until they have been unregistered.
+ */
+void MoveTracker::onDeferredMove(
+	PieceTracker* pieceTracker, std::vector<MoveMarker*>* generated, std::vector<MoveMarker*>* deleted
+) {
+	generatedMarkers = generated;
+	deletedMarkers = deleted;
+	onMove(pieceTracker);
+	onCameraChange(pieceTracker);
+	generatedMarkers = nullptr;
+	deletedMarkers = nullptr;
+}
+
+/**
+ * Register the move markers again when a destroyed piece is restored
+ */
+void MoveTracker::onRestore(PieceTracker* pieceTracker) {
+	for (std::vector<MoveMarker*>::iterator i = terminalMoveMarkers->begin(); i != terminalMoveMarkers->end(); ++i) {
+		for (MoveMarker* marker = *i; marker != nullptr; marker = marker->prev) {
+			marker->onGeneration(pieceTracker);
+			registerMarker(marker, pieceTracker);
+		}
+	}
 }
 
 
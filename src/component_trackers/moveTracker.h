@@ -33,9 +33,29 @@ private:
 
 	std::vector<MoveMarker*>* terminalMoveMarkers;
 
+	// The markers generated and deleted while the piece is updated on a worker thread, which are registered and
+	// unregistered afterwards
+	std::vector<MoveMarker*>* generatedMarkers;
+	std::vector<MoveMarker*>* deletedMarkers;
+
 	// Helper methods
+    void registerMarker(MoveMarker* marker, PieceTracker* pieceTracker);
+    void unregisterMarker(MoveMarker* marker, PieceTracker* pieceTracker);
     void clearMarkers();
-    void generateMarkers();
+    void generateMarkers(const MoveDef* move, PieceTracker* pieceTracker);
+    void deleteRay(
+		std::map<sf::Vector2i, MoveMarker*, VectorUtils::cmpVectorLexicographically>* markers,
+		MoveMarker* first, PieceTracker* pieceTracker
+	);
+    MoveMarker* shiftRay(
+		const MoveDef* move,
+		std::map<sf::Vector2i, MoveMarker*, VectorUtils::cmpVectorLexicographically>* markers,
+		MoveMarker* first, PieceTracker* pieceTracker
+	);
+    MoveMarker* updateRay(
+		std::map<sf::Vector2i, MoveMarker*, VectorUtils::cmpVectorLexicographically>* markers,
+		MoveMarker* first, PieceTracker* pieceTracker
+	);
 
 	// Friends
 	friend Piece;
@@ -47,9 +67,14 @@ public:
     ~MoveTracker();
 
     // Event handlers
-    void onStartup(PieceTracker* pieceTracker);
     void onCameraChange(PieceTracker* pieceTracker);
-	void onMove();
+	void onMove(PieceTracker* pieceTracker);
+	void onDestroy(PieceTracker* pieceTracker);
+	void onRestore(PieceTracker* pieceTracker);
+	void onStartup(PieceTracker* pieceTracker, std::vector<MoveMarker*>* generated);
+	void onDeferredMove(
+		PieceTracker* pieceTracker, std::vector<MoveMarker*>* generated, std::vector<MoveMarker*>* deleted
+	);
 
     // Methods
     const std::vector<MoveMarker*>* getMoveMarkers(sf::Vector2i pos) const;
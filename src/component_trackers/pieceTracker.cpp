@@ -5,6 +5,7 @@
 #include "../components/moveMarker.h"
 #include "moveTracker.h"
 #include "../components/piece.h"
+#include "../utils/metrics.h"
 
 
 
@@ -58,6 +59,8 @@ void PieceTracker::clearPieces() {
 		delete pieces;
 		pieces = nullptr;
 	}
+
+	chunks.clear();
 }
 
 // Public event handlers
@@ -71,6 +74,12 @@ void PieceTracker::onStartup(
 ) {
 	pieceDefs = defs;
 	pieces = startPieces;
+
+	// Count the pieces in each chunk
+	chunks.clear();
+	for (std::map<sf::Vector2i, Piece*>::const_iterator i = pieces->begin(); i != pieces->end(); ++i) {
+		chunks.add(i->first, i->second->getTeam());
+	}
 }
 
 /**
@@ -90,6 +99,13 @@ void PieceTracker::onGeneration(MoveMarker* generated) {
     game->onGeneration(generated);
 }
 
+/**
+ * Notify the game that a move marker is about to be deleted
+ */
+void PieceTracker::onDeletion(MoveMarker* deleted) {
+    game->onDeletion(deleted);
+}
+
 
 
 // Accessors
@@ -98,6 +114,10 @@ void PieceTracker::onGeneration(MoveMarker* generated) {
  * Determine whether a move marker should generate another marker
  */
 bool PieceTracker::shouldGenerate(const MoveMarker* terminal) const {
+	if (game->renderer == nullptr) {
+		return isInGenerationBounds(terminal->getBaseVector(), terminal->getNextPos());
+	}
+
 	return game->renderer->shouldGenerate(terminal);
 }
 
@@ -105,9 +125,33 @@ bool PieceTracker::shouldGenerate(const MoveMarker* terminal) const {
  * Determine whether a move marker should be deleted
  */
 bool PieceTracker::shouldDelete(const MoveMarker* terminal) const {
+	if (game->renderer == nullptr) {
+		return
+			(terminal->getPrev() != nullptr) &&
+			!(isInGenerationBounds(terminal->getBaseVector(), terminal->getPrev()->getPos()));
+	}
+
 	return game->renderer->shouldDelete(terminal);
 }
 
+/**
+ * Determine whether a position is within the generation bounds when there is no window, in the same way as
+ * Renderer::shouldGenerate does for the screen
+ */
+bool PieceTracker::isInGenerationBounds(sf::Vector2i baseVector, sf::Vector2i pos) const {
+	const sf::IntRect& bounds = game->generationBounds;
+
+	const bool insideX =
+		(baseVector.x < 0 && pos.x >= bounds.left) ||
+		(baseVector.x > 0 && pos.x < bounds.left + bounds.width);
+
+	const bool insideY =
+		(baseVector.y < 0 && pos.y >= bounds.top) ||
+		(baseVector.y > 0 && pos.y < bounds.top + bounds.height);
+
+	return insideX || insideY;
+}
+
 
 
 // Public methods
@@ -121,6 +165,7 @@ void PieceTracker::addPiece(Piece* piece) {
 
 	// Insert the piece
 	pieces->insert(std::make_pair(piece->getPos(), piece));
+	chunks.add(piece->getPos(), piece->getTeam());
 }
 
 /**
@@ -134,6 +179,7 @@ bool PieceTracker::removePiece(sf::Vector2i pos) {
 	}
 
 	pieces->erase(pieces->find(pos));
+	chunks.remove(pos, piece->getTeam());
 	return true;
 }
 
@@ -174,6 +220,7 @@ const MoveMarker* PieceTracker::getValidMove(Piece* piece, sf::Vector2i dest) {
  * Get all the move markers at a position
  */
 std::vector<MoveMarker*>* PieceTracker::getMoveMarkers(sf::Vector2i pos) const {
+	Metrics::Timer timer(Metrics::GET_MOVE_MARKERS);
 	std::vector<MoveMarker*>* markers = new std::vector<MoveMarker*>();
 
 	// Iterate through each piece
@@ -4,6 +4,7 @@
 #include <SFML/Graphics.hpp>
 #include <map>
 #include "../components/pieceDef.h"
+#include "../utils/chunkIndex.h"
 #include "../utils/vectorUtils.h"
 
 // Forward declarations
@@ -24,9 +25,17 @@ private:
     std::map<std::string, const PieceDef*>* pieceDefs;
     std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces;
 
+    /**
+     * The number of pieces in each chunk of the board, which the renderer draws instead of the pieces when zoomed out
+     */
+    ChunkIndex chunks;
+
     // Friends
     friend Renderer;
 
+    // Helpers
+    bool isInGenerationBounds(sf::Vector2i baseVector, sf::Vector2i pos) const;
+
 public:
     // Constructors
     PieceTracker(Game* g);
@@ -39,10 +48,14 @@ public:
 	);
     void onCameraChange();
 	void onGeneration(MoveMarker* generated);
+	void onDeletion(MoveMarker* deleted);
 
     // Accessors
 
     const std::vector<Piece*>* getPieces() const;
+    inline const std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* getPieceMap() const {
+		return pieces;
+	}
     Piece* getPiece(sf::Vector2i pos) const;
 
     /**
@@ -1,6 +1,7 @@
 #ifndef CHESS_EVENT_H
 #define CHESS_EVENT_H
 
+#include <SFML/Graphics.hpp>
 #include <string>
 
 // Forward declarations
@@ -9,18 +10,45 @@ class Piece;
 
 
 // Class declaration
+
+/**
+ * A plain value describing one step of a move, so that events can be stored by value in the event list
+ */
 class Event {
 public:
+	// Helper enums
+	enum Action {
+		ENTER, LEAVE, MOVE, DESTROY, NOTHING
+	};
+
+	// Constants
+
+	/**
+	 * Set on the events used to take back a move, which are not recorded
+	 */
+	static const unsigned int UNDO = 1;
+
 	// Constructors
-	inline Event(Piece* piece_, const std::string& action_, const std::string& args_) :
+	inline Event() :
+		piece{nullptr},
+		action{ENTER},
+		moveIndex{0},
+		dest{},
+		flags{0}
+	{
+	}
+
+	inline Event(Piece* piece_, Action action_, int moveIndex_ = 0, sf::Vector2i dest_ = sf::Vector2i(),
+		unsigned int flags_ = 0
+	) :
 		piece{piece_},
 		action{action_},
-		args{args_}
+		moveIndex{moveIndex_},
+		dest{dest_},
+		flags{flags_}
 	{
 	}
 
-	inline ~Event(){}
-
 	// Public API
 
 	/**
@@ -31,12 +59,38 @@ public:
 	/**
 	 * The action that this object represents
 	 */
-	const std::string action;
+	Action action;
 
 	/**
-	 * The arguments for the event
+	 * The index of the move being made, or -1 for moves made by targeting rules
 	 */
-	const std::string args;
+	int moveIndex;
+
+	/**
+	 * The destination of a move, or the offset of a move in a targeting rule
+	 */
+	sf::Vector2i dest;
+
+	/**
+	 * Extra information about the event
+	 */
+	unsigned int flags;
+
+	/**
+	 * Read an action from its name in a piece definition file
+	 *
+	 * @return false if there is no action with the name
+	 */
+	inline static bool actionFromString(const std::string& s, Action& action) {
+		if      (s == "enter")   action = ENTER;
+		else if (s == "leave")   action = LEAVE;
+		else if (s == "move")    action = MOVE;
+		else if (s == "destroy") action = DESTROY;
+		else if (s == "nothing") action = NOTHING;
+		else return false;
+
+		return true;
+	}
 };
 
 #endif // CHESS_EVENT_H
@@ -1,5 +1,6 @@
 #include "moveDef.h"
 
+#include <climits>
 #include "moveMarker.h"
 #include "numRule.h"
 #include "piece.h"
@@ -49,12 +50,17 @@ MoveDef::MoveDef(
     scalingRules{scalingRules_},
     nthStepRules{nthStepRules_},
     targetingRules{targetingRules_},
-    constantMultiple{0}
+    constantMultiple{0},
+    obstructionLimit{NumRule::getUpperBound(leapingRules_)}
 {
 	if (scalingRules->size() == 1) {
 		NumRule* rule = *(scalingRules->begin());
 		constantMultiple = (rule->getOperation() == NumRule::EQ) ? (rule->getNum()) : (0);
 	}
+
+	if (obstructionLimit != UINT_MAX) {
+		obstructionLimit++;
+	}
 }
 
 /**
@@ -33,6 +33,12 @@ public:
 
 	unsigned int constantMultiple;
 
+	/**
+	 * The largest obstruction count that move markers store, since every count past the leaping rules' upper bound
+	 * fails them in the same way
+	 */
+	unsigned int obstructionLimit;
+
 	// Constructors
 	MoveDef(
 		int index_, sf::Vector2i baseVector_, bool endsTurn,
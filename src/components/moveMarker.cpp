@@ -1,6 +1,7 @@
 #include "moveMarker.h"
 
 #include <SFML/Graphics.hpp>
+#include <algorithm>
 #include <tuple>
 #include "event.h"
 #include "moveDef.h"
@@ -8,6 +9,7 @@
 #include "piece.h"
 #include "pieceDef.h"
 #include "../component_trackers/actionListenerTracker.h"
+#include "../utils/metrics.h"
 #include "targetingRule.h"
 
 // Private helpers
@@ -93,12 +95,17 @@ MoveMarker::MoveMarker(
 	switchedXY{switchedXY_},
 	lambda{lambda_}
 {
+	Metrics::adjust(Metrics::MOVE_MARKERS, 1);
 }
 
 /**
  * Destructor
  */
 MoveMarker::~MoveMarker() {
+	Metrics::adjust(Metrics::MOVE_MARKERS, -1);
+	delete targets;
+
+	targets    = nullptr;
 	rootPiece  = nullptr;
 	rootMove   = nullptr;
 	next       = nullptr;
@@ -114,8 +121,8 @@ MoveMarker::~MoveMarker() {
  *
  * @param event the event to handle
  */
-void MoveMarker::handleEvent(Event* event) {
-	Piece* piece = event->piece;
+void MoveMarker::handleEvent(const Event& event) {
+	Piece* piece = event.piece;
 
 	sf::Vector2i pos = piece->getPos();
 
@@ -132,17 +139,17 @@ void MoveMarker::handleEvent(Event* event) {
 
 	const TargetingRule* rule = std::get<2>(ruleIter->second);
 
-    if ("leave" == event->action) {
+    if (event.action == Event::LEAVE) {
         std::get<0>(ruleIter->second) = rule->matches(rootPiece, nullptr);
 		std::get<1>(ruleIter->second) = nullptr;
-    } else if ("enter" == event->action) {
+    } else if (event.action == Event::ENTER) {
 		std::get<0>(ruleIter->second) = rule->matches(rootPiece, piece);
 		std::get<1>(ruleIter->second) = piece;
     }
 }
 
 /**
- * Update the move marker when it is generated
+ * Update the move marker when it is generated, or when it is kept after its piece moves
  */
 void MoveMarker::onGeneration(PieceTracker* pieceTracker) {
     meetsLeapingRule = meetsNumRule(rootMove->leapingRules, numObstructions, false);
@@ -150,6 +157,7 @@ void MoveMarker::onGeneration(PieceTracker* pieceTracker) {
     meetsNthStepRule = meetsNumRule(rootMove->nthStepRules, rootPiece->getMoveCount(), false);
 
     // Generate map for targeting rules
+    targets->clear();
 	for (std::vector<const TargetingRule*>::const_iterator i = rootMove->targetingRules->begin();
 		i != rootMove->targetingRules->end(); ++i
 	) {
@@ -166,33 +174,24 @@ void MoveMarker::onGeneration(PieceTracker* pieceTracker) {
 }
 
 /**
- * Update the move marker chain's properties
- */
-void MoveMarker::update(Piece* piece, PieceTracker* pieceTracker, unsigned int numObstructions_) {
-	numObstructions = numObstructions_;
-	meetsLeapingRule = meetsNumRule(getRootMove()->leapingRules, numObstructions, false);
-
-	// Check if there is a next tile
-	if (next != nullptr) {
-		next->update(piece, pieceTracker, numObstructions_ + (pieceTracker->getPiece(pos) != nullptr));
-	}
-}
-
-/**
- * Update the move marker when a piece leaves the tile
- */
-void MoveMarker::onPieceLeave(Piece* piece, PieceTracker* pieceTracker) {
-	if (next != nullptr) {
-		next->update(piece, pieceTracker, next->numObstructions - 1);
-	}
-}
-
-/**
- * Update the move marker when a piece enters the tile
+ * Update the obstruction counts of the markers after this one when a piece enters or leaves the tile
+ *
+ * Walks along the ray until a marker's count is already correct. Everything past that marker was counted from the
+ * same tiles, and counts are capped, so the walk stops soon after the leaping rules can no longer be met.
  */
-void MoveMarker::onPieceEnter(Piece* piece, PieceTracker* pieceTracker) {
-	if (next != nullptr) {
-		next->update(piece, pieceTracker, next->numObstructions + 1);
+void MoveMarker::onObstructionChange(PieceTracker* pieceTracker) {
+	const unsigned int limit = rootMove->obstructionLimit;
+
+	MoveMarker* marker = this;
+	while (marker->next != nullptr) {
+		const unsigned int count = std::min(
+			marker->numObstructions + (pieceTracker->getPiece(marker->pos) != nullptr), limit
+		);
+		if (count == marker->next->numObstructions) break;
+
+		marker = marker->next;
+		marker->numObstructions = count;
+		marker->meetsLeapingRule = meetsNumRule(rootMove->leapingRules, count, false);
 	}
 }
 
@@ -299,5 +298,12 @@ void MoveMarker::setPrev(MoveMarker* newPrev) {
  * Set whether the move marker requires a leap
  */
 void MoveMarker::setNumObstructions(unsigned int numObstructions_) {
-	numObstructions = numObstructions_;
+	numObstructions = std::min(numObstructions_, rootMove->obstructionLimit);
+}
+
+/**
+ * Set the scaling factor for a move marker that is kept when its piece moves along its ray
+ */
+void MoveMarker::setLambda(unsigned int lambda_) {
+	lambda = lambda_;
 }
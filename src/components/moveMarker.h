@@ -8,6 +8,7 @@
 // Forward definitions
 class Event;
 class MoveDef;
+class MoveTracker;
 class NumRule;
 class Piece;
 class TargetingRule;
@@ -88,14 +89,8 @@ private:
 	 */
     bool isAttacked(PieceTracker* pieceTracker) const;
 
-	// Event handlers
-
-	/**
-	 * Update the move marker chain's properties
-	 */
-	void update(Piece* piece, PieceTracker* pieceTracker, unsigned int numObstructions_);
-
 	// Friends
+	friend MoveTracker;
 	friend Piece;
 	friend Renderer;
 
@@ -111,7 +106,7 @@ public:
 	/**
 	 * The scaling factor to get from the base move to this position
 	 */
-	const unsigned int lambda;
+	unsigned int lambda;
 
 	// Constructors / Destructor
 	MoveMarker(
@@ -127,22 +122,17 @@ public:
 	 *
 	 * @param event the event to handle
 	 */
-	void handleEvent(Event* event);
+	void handleEvent(const Event& event);
 
 	/**
-	 * Update the move marker when it is generated
+	 * Update the move marker when it is generated, or when it is kept after its piece moves
 	 */
 	void onGeneration(PieceTracker* pieceTracker);
 
 	/**
-	 * Update the move marker when a piece leaves the tile
+	 * Update the obstruction counts of the markers after this one when a piece enters or leaves the tile
 	 */
-	void onPieceLeave(Piece* piece, PieceTracker* pieceTracker);
-
-	/**
-	 * Update the move marker when a piece enters the tile
-	 */
-	void onPieceEnter(Piece* piece, PieceTracker* pieceTracker);
+	void onObstructionChange(PieceTracker* pieceTracker);
 
 	// Accessors
 
@@ -182,7 +172,7 @@ public:
 	inline const sf::Vector2i getBaseVector() const { return baseVector; }
 
 	/**
-	 * Get the number of pieces in the way of this move marker
+	 * Get the number of pieces in the way of this move marker, capped at the move's obstruction limit
 	 */
 	inline const unsigned int getNumObstructions() const { return numObstructions; }
 
@@ -214,10 +204,15 @@ public:
 	void setPrev(MoveMarker* newPrev);
 
 	/**
-	 * Set whether the move marker requires a leap
+	 * Set the number of pieces in the way of this move marker, capping it at the move's obstruction limit
 	 */
 	void setNumObstructions(unsigned int numObstructions_);
 
+	/**
+	 * Set the scaling factor for a move marker that is kept when its piece moves along its ray
+	 */
+	void setLambda(unsigned int lambda_);
+
 	// Helpers
 
 	/**
@@ -0,0 +1,103 @@
+#ifndef CHESS_MOVE_RECORD_H
+#define CHESS_MOVE_RECORD_H
+
+#include <SFML/Graphics.hpp>
+#include <climits>
+#include <vector>
+#include "event.h"
+#include "piece.h"
+
+// Class declaration
+
+/**
+ * The events executed for one move or the end of a turn, with the state needed to take it back
+ */
+class MoveRecord {
+public:
+	// Helper structs
+
+	/**
+	 * The state of a piece before the first event that changed it
+	 */
+	struct PieceState {
+		Piece* piece;
+		sf::Vector2i pos;
+		unsigned int moveCount;
+		int lastMove;
+		bool onBoard;
+	};
+
+	/**
+	 * The team to move, whether it has moved and the piece that is continuing its turn
+	 */
+	struct TurnState {
+		unsigned int team;
+		bool moved;
+		Piece* selectedPiece;
+	};
+
+	// Constants
+
+	/**
+	 * The journal ply of a move that was made before the journal started
+	 */
+	static const unsigned int NO_PLY = UINT_MAX;
+
+	// Constructors
+	inline MoveRecord(TurnState before_, unsigned int ply_ = NO_PLY) :
+		before{before_},
+		after(before_),
+		ply{ply_}
+	{
+	}
+
+	/**
+	 * Destructor, which deletes the pieces destroyed by the events if the move has not been taken back
+	 */
+	inline ~MoveRecord() {
+		for (std::vector<Piece*>::iterator i = destroyed.begin(); i != destroyed.end(); ++i) {
+			delete *i;
+		}
+	}
+
+	// Public API
+
+	/**
+	 * The events in the order that they were executed
+	 */
+	std::vector<Event> events;
+
+	/**
+	 * The pieces changed by the events, in the order that they were first changed
+	 */
+	std::vector<PieceState> pieces;
+
+	/**
+	 * The pieces destroyed by the events, which are kept so that they can be restored
+	 */
+	std::vector<Piece*> destroyed;
+
+	/**
+	 * The turn state before and after the move
+	 */
+	TurnState before;
+	TurnState after;
+
+	/**
+	 * The journal ply of the board before the move, which the journal goes back to when the move is taken back
+	 */
+	unsigned int ply;
+
+	/**
+	 * Record the state of a piece before an event changes it, if it has not been changed already
+	 */
+	inline void onChange(Piece* piece, bool onBoard) {
+		for (std::vector<PieceState>::const_iterator i = pieces.begin(); i != pieces.end(); ++i) {
+			if (i->piece == piece) return;
+		}
+
+		pieces.push_back(PieceState{ piece, piece->getPos(), piece->getMoveCount(), piece->getLastMove(), onBoard });
+	}
+};
+
+#endif // CHESS_MOVE_RECORD_H
@@ -1,5 +1,7 @@
 #include "numRule.h"
 
+#include <algorithm>
+#include <climits>
 #include <string>
 #include "../io/resourceLoader.h"
 
@@ -103,3 +105,26 @@ bool NumRule::matches(unsigned int candidate) const {
 		return false;
     }
 }
+
+/**
+ * Get the largest candidate that can satisfy any of the num rules, or UINT_MAX if there is no upper bound
+ */
+unsigned int NumRule::getUpperBound(const std::vector<NumRule*>* numRules) {
+	unsigned int upperBound = 0;
+	for (std::vector<NumRule*>::const_iterator i = numRules->begin(); i != numRules->end(); ++i) {
+		const unsigned int num = (*i)->getNum();
+		switch ((*i)->getOperation()) {
+		case NumRule::EQ:
+		case NumRule::LE:
+			upperBound = std::max(upperBound, num);
+			break;
+		case NumRule::LT:
+			upperBound = std::max(upperBound, (num == 0) ? (0) : (num - 1));
+			break;
+		default:
+			return UINT_MAX;
+		}
+	}
+
+	return upperBound;
+}
@@ -2,6 +2,7 @@
 #define CHESS_NUM_RULE_H
 
 #include <string>
+#include <vector>
 
 // Class declaration
 class NumRule {
@@ -26,6 +27,8 @@ public:
 
     // Methods
     bool matches(unsigned int candidate) const;
+
+    static unsigned int getUpperBound(const std::vector<NumRule*>* numRules);
 };
 
 #endif // CHESS_NUM_RULE_H
@@ -78,24 +78,38 @@ void Piece::setPos(sf::Vector2i dest) {
 	moveCount++;
 }
 
-void Piece::move(sf::Vector2i dest) {
+void Piece::move(sf::Vector2i dest, PieceTracker* pieceTracker) {
     pos = dest;
     moveCount++;
-    moveTracker->onMove();
+    moveTracker->onMove(pieceTracker);
 }
 
 
 
 // Event handlers
 
-void Piece::onStartup(PieceTracker* pieceTracker) {
-    moveTracker->onStartup(pieceTracker);
-}
-
 void Piece::onCameraChange(PieceTracker* pieceTracker) {
 	moveTracker->onCameraChange(pieceTracker);
 }
 
-void Piece::onMove() {
-	moveTracker->onMove();
+void Piece::onMove(PieceTracker* pieceTracker) {
+	moveTracker->onMove(pieceTracker);
+}
+
+void Piece::onDestroy(PieceTracker* pieceTracker) {
+	moveTracker->onDestroy(pieceTracker);
+}
+
+void Piece::onRestore(PieceTracker* pieceTracker) {
+	moveTracker->onRestore(pieceTracker);
+}
+
+void Piece::onStartup(PieceTracker* pieceTracker, std::vector<MoveMarker*>* generated) {
+	moveTracker->onStartup(pieceTracker, generated);
+}
+
+void Piece::onDeferredMove(
+	PieceTracker* pieceTracker, std::vector<MoveMarker*>* generated, std::vector<MoveMarker*>* deleted
+) {
+	moveTracker->onDeferredMove(pieceTracker, generated, deleted);
 }
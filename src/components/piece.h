@@ -76,12 +76,18 @@ public:
 	// Mutators
 	void setPos(sf::Vector2i dest);
 	inline void setLastMove(int index) { lastMove = index; }
-	void move(sf::Vector2i dest);
+	inline void setMoveCount(unsigned int count) { moveCount = count; }
+	void move(sf::Vector2i dest, PieceTracker* pieceTracker);
 
 	// Event handlers
-	void onStartup(PieceTracker* pieceTracker);
 	void onCameraChange(PieceTracker* pieceTracker);
-	void onMove();
+	void onMove(PieceTracker* pieceTracker);
+	void onDestroy(PieceTracker* pieceTracker);
+	void onRestore(PieceTracker* pieceTracker);
+	void onStartup(PieceTracker* pieceTracker, std::vector<MoveMarker*>* generated);
+	void onDeferredMove(
+		PieceTracker* pieceTracker, std::vector<MoveMarker*>* generated, std::vector<MoveMarker*>* deleted
+	);
 };
 
 #endif // CHESS_PIECE_H
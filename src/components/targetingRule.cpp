@@ -27,7 +27,7 @@ const std::map<std::string, TargetingRule::DataSpecifier> TargetingRule::DATA_SP
  */
 TargetingRule::TargetingRule(
 	const sf::Vector2i& offsetVector_, const std::string& targetName_,
-	const std::map<std::string, const NumRule*>* dataSpecifiers_, const std::vector<Event*>* actions_
+	const std::map<std::string, const NumRule*>* dataSpecifiers_, const std::vector<Event>* actions_
 ) :
 	dataSpecifiers{new std::map<DataSpecifier, const NumRule*>()},
 	actions{actions_},
@@ -61,19 +61,39 @@ TargetingRule::~TargetingRule() {
  * Check whether a piece matches the targeting rule
  */
 bool TargetingRule::matches(const Piece* rootPiece, const Piece* candidate) const {
-	// Check whether the piece name matches
 	if (candidate == nullptr) {
+		return matches(rootPiece->getTeam(), nullptr, 0, 0, 0);
+	}
+
+	return matches(
+		rootPiece->getTeam(), candidate->getDef(), candidate->getTeam(),
+		candidate->getMoveCount(), candidate->getLastMove()
+	);
+}
+
+/**
+ * Check whether a piece's properties match the targeting rule
+ *
+ * @param rootTeam the team of the piece that owns the targeting rule
+ * @param candidateDef the definition of the targeted piece, or nullptr if the target is empty
+ */
+bool TargetingRule::matches(
+	const unsigned int rootTeam, const PieceDef* candidateDef, const unsigned int candidateTeam,
+	const unsigned int candidateMoveCount, const int candidateLastMove
+) const {
+	// Check whether the piece name matches
+	if (candidateDef == nullptr) {
 		if (targetName != EMPTY_ONLY && targetName != ALL_PIECES) {
 			return false;
 		}
 	} else if (targetName != ALL_PIECES && targetName != PIECE_ONLY) {
-		if (targetName != candidate->getDef()->name) {
+		if (targetName != candidateDef->name) {
 			return false;
 		}
 	}
 
 	// Skip null candidates
-	if (candidate == nullptr) {
+	if (candidateDef == nullptr) {
 		return true;
 	}
 
@@ -84,15 +104,15 @@ bool TargetingRule::matches(const Piece* rootPiece, const Piece* candidate) cons
 	) {
 		switch (i->first) {
 		case DataSpecifier::LAST_MOVE:
-			if (!i->second->matches(candidate->getLastMove())) return false;
+			if (!i->second->matches(candidateLastMove)) return false;
 			break;
 		case DataSpecifier::LAST_TURN:
 			break;
 		case DataSpecifier::NUM_MOVES:
-            if (!i->second->matches(candidate->getMoveCount())) return false;
+            if (!i->second->matches(candidateMoveCount)) return false;
             break;
 		case DataSpecifier::SAME_TEAM:
-			if (!i->second->matches(rootPiece->getTeam() == candidate->getTeam())) return false;
+			if (!i->second->matches(rootTeam == candidateTeam)) return false;
 			break;
         default:
         	break;
@@ -102,6 +122,6 @@ bool TargetingRule::matches(const Piece* rootPiece, const Piece* candidate) cons
 	return true;
 }
 
-const std::vector<Event*>* TargetingRule::getEvents() const {
+const std::vector<Event>* TargetingRule::getEvents() const {
     return actions;
 }
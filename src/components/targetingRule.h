@@ -9,6 +9,7 @@
 class Event;
 class NumRule;
 class Piece;
+class PieceDef;
 
 
 
@@ -28,7 +29,7 @@ private:
 
 	// Members
 	std::map<DataSpecifier, const NumRule*>* dataSpecifiers;
-	const std::vector<Event*>* actions;
+	const std::vector<Event>* actions;
 
 public:
 	// Members
@@ -38,13 +39,17 @@ public:
     // Constructors
     TargetingRule(
 		const sf::Vector2i& offsetVector_, const std::string& targetName_,
-		const std::map<std::string, const NumRule*>* dataSpecifiers_, const std::vector<Event*>* actions_
+		const std::map<std::string, const NumRule*>* dataSpecifiers_, const std::vector<Event>* actions_
 	);
     ~TargetingRule();
 
     // Methods
     bool matches (const Piece* rootPiece, const Piece* candidate) const;
-    const std::vector<Event*>* getEvents() const;
+    bool matches (
+		const unsigned int rootTeam, const PieceDef* candidateDef, const unsigned int candidateTeam,
+		const unsigned int candidateMoveCount, const int candidateLastMove
+	) const;
+    const std::vector<Event>* getEvents() const;
 };
 
 #endif // CHESS_TARGETING_RULE_H
@@ -1,12 +1,16 @@
 #include "controller.h"
 
+#include <set>
 #include "component_trackers/actionListenerTracker.h"
 #include "components/event.h"
 #include "component_trackers/eventProcessor.h"
+#include "component_trackers/moveTracker.h"
 #include "components/moveDef.h"
 #include "components/moveMarker.h"
 #include "components/piece.h"
 #include "components/targetingRule.h"
+#include "io/journal.h"
+#include "utils/trace.h"
 
 // Private event handlers
 
@@ -15,6 +19,7 @@ void Controller::onStartup(
 	unsigned int curTeam_
 ) {
 	clearTeams();
+	clearHistory();
 	eventProcessor.onStartup();
 	deselect();
 
@@ -42,14 +47,18 @@ void Controller::onStartup(
 	curTurn->next = head;
 	curTurn = teams.find(curTeam_)->second;
 
-	// Update all of the pieces in the piece tracker
+	// Count the pieces for each team and generate their move markers
 	const std::vector<Piece*>* pieces = pieceTracker->getPieces();
 	for (std::vector<Piece*>::const_iterator i = pieces->begin(); i != pieces->end(); ++i) {
-		eventProcessor.insertInQueue(EventProcessor::AFTER, new Event(*i, "enter", "initialization"));
 		teams.find((*i)->getTeam())->second->numPieces++;
 	}
 
-	eventProcessor.executeEvents();
+	eventProcessor.initializePieces(pieces);
+
+	// Start a new checkpoint for the loaded board
+	if (journal != nullptr) {
+		journal->onLoad(teamsToString(), curTurn->teamIndex, pieces);
+	}
 
 	// Clean up
 	delete pieces;
@@ -63,6 +72,13 @@ void Controller::onGeneration(MoveMarker* marker) {
 	actionListenerTracker.addListeners(marker);
 }
 
+/**
+ * Remove a move marker as a listener before it is deleted
+ */
+void Controller::onDeletion(MoveMarker* marker) {
+	actionListenerTracker.removeListeners(marker);
+}
+
 /**
  * Select/deselect a square
  */
@@ -92,7 +108,9 @@ void Controller::onMousePress(sf::Vector2i pos) {
 		}
 	}
 
-	game->renderer->needsRedraw = true;
+	if (game->renderer != nullptr) {
+		game->renderer->onBoardChange();
+	}
 }
 
 
@@ -108,30 +126,103 @@ void Controller::clearTeams() {
 	curTurn = nullptr;
 }
 
+/**
+ * Delete the moves that can be taken back and made again
+ */
+void Controller::clearHistory() {
+	for (std::deque<MoveRecord*>::iterator i = undoStack.begin(); i != undoStack.end(); ++i) {
+		delete *i;
+	}
+
+	for (std::vector<MoveRecord*>::iterator i = redoStack.begin(); i != redoStack.end(); ++i) {
+		delete *i;
+	}
+
+	undoStack.clear();
+	redoStack.clear();
+}
+
+/**
+ * Start recording a move, which replaces the moves that could be made again
+ */
+void Controller::beginRecord() {
+	for (std::vector<MoveRecord*>::iterator i = redoStack.begin(); i != redoStack.end(); ++i) {
+		delete *i;
+	}
+
+	redoStack.clear();
+
+	record = new MoveRecord(getTurnState(), (journal != nullptr) ? (journal->getPly()) : (MoveRecord::NO_PLY));
+	eventProcessor.setRecord(record);
+}
+
+/**
+ * Finish recording a move so that it can be taken back
+ */
+void Controller::endRecord() {
+	record->after = getTurnState();
+	eventProcessor.setRecord(nullptr);
+
+	undoStack.push_back(record);
+	record = nullptr;
+
+	// Forget the oldest move once there are too many
+	if (undoStack.size() > HISTORY_LIMIT) {
+		delete undoStack.front();
+		undoStack.pop_front();
+	}
+}
+
+MoveRecord::TurnState Controller::getTurnState() const {
+	return MoveRecord::TurnState{ curTurn->teamIndex, curTurn->moved, selectedPiece };
+}
+
+void Controller::setTurnState(const MoveRecord::TurnState& state) {
+	curTurn->moved = false;
+	curTurn = teams.find(state.team)->second;
+	curTurn->moved = state.moved;
+
+	// Only a turn in progress keeps its piece selected
+	selectedPiece = (state.moved) ? (state.selectedPiece) : (nullptr);
+}
+
 void Controller::deselect() {
+	const bool endsTurn = (curTurn != nullptr && curTurn->moved);
+
+	// A turn that is not ended by a move is recorded on its own
+	const bool recordsTurn = (endsTurn && record == nullptr);
+	if (recordsTurn) {
+		beginRecord();
+	}
+
 	selectedPiece = nullptr;
 
 	// Progress to the next turn
-	if (curTurn != nullptr && curTurn->moved) {
+	if (endsTurn) {
 		advanceTurn();
+		recordPly();
+	}
+
+	if (recordsTurn) {
+		endRecord();
 	}
 }
 
 void Controller::move(const MoveMarker* dest) {
+	Trace::Span span("move");
 	sf::Vector2i pos = dest->getPos();
+	beginRecord();
 
 	// Set up events for moving the piece
-	eventProcessor.insertInQueue(EventProcessor::START, new Event(selectedPiece, "leave", ""));
-	eventProcessor.insertInQueue(EventProcessor::EVENT, new Event(
-		selectedPiece, "move", std::to_string(dest->getRootMove()->index) + "," + VectorUtils::toString(pos) + ","
-	));
-	eventProcessor.insertInQueue(EventProcessor::AFTER, new Event(selectedPiece, "enter", ""));
+	eventProcessor.addEvent(Event(selectedPiece, Event::LEAVE));
+	eventProcessor.addEvent(Event(selectedPiece, Event::MOVE, dest->getRootMove()->index, pos));
+	eventProcessor.addEvent(Event(selectedPiece, Event::ENTER));
 
 	// Remove the piece that is at the destination position
 	Piece* destPiece = pieceTracker->getPiece(pos);
 	if (destPiece != nullptr) {
-		eventProcessor.insertInQueue(EventProcessor::START, new Event(destPiece, "leave", ""));
-		eventProcessor.insertInQueue(EventProcessor::EVENT, new Event(destPiece, "destroy", ""));
+		eventProcessor.addEvent(Event(destPiece, Event::LEAVE));
+		eventProcessor.addEvent(Event(destPiece, Event::DESTROY));
 	}
 
 	// Get the targets for moving to the position
@@ -146,26 +237,23 @@ void Controller::move(const MoveMarker* dest) {
         if (!marker->canMove(curTeamHasMoved())) continue;
 
 		Piece* targetPiece = std::get<1>(*i);
-		const std::vector<Event*>* targetEvents = std::get<2>(*i)->getEvents();
+		const std::vector<Event>* targetEvents = std::get<2>(*i)->getEvents();
 
 		// Check whether there is a target piece
 		if (targetPiece == nullptr || targetPiece == destPiece) continue;
 
 		// Handle the different actions
-		for (std::vector<Event*>::const_iterator j = targetEvents->begin(); j != targetEvents->end(); ++j) {
-			if ("move" == (*j)->action) {
-				eventProcessor.insertInQueue(EventProcessor::START, new Event(targetPiece, "leave", ""));
-				sf::Vector2i targetVector = VectorUtils::fromString((*j)->args);
-				targetVector = MoveDef::rotate(targetVector, dest->getRootPiece()->getDir());
+		for (std::vector<Event>::const_iterator j = targetEvents->begin(); j != targetEvents->end(); ++j) {
+			if (j->action == Event::MOVE) {
+				eventProcessor.addEvent(Event(targetPiece, Event::LEAVE));
+				sf::Vector2i targetVector = MoveDef::rotate(j->dest, dest->getRootPiece()->getDir());
 				targetVector = VectorUtils::reflect(targetVector, dest->switchedX, dest->switchedY, dest->switchedXY);
-				eventProcessor.insertInQueue(EventProcessor::START, new Event(
-					targetPiece, "move", "-1," + VectorUtils::toString(targetVector + targetPiece->getPos()) + ","
-				));
-				eventProcessor.insertInQueue(EventProcessor::START, new Event(targetPiece, "enter", ""));
-
-			} else if ("destroy" == (*j)->action && targetPiece != nullptr) {
-				eventProcessor.insertInQueue(EventProcessor::START, new Event(targetPiece, "leave", ""));
-				eventProcessor.insertInQueue(EventProcessor::START, new Event(targetPiece, "destroy", ""));
+				eventProcessor.addEvent(Event(targetPiece, Event::MOVE, -1, targetVector + targetPiece->getPos()));
+				eventProcessor.addEvent(Event(targetPiece, Event::ENTER));
+
+			} else if (j->action == Event::DESTROY && targetPiece != nullptr) {
+				eventProcessor.addEvent(Event(targetPiece, Event::LEAVE));
+				eventProcessor.addEvent(Event(targetPiece, Event::DESTROY));
 			}
 		}
 	}
@@ -173,14 +261,18 @@ void Controller::move(const MoveMarker* dest) {
 	bool endsTurn = dest->getRootMove()->endsTurn;
 	curTurn->moved = true;
 
-	// Execute all the queued events
+	// Execute all the events, in the order of the positions that they change
 	eventProcessor.executeEvents();
 
 	if (endsTurn) {
 		// Deselect the piece
 		deselect();
+	} else {
+		recordPly();
 	}
 
+	endRecord();
+
 	// Clean up
 	delete targets;
 	targets = nullptr;
@@ -197,6 +289,19 @@ void Controller::advanceTurn() {
 	} while (curTurn->numPieces == 0);
 }
 
+/**
+ * Record the end of a ply in the journal, with a checkpoint if one is due
+ */
+void Controller::recordPly() {
+	if (journal == nullptr) return;
+
+	if (journal->onPly(curTurn->teamIndex, curTurn->moved)) {
+		const std::vector<Piece*>* pieces = pieceTracker->getPieces();
+		journal->checkpoint(teamsToString(), curTurn->teamIndex, pieces);
+		delete pieces;
+	}
+}
+
 // Public constructors
 
 /**
@@ -206,8 +311,10 @@ Controller::Controller(Game* g, PieceTracker* p) :
 	game{g},
 	pieceTracker{p},
 	eventProcessor{p, actionListenerTracker, this},
+	journal{nullptr},
 	curTurn{nullptr},
-	selectedPiece{nullptr}
+	selectedPiece{nullptr},
+	record{nullptr}
 {
 }
 
@@ -216,6 +323,7 @@ Controller::Controller(Game* g, PieceTracker* p) :
  */
 Controller::~Controller() {
 	clearTeams();
+	clearHistory();
 	curTurn = nullptr;
 
 	deselect();
@@ -238,3 +346,204 @@ Piece* Controller::getSelectedPiece() const {
 bool Controller::canMove(unsigned int team) const {
 	return curTurn->teamIndex == team;
 }
+
+/**
+ * Get all the moves that can be made this turn, as pairs of start and destination positions
+ */
+std::vector<std::pair<sf::Vector2i, sf::Vector2i>>* Controller::getValidMoves() const {
+	std::vector<std::pair<sf::Vector2i, sf::Vector2i>>* validMoves = new std::vector<std::pair<sf::Vector2i, sf::Vector2i>>();
+
+	// Only the selected piece can continue a turn
+	std::vector<Piece*>* pieces = new std::vector<Piece*>();
+	if (curTeamHasMoved()) {
+		if (selectedPiece != nullptr) {
+			pieces->push_back(selectedPiece);
+		}
+	} else {
+		const std::vector<Piece*>* allPieces = pieceTracker->getPieces();
+		for (std::vector<Piece*>::const_iterator i = allPieces->begin(); i != allPieces->end(); ++i) {
+			if ((*i)->getTeam() == curTurn->teamIndex) {
+				pieces->push_back(*i);
+			}
+		}
+
+		delete allPieces;
+	}
+
+	for (std::vector<Piece*>::const_iterator i = pieces->begin(); i != pieces->end(); ++i) {
+		const std::vector<MoveMarker*>* markers = (*i)->getMoveTracker()->getMoveMarkers();
+		std::set<sf::Vector2i, VectorUtils::cmpVectorLexicographically> destinations;
+
+		for (std::vector<MoveMarker*>::const_iterator j = markers->begin(); j != markers->end(); ++j) {
+			if ((*j)->canMove(curTeamHasMoved()) && destinations.insert((*j)->getPos()).second) {
+				validMoves->push_back(std::make_pair((*i)->getPos(), (*j)->getPos()));
+			}
+		}
+
+		// Clean up
+		delete markers;
+	}
+
+	// Clean up
+	delete pieces;
+	return validMoves;
+}
+
+
+
+// Public methods
+
+/**
+ * Move a piece in the same way as selecting it and then its destination
+ *
+ * @return true if the move was made
+ */
+bool Controller::tryMove(sf::Vector2i from, sf::Vector2i to) {
+	// A turn in progress can only be continued by the selected piece
+	if (curTeamHasMoved()) {
+		if (selectedPiece == nullptr || selectedPiece->getPos() != from) {
+			return false;
+		}
+	} else {
+		selectedPiece = pieceTracker->getPiece(from);
+		if (selectedPiece == nullptr || selectedPiece->getTeam() != curTurn->teamIndex) {
+			deselect();
+			return false;
+		}
+	}
+
+	const MoveMarker* dest = selectedPiece->getValidMove(to, curTeamHasMoved());
+	if (dest == nullptr) {
+		if (!curTeamHasMoved()) {
+			deselect();
+		}
+
+		return false;
+	}
+
+	move(dest);
+	return true;
+}
+
+/**
+ * Select a piece in the same way as clicking on it, unless a turn is in progress
+ *
+ * @return true if a piece of the team whose turn it is was selected
+ */
+bool Controller::select(sf::Vector2i pos) {
+	if (curTeamHasMoved()) {
+		return false;
+	}
+
+	selectedPiece = pieceTracker->getPiece(pos);
+	if (selectedPiece != nullptr && selectedPiece->getTeam() != curTurn->teamIndex) {
+		deselect();
+	}
+
+	if (game->renderer != nullptr) {
+		game->renderer->onBoardChange();
+	}
+
+	return selectedPiece != nullptr;
+}
+
+/**
+ * End a turn that has been started with a move that does not end it
+ *
+ * @return true if there was a turn to end
+ */
+bool Controller::endTurn() {
+	if (!curTeamHasMoved()) {
+		return false;
+	}
+
+	deselect();
+	return true;
+}
+
+/**
+ * Take back the last move or ended turn
+ *
+ * @return true if there was a move to take back
+ */
+bool Controller::undo() {
+	if (undoStack.empty()) {
+		return false;
+	}
+
+	MoveRecord* undone = undoStack.back();
+	undoStack.pop_back();
+
+	eventProcessor.undo(undone);
+	setTurnState(undone->before);
+	redoStack.push_back(undone);
+
+	// The journal goes back to the board before the move, unless the move was made before it started
+	if (journal != nullptr) {
+		if (undone->ply != MoveRecord::NO_PLY) {
+			journal->onUndo(undone->ply);
+		} else {
+			const std::vector<Piece*>* pieces = pieceTracker->getPieces();
+			journal->onLoad(teamsToString(), curTurn->teamIndex, pieces);
+			delete pieces;
+		}
+	}
+
+	if (game->renderer != nullptr) {
+		game->renderer->onBoardChange();
+	}
+
+	return true;
+}
+
+/**
+ * Make the last move that was taken back again
+ *
+ * @return true if there was a move to make again
+ */
+bool Controller::redo() {
+	if (redoStack.empty()) {
+		return false;
+	}
+
+	MoveRecord* redone = redoStack.back();
+	redoStack.pop_back();
+
+	// Execute the same events, recording them again so that the move can be taken back
+	record = new MoveRecord(getTurnState(), (journal != nullptr) ? (journal->getPly()) : (MoveRecord::NO_PLY));
+	eventProcessor.setRecord(record);
+
+	for (std::vector<Event>::const_iterator i = redone->events.begin(); i != redone->events.end(); ++i) {
+		eventProcessor.addEvent(*i);
+	}
+
+	eventProcessor.executeEvents();
+	setTurnState(redone->after);
+	recordPly();
+	endRecord();
+
+	if (game->renderer != nullptr) {
+		game->renderer->onBoardChange();
+	}
+
+	// Clean up
+	delete redone;
+	return true;
+}
+
+
+
+// Mutators
+
+/**
+ * Record the moves in a journal, or stop recording them if the journal is null
+ */
+void Controller::setJournal(Journal* journal_) {
+	journal = journal_;
+	eventProcessor.setJournal(journal_);
+
+	// The moves made so far are not in the journal
+	for (std::deque<MoveRecord*>::iterator i = undoStack.begin(); i != undoStack.end(); ++i) {
+		(*i)->ply = MoveRecord::NO_PLY;
+	}
+}
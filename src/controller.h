@@ -2,15 +2,19 @@
 #define CHESS_CONTROLLER_H
 
 #include <SFML/Graphics.hpp>
+#include <deque>
 #include "component_trackers/actionListenerTracker.h"
 #include "component_trackers/eventProcessor.h"
+#include "components/moveRecord.h"
 #include "game.h"
 
 // Forward declarations
 class ActionListenerTracker;
 class Game;
 class InputHandler;
+class Journal;
 class MoveMarker;
+class MoveRecord;
 class PieceTracker;
 class Piece;
 
@@ -28,17 +32,31 @@ struct TeamNode {
 
 // Class declaration
 class Controller {
+public:
+	// Constants
+
+	/**
+	 * The number of moves that can be taken back
+	 */
+	static const unsigned int HISTORY_LIMIT = 1024;
+
 private:
 	// Members
 	Game* game;
 	PieceTracker* pieceTracker;
 	ActionListenerTracker actionListenerTracker;
 	EventProcessor eventProcessor;
+	Journal* journal;
 
 	std::map<unsigned int, TeamNode*> teams;
 	TeamNode* curTurn;
 	Piece* selectedPiece;
 
+	// The moves that can be taken back and made again, and the move being recorded
+	std::deque<MoveRecord*> undoStack;
+	std::vector<MoveRecord*> redoStack;
+	MoveRecord* record;
+
 	// Event handlers
 	void onMousePress (sf::Vector2i pos);
 
@@ -47,9 +65,15 @@ private:
 
 	// Helpers
 	void clearTeams();
+	void clearHistory();
+	void beginRecord();
+	void endRecord();
+	MoveRecord::TurnState getTurnState() const;
+	void setTurnState(const MoveRecord::TurnState& state);
 	void deselect();
 	void move(const MoveMarker* dest);
 	void advanceTurn();
+	void recordPly();
 	inline std::string colorToString(sf::Color color) const {
 		return "[" +
 			std::to_string(color.r) + "," +
@@ -77,6 +101,7 @@ public:
 		unsigned int curTeam
 	);
 	void onGeneration(MoveMarker* marker);
+	void onDeletion(MoveMarker* marker);
 
 	// Accessors
 	Piece* getSelectedPiece() const;
@@ -91,10 +116,32 @@ public:
 
 		return output + "]";
 	}
+	inline std::map<const unsigned int, std::pair<const std::string, sf::Color>>* getTeams() const {
+		std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teamMap =
+			new std::map<const unsigned int, std::pair<const std::string, sf::Color>>();
+		TeamNode* curNode = curTurn;
+		do {
+			teamMap->insert(std::make_pair(curNode->teamIndex, std::make_pair(curNode->name, curNode->color)));
+			curNode = curNode->next;
+		} while (curNode != curTurn);
+
+		return teamMap;
+	}
 	inline unsigned int getCurTurn() const { return curTurn->teamIndex; }
 	inline bool curTeamHasMoved() const { return curTurn->moved; }
+	std::vector<std::pair<sf::Vector2i, sf::Vector2i>>* getValidMoves() const;
+	inline std::size_t getNumListeners() const { return actionListenerTracker.getNumListeners(); }
+
+	// Methods
+	bool tryMove(sf::Vector2i from, sf::Vector2i to);
+	bool select(sf::Vector2i pos);
+	bool endTurn();
+	bool undo();
+	bool redo();
 
 	// Mutators
+	void setJournal(Journal* journal_);
+	inline void setThreads(unsigned int numThreads) { eventProcessor.setThreads(numThreads); }
 	inline void addPiece(unsigned int teamIndex) {
 		std::map<unsigned int, TeamNode*>::iterator i = teams.find(teamIndex);
 		if (i != teams.end()) {
@@ -0,0 +1,76 @@
+#ifndef CHESS_BOARD_FILE_H
+#define CHESS_BOARD_FILE_H
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <tuple>
+#include "position.h"
+#include "../components/piece.h"
+#include "../io/resourceLoader.h"
+#include "../io/boardLoader.h"
+#include "../io/pieceDefLoader.h"
+
+// Class declaration
+
+/**
+ * A saved board and the piece definitions it uses, loaded without a game window
+ */
+class BoardFile {
+private:
+	// Members
+	std::map<std::string, const PieceDef*>* pieceDefs;
+	std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams;
+	unsigned int curTurn;
+	std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces;
+
+public:
+	// Constructors
+
+	/**
+	 * Constructor
+	 *
+	 * @throw ResourceLoader::FileFormatException if either file is invalid
+	 * @throw ResourceLoader::IOException if either file cannot be opened
+	 */
+	inline BoardFile(const std::string& fileName, const std::string& pieceDefsFileName) :
+		pieceDefs{PieceDefLoader::loadPieceDefs(pieceDefsFileName)}
+	{
+		std::tie(teams, curTurn, pieces) = BoardLoader::loadBoard(fileName, pieceDefs);
+	}
+
+	inline ~BoardFile() {
+		for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::iterator i = pieces->begin();
+			i != pieces->end(); ++i
+		) {
+			delete i->second;
+		}
+		delete pieces;
+		delete teams;
+
+		for (std::map<std::string, const PieceDef*>::iterator i = pieceDefs->begin(); i != pieceDefs->end(); ++i) {
+			delete i->second;
+		}
+		delete pieceDefs;
+	}
+
+	// Methods
+
+	/**
+	 * Create a searchable position from the board
+	 *
+	 * @param margin the number of tiles around the pieces that moves may extend into
+	 */
+	inline Position getPosition(unsigned int margin) const {
+		return Position(teams, curTurn, pieces, margin);
+	}
+
+	/**
+	 * Get the name of a team, or an empty string if there is no such team
+	 */
+	inline std::string getTeamName(unsigned int team) const {
+		std::map<const unsigned int, std::pair<const std::string, sf::Color>>::const_iterator found = teams->find(team);
+		return (found == teams->end()) ? ("") : (found->second.first);
+	}
+};
+
+#endif // CHESS_BOARD_FILE_H
@@ -0,0 +1,337 @@
+#include "engineProtocol.h"
+
+#include <cstdlib>
+#include <sstream>
+#include "position.h"
+#include "../controller.h"
+#include "../game.h"
+#include "../components/piece.h"
+#include "../component_trackers/pieceTracker.h"
+#include "../io/boardLoader.h"
+#include "../io/pieceDefLoader.h"
+#include "../io/resourceLoader.h"
+
+// Helpers
+
+/**
+ * Write a line of output, which may come from the search thread
+ */
+void EngineProtocol::write(const std::string& line) {
+	std::lock_guard<std::mutex> lock(outputMutex);
+	output << line << std::endl;
+}
+
+/**
+ * Stop any search in progress before the board changes
+ */
+void EngineProtocol::stopSearch() {
+	if (search != nullptr) {
+		search->stop();
+		delete search;
+		search = nullptr;
+	}
+}
+
+/**
+ * Write a move as "x,y:x,y" or "pass"
+ */
+std::string EngineProtocol::stepToString(const Search::Step& step) const {
+	if (step.isPass) {
+		return "pass";
+	}
+
+	return
+		std::to_string(step.from.x) + "," + std::to_string(step.from.y) + ":" +
+		std::to_string(step.to.x) + "," + std::to_string(step.to.y);
+}
+
+/**
+ * Read a move written as "x,y:x,y" or "pass"
+ *
+ * @return false if the move is not written correctly
+ */
+bool EngineProtocol::stringToStep(const std::string& s, Search::Step& step) const {
+	if (s == "pass") {
+		step.isPass = true;
+		return true;
+	}
+
+	int values[4];
+	const char* cur = s.c_str();
+	for (unsigned int i = 0; i < 4; i++) {
+		char* end;
+		values[i] = std::strtol(cur, &end, 10);
+		if (end == cur || *end != ((i == 3) ? ('\0') : ((i == 1) ? (':') : (',')))) {
+			return false;
+		}
+
+		cur = end + ((i == 3) ? (0) : (1));
+	}
+
+	step = Search::Step{ false, sf::Vector2i(values[0], values[1]), sf::Vector2i(values[2], values[3]) };
+	return true;
+}
+
+
+
+// Command handlers
+
+void EngineProtocol::onLoad(const std::string& fileName) {
+	try {
+		if (game->pieceDefs == nullptr) {
+			game->pieceDefs = PieceDefLoader::loadPieceDefs("res/pieces.def");
+		}
+
+		game->loadBoard(fileName);
+	} catch (const std::exception& ex) {
+		write(std::string("info string error ") + ex.what());
+	}
+}
+
+void EngineProtocol::onPosition(const std::string& boardString) {
+	try {
+		if (game->pieceDefs == nullptr) {
+			game->pieceDefs = PieceDefLoader::loadPieceDefs("res/pieces.def");
+		}
+
+		game->loadBoard(BoardLoader::loadBoardFromString(boardString, game->pieceDefs));
+	} catch (const std::exception& ex) {
+		write(std::string("info string error ") + ex.what());
+	}
+}
+
+void EngineProtocol::onBoard() {
+	if (game->teams == nullptr) {
+		write("info string error no board loaded");
+		return;
+	}
+
+	write(game->boardToString());
+}
+
+void EngineProtocol::onMoves() {
+	if (game->teams == nullptr) {
+		write("info string error no board loaded");
+		return;
+	}
+
+	std::string line = "moves";
+	std::vector<std::pair<sf::Vector2i, sf::Vector2i>>* validMoves = game->controller->getValidMoves();
+	for (std::vector<std::pair<sf::Vector2i, sf::Vector2i>>::const_iterator i = validMoves->begin();
+		i != validMoves->end(); ++i
+	) {
+		line += " " + stepToString(Search::Step{ false, i->first, i->second });
+	}
+
+	if (game->controller->curTeamHasMoved()) {
+		line += " pass";
+	}
+
+	write(line);
+
+	// Clean up
+	delete validMoves;
+}
+
+void EngineProtocol::onMove(std::istream& args) {
+	if (game->teams == nullptr) {
+		write("info string error no board loaded");
+		return;
+	}
+
+	std::vector<std::string> moveStrings;
+	std::string moveString;
+	while (args >> moveString) {
+		moveStrings.push_back(moveString);
+	}
+
+	// Every move that is made is taken back if a later one is illegal, so there must be room to take them all back
+	if (moveStrings.size() > Controller::HISTORY_LIMIT) {
+		write("info string error more than " + std::to_string(Controller::HISTORY_LIMIT) + " moves");
+		return;
+	}
+
+	for (unsigned int i = 0; i < moveStrings.size(); i++) {
+		Search::Step step;
+		const bool isValid = stringToStep(moveStrings[i], step) && (step.isPass ?
+			(game->controller->endTurn()) :
+			(game->controller->tryMove(step.from, step.to))
+		);
+
+		if (!isValid) {
+			// Each move or ended turn is recorded on its own, so taking back one record per move restores the board
+			for (unsigned int j = 0; j < i; j++) {
+				game->controller->undo();
+			}
+
+			write("info string error illegal move " + moveStrings[i]);
+			return;
+		}
+	}
+}
+
+void EngineProtocol::onUndo(std::istream& args, bool redo) {
+	if (game->teams == nullptr) {
+		write("info string error no board loaded");
+		return;
+	}
+
+	unsigned int count = 1;
+	args >> count;
+
+	for (unsigned int i = 0; i < count; i++) {
+		if (!(redo ? (game->controller->redo()) : (game->controller->undo()))) {
+			write(std::string("info string error nothing to ") + (redo ? ("redo") : ("undo")));
+			return;
+		}
+	}
+}
+
+void EngineProtocol::onGo(std::istream& args) {
+	if (game->teams == nullptr) {
+		write("info string error no board loaded");
+		return;
+	}
+
+	// Read the limits
+	Search::Limits limits{ 0, 0 };
+	std::string option;
+	while (args >> option) {
+		if (option == "depth") {
+			args >> limits.depth;
+		} else if (option == "movetime") {
+			args >> limits.moveTime;
+		}
+	}
+
+	// Copy the board for searching
+	std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically> pieces;
+	const std::vector<Piece*>* pieceList = game->pieceTracker->getPieces();
+	for (std::vector<Piece*>::const_iterator i = pieceList->begin(); i != pieceList->end(); ++i) {
+		pieces.insert(std::make_pair((*i)->getPos(), *i));
+	}
+	delete pieceList;
+
+	Position position(game->teams, game->controller->getCurTurn(), &pieces, game->generationMargin);
+	if (game->controller->curTeamHasMoved() && game->controller->getSelectedPiece() != nullptr) {
+		position.continueTurn(game->controller->getSelectedPiece()->getPos());
+	}
+
+	// Search in the background
+	search = new Search(position);
+	search->start(
+		limits,
+		[this](const Search::Info& info){
+			std::string score;
+			if (info.score >= Search::MATE_SCORE - (int) Search::MAX_DEPTH) {
+				score = "mate " + std::to_string(Search::MATE_SCORE - info.score);
+			} else if (info.score <= -Search::MATE_SCORE + (int) Search::MAX_DEPTH) {
+				score = "mate -" + std::to_string(Search::MATE_SCORE + info.score);
+			} else {
+				score = "cp " + std::to_string(info.score);
+			}
+
+			std::string line =
+				"info depth " + std::to_string(info.depth) +
+				" score " + score +
+				" nodes " + std::to_string(info.nodes) +
+				" nps " + std::to_string((info.time == 0) ? (info.nodes * 1000) : (info.nodes * 1000 / info.time)) +
+				" time " + std::to_string(info.time) +
+				" pv";
+			for (std::vector<Search::Step>::const_iterator i = info.pv.begin(); i != info.pv.end(); ++i) {
+				line += " " + stepToString(*i);
+			}
+
+			write(line);
+		},
+		[this](bool found, const Search::Step& step){
+			write("bestmove " + (found ? (stepToString(step)) : ("none")));
+		}
+	);
+}
+
+
+
+// Constructors
+
+/**
+ * Constructor
+ *
+ * @param game_ a game created without a window
+ */
+EngineProtocol::EngineProtocol(Game* game_, std::ostream& output_) :
+	game{game_},
+	output(output_),
+	search{nullptr}
+{
+}
+
+EngineProtocol::~EngineProtocol() {
+	stopSearch();
+}
+
+
+
+// Methods
+
+/**
+ * Handle a single line of input
+ *
+ * @return false if the protocol should exit
+ */
+bool EngineProtocol::handleCommand(const std::string& line) {
+	std::istringstream args(line);
+	std::string command;
+	if (!(args >> command)) {
+		return true;
+	}
+
+	// Commands that do not change the board
+	if (command == "isready") {
+		write("readyok");
+	} else if (command == "board") {
+		onBoard();
+	} else if (command == "moves") {
+		onMoves();
+	} else if (command == "stop") {
+		stopSearch();
+	} else if (command == "quit") {
+		stopSearch();
+		return false;
+
+	// Commands that change the board stop any search in progress
+	} else if (command == "load") {
+		std::string fileName;
+		args >> fileName;
+		stopSearch();
+		onLoad(fileName);
+	} else if (command == "position") {
+		std::string boardString;
+		std::getline(args, boardString);
+		stopSearch();
+		onPosition(boardString);
+	} else if (command == "move") {
+		stopSearch();
+		onMove(args);
+	} else if (command == "undo" || command == "redo") {
+		stopSearch();
+		onUndo(args, command == "redo");
+	} else if (command == "go") {
+		stopSearch();
+		onGo(args);
+	} else {
+		write("info string error unknown command " + command);
+	}
+
+	return true;
+}
+
+/**
+ * Handle commands until the input ends or a quit command is received
+ */
+void EngineProtocol::run(std::istream& input) {
+	std::string line;
+	while (std::getline(input, line) && handleCommand(line)) {}
+
+	stopSearch();
+}
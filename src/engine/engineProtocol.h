@@ -0,0 +1,69 @@
+#ifndef CHESS_ENGINE_PROTOCOL_H
+#define CHESS_ENGINE_PROTOCOL_H
+
+#include <SFML/Graphics.hpp>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include "search.h"
+
+// Forward declarations
+class Game;
+
+
+
+// Class declaration
+
+/**
+ * A line-based text protocol for driving a game without a window, in the spirit of UCI.
+ *
+ * Moves are written as "x,y:x,y" from the piece's position to its destination, or "pass" to end a turn
+ * after a move that does not end it.
+ *
+ * Commands:
+ *   isready                                  replies with "readyok"
+ *   load <file.chess>                        loads a save file
+ *   position <board>                         loads a board written inline in the save file format
+ *   board                                    prints the board in the save file format
+ *   moves                                    lists the moves that can be made this turn
+ *   move <move> [<move> ...]                 makes moves
+ *   undo [<n>]                               takes back the last n moves or passes, 1 by default
+ *   redo [<n>]                               makes the last n moves that were taken back again
+ *   go [depth <n>] [movetime <ms>] [infinite] starts searching, with "info" lines and a final "bestmove"
+ *   stop                                     stops searching
+ *   quit                                     exits
+ */
+class EngineProtocol {
+private:
+	// Members
+	Game* game;
+	std::ostream& output;
+	std::mutex outputMutex;
+	Search* search;
+
+	// Helpers
+	void write(const std::string& line);
+	void stopSearch();
+	std::string stepToString(const Search::Step& step) const;
+	bool stringToStep(const std::string& s, Search::Step& step) const;
+
+	// Command handlers
+	void onLoad(const std::string& fileName);
+	void onPosition(const std::string& boardString);
+	void onBoard();
+	void onMoves();
+	void onMove(std::istream& args);
+	void onUndo(std::istream& args, bool redo);
+	void onGo(std::istream& args);
+
+public:
+	// Constructors
+	EngineProtocol(Game* game_, std::ostream& output_);
+	~EngineProtocol();
+
+	// Methods
+	bool handleCommand(const std::string& line);
+	void run(std::istream& input);
+};
+
+#endif // CHESS_ENGINE_PROTOCOL_H
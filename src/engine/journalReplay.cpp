@@ -0,0 +1,318 @@
+#include "journalReplay.h"
+
+#include <fstream>
+#include <iterator>
+#include <tuple>
+#include "../components/event.h"
+#include "../components/piece.h"
+#include "../io/boardLoader.h"
+#include "../io/journal.h"
+#include "../io/resourceLoader.h"
+
+// Constants
+const unsigned int JournalReplay::NO_PARENT;
+
+
+
+// Helpers
+
+/**
+ * Get the size of the record at an offset, or 0 if the record was cut off
+ *
+ * @throw ResourceLoader::FileFormatException if the record has an unknown tag
+ */
+std::size_t JournalReplay::getRecordSize(std::size_t recordOffset) const {
+	const std::size_t remaining = data.size() - recordOffset;
+	std::size_t size;
+
+	switch (data[recordOffset]) {
+	case Journal::CHECKPOINT:
+		if (remaining < Journal::CHECKPOINT_HEADER_SIZE) return 0;
+		size = Journal::CHECKPOINT_HEADER_SIZE + Journal::readUint32(&data[recordOffset + 5]) +
+			4 * static_cast<std::size_t>(Journal::readUint32(&data[recordOffset + 9]));
+		break;
+	case Journal::EVENT:
+		size = 18;
+		break;
+	case Journal::PLY:
+		size = 10;
+		break;
+	case Journal::UNDO:
+		size = 9;
+		break;
+	default:
+		throw ResourceLoader::FileFormatException("Invalid journal record at " + std::to_string(recordOffset));
+	}
+
+	return (size <= remaining) ? (size) : (0);
+}
+
+/**
+ * Add the next ply to the index
+ *
+ * @throw ResourceLoader::FileFormatException if the ply is out of order
+ */
+void JournalReplay::addPly(unsigned int newPly, unsigned int parent, std::size_t begin, std::size_t end) {
+	if (newPly != plies.size() || (parent != NO_PARENT && parent >= newPly)) {
+		throw ResourceLoader::FileFormatException("Invalid journal ply " + std::to_string(newPly));
+	}
+
+	plies.push_back(Ply{ parent, begin, end, 0 });
+}
+
+/**
+ * Delete the reconstructed board
+ */
+void JournalReplay::clearBoard() {
+	for (std::vector<Piece*>::iterator i = pieces.begin(); i != pieces.end(); ++i) {
+		delete *i;
+	}
+
+	pieces.clear();
+	onBoard.clear();
+
+	delete teams;
+	teams = nullptr;
+}
+
+/**
+ * Replace the reconstructed board with a checkpoint
+ *
+ * @throw ResourceLoader::FileFormatException if the ids do not match the pieces on the board
+ */
+void JournalReplay::loadCheckpoint(std::size_t recordOffset) {
+	clearBoard();
+
+	const std::size_t length = Journal::readUint32(&data[recordOffset + 5]);
+	const std::size_t count = Journal::readUint32(&data[recordOffset + 9]);
+	const std::size_t boardOffset = recordOffset + Journal::CHECKPOINT_HEADER_SIZE;
+	const std::string board(data.begin() + boardOffset, data.begin() + boardOffset + length);
+
+	std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* boardPieces;
+	std::tie(teams, curTurn, boardPieces) = BoardLoader::loadBoardFromString(board, pieceDefs);
+	if (boardPieces->size() != count) {
+		throw ResourceLoader::FileFormatException("Invalid checkpoint at " + std::to_string(recordOffset));
+	}
+
+	// Give the pieces their ids, in the order that the board lists them
+	const char* id = &data[boardOffset + length];
+	for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::const_iterator i =
+		boardPieces->begin(); i != boardPieces->end(); ++i, id += 4
+	) {
+		const std::uint32_t index = Journal::readUint32(id);
+		if (index >= pieces.size()) {
+			pieces.resize(index + 1, nullptr);
+			onBoard.resize(index + 1, false);
+		}
+
+		if (pieces[index] != nullptr) {
+			throw ResourceLoader::FileFormatException("Invalid checkpoint at " + std::to_string(recordOffset));
+		}
+
+		pieces[index] = i->second;
+		onBoard[index] = true;
+	}
+
+	delete boardPieces;
+
+	ply = Journal::readUint32(&data[recordOffset + 1]);
+}
+
+/**
+ * Apply a record of a ply to the reconstructed board
+ */
+void JournalReplay::applyRecord(std::size_t recordOffset) {
+	const char* record = &data[recordOffset];
+
+	switch (record[0]) {
+	case Journal::EVENT: {
+		const std::uint32_t id = Journal::readUint32(record + 1);
+		if (id >= pieces.size() || pieces[id] == nullptr) break;
+
+		switch (static_cast<Event::Action>(record[5])) {
+		case Event::ENTER:
+			onBoard[id] = true;
+			break;
+		case Event::LEAVE:
+			onBoard[id] = false;
+			break;
+		case Event::MOVE:
+			pieces[id]->setPos(sf::Vector2i(
+				static_cast<std::int32_t>(Journal::readUint32(record + 10)),
+				static_cast<std::int32_t>(Journal::readUint32(record + 14))
+			));
+			pieces[id]->setLastMove(static_cast<std::int32_t>(Journal::readUint32(record + 6)));
+			break;
+		case Event::DESTROY:
+			delete pieces[id];
+			pieces[id] = nullptr;
+			onBoard[id] = false;
+			break;
+		default:
+			break;
+		}
+		break;
+	}
+
+	case Journal::PLY:
+		curTurn = Journal::readUint32(record + 5);
+		break;
+	}
+}
+
+
+
+// Constructors
+
+JournalReplay::JournalReplay(const std::string& fileName, std::map<std::string, const PieceDef*>* pieceDefs_) :
+	pieceDefs{pieceDefs_},
+	numCheckpoints{0},
+	teams{nullptr},
+	curTurn{0},
+	ply{0}
+{
+	std::ifstream file(fileName, std::ios::in | std::ios::binary);
+	if (!file.is_open()) {
+		throw ResourceLoader::IOException("Unable to open file: " + fileName);
+	}
+
+	data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	if (data.size() < Journal::MAGIC.size() || std::string(data.begin(), data.begin() + 4) != Journal::MAGIC) {
+		throw ResourceLoader::FileFormatException("Invalid journal header");
+	}
+
+	// Index the plies, dropping a record that was cut off by a crash
+	std::size_t recordOffset = Journal::MAGIC.size();
+	std::size_t begin = recordOffset;
+	while (recordOffset < data.size()) {
+		const std::size_t size = getRecordSize(recordOffset);
+		if (size == 0) {
+			data.resize(recordOffset);
+			break;
+		}
+
+		if (plies.empty() && data[recordOffset] != Journal::CHECKPOINT) {
+			throw ResourceLoader::FileFormatException("Journal does not start with a checkpoint");
+		}
+
+		const std::size_t end = recordOffset + size;
+		switch (data[recordOffset]) {
+		case Journal::CHECKPOINT: {
+			// A checkpoint either follows the ply that it records, or is a board that was loaded as a new ply
+			const unsigned int checkpointPly = Journal::readUint32(&data[recordOffset + 1]);
+			if (plies.empty() || checkpointPly != plies.size() - 1) {
+				addPly(checkpointPly, NO_PARENT, end, end);
+			}
+
+			plies.back().checkpoint = recordOffset;
+			numCheckpoints++;
+			begin = end;
+			break;
+		}
+
+		case Journal::PLY:
+			addPly(Journal::readUint32(&data[recordOffset + 1]), plies.size() - 1, begin, end);
+			begin = end;
+			break;
+
+		case Journal::UNDO:
+			addPly(
+				Journal::readUint32(&data[recordOffset + 1]), Journal::readUint32(&data[recordOffset + 5]), end, end
+			);
+			begin = end;
+			break;
+		}
+
+		recordOffset = end;
+	}
+
+	if (plies.empty()) {
+		throw ResourceLoader::FileFormatException("Journal does not start with a checkpoint");
+	}
+}
+
+JournalReplay::~JournalReplay() {
+	clearBoard();
+}
+
+
+
+// Accessors
+
+/**
+ * Get the reconstructed board in the save file format
+ */
+std::string JournalReplay::boardToString() const {
+	if (teams == nullptr) return "";
+
+	// List the teams starting from the team to move, in the same way as the controller
+	std::string teamsString = "[";
+	std::map<const unsigned int, std::pair<const std::string, sf::Color>>::const_iterator team = teams->find(curTurn);
+	for (unsigned int i = 0; i < teams->size(); i++, ++team) {
+		if (team == teams->end()) {
+			team = teams->begin();
+		}
+
+		const sf::Color color = team->second.second;
+		teamsString += "[" + std::to_string(team->first) + "," + team->second.first + ",[" +
+			std::to_string(color.r) + "," + std::to_string(color.g) + "," +
+			std::to_string(color.b) + "," + std::to_string(color.a) + ",],],\n";
+	}
+
+	// List the pieces in the same order as the piece tracker
+	std::map<sf::Vector2i, const Piece*, VectorUtils::cmpVectorLexicographically> boardPieces;
+	for (unsigned int i = 0; i < pieces.size(); i++) {
+		if (onBoard[i]) {
+			boardPieces.insert(std::make_pair(pieces[i]->getPos(), pieces[i]));
+		}
+	}
+
+	std::string piecesString = "[\n";
+	for (std::map<sf::Vector2i, const Piece*, VectorUtils::cmpVectorLexicographically>::const_iterator i =
+		boardPieces.begin(); i != boardPieces.end(); ++i
+	) {
+		piecesString += i->second->toString() + ",\n";
+	}
+
+	return "[" + teamsString + "]," + std::to_string(curTurn) + "," + piecesString + "],\n]";
+}
+
+
+
+// Methods
+
+/**
+ * Reconstruct the board at a ply, starting from the nearest checkpoint before it, or from the board that was
+ * loaded before it if checkpoints should not be used
+ *
+ * @return false if the journal does not reach the ply
+ */
+bool JournalReplay::seek(unsigned int targetPly, bool useCheckpoints) {
+	if (targetPly >= plies.size()) return false;
+
+	// Follow the plies back to the reconstructed board or a checkpoint
+	std::vector<unsigned int> path;
+	unsigned int start = targetPly;
+	while (teams == nullptr || start != ply) {
+		if (plies[start].parent == NO_PARENT || (useCheckpoints && plies[start].checkpoint != 0)) {
+			loadCheckpoint(plies[start].checkpoint);
+			break;
+		}
+
+		path.push_back(start);
+		start = plies[start].parent;
+	}
+
+	// Apply the records of each ply on the way forward
+	for (std::vector<unsigned int>::const_reverse_iterator i = path.rbegin(); i != path.rend(); ++i) {
+		for (std::size_t recordOffset = plies[*i].begin; recordOffset < plies[*i].end;
+			recordOffset += getRecordSize(recordOffset)
+		) {
+			applyRecord(recordOffset);
+		}
+
+		ply = *i;
+	}
+
+	return true;
+}
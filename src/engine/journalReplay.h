@@ -0,0 +1,101 @@
+#ifndef CHESS_JOURNAL_REPLAY_H
+#define CHESS_JOURNAL_REPLAY_H
+
+#include <SFML/Graphics.hpp>
+#include <climits>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class Piece;
+class PieceDef;
+
+
+
+// Class declaration
+
+/**
+ * Reconstructs the boards recorded in a journal without the move marker machinery, by loading the nearest
+ * checkpoint and applying the recorded events to the pieces directly.
+ *
+ * Each ply is applied to the board of the ply before it, apart from a move that was taken back, which has the board
+ * of an earlier ply. A board is reconstructed by following these plies back to a checkpoint and applying the
+ * records of each ply on the way forward, so that the plies that were taken back are skipped.
+ */
+class JournalReplay {
+private:
+	// Helper structs
+
+	/**
+	 * The records of a ply, and the ply whose board they are applied to
+	 */
+	struct Ply {
+		unsigned int parent;
+		std::size_t begin;
+		std::size_t end;
+		std::size_t checkpoint;
+	};
+
+	// Constants
+
+	/**
+	 * The parent of a board that was loaded
+	 */
+	static const unsigned int NO_PARENT = UINT_MAX;
+
+	// Members
+	std::map<std::string, const PieceDef*>* pieceDefs;
+	std::vector<char> data;
+	std::vector<Ply> plies;
+	unsigned int numCheckpoints;
+
+	// The reconstructed board
+	std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams;
+	unsigned int curTurn;
+	std::vector<Piece*> pieces;
+	std::vector<bool> onBoard;
+	unsigned int ply;
+
+	// Helpers
+	std::size_t getRecordSize(std::size_t recordOffset) const;
+	void addPly(unsigned int newPly, unsigned int parent, std::size_t begin, std::size_t end);
+	void clearBoard();
+	void loadCheckpoint(std::size_t recordOffset);
+	void applyRecord(std::size_t recordOffset);
+
+public:
+	// Constructors
+
+	/**
+	 * Constructor
+	 *
+	 * @throw ResourceLoader::IOException if the journal cannot be opened
+	 * @throw ResourceLoader::FileFormatException if the journal is not valid
+	 */
+	JournalReplay(const std::string& fileName, std::map<std::string, const PieceDef*>* pieceDefs_);
+	~JournalReplay();
+
+	// Accessors
+	inline unsigned int getLastPly() const { return plies.size() - 1; }
+	inline unsigned int getNumCheckpoints() const { return numCheckpoints; }
+	inline unsigned int getPly() const { return ply; }
+
+	/**
+	 * Get the reconstructed board in the save file format
+	 */
+	std::string boardToString() const;
+
+	// Methods
+
+	/**
+	 * Reconstruct the board at a ply, starting from the nearest checkpoint before it, or from the board that was
+	 * loaded before it if checkpoints should not be used
+	 *
+	 * @return false if the journal does not reach the ply
+	 */
+	bool seek(unsigned int targetPly, bool useCheckpoints = true);
+};
+
+#endif // CHESS_JOURNAL_REPLAY_H
@@ -0,0 +1,288 @@
+#include "mateSearch.h"
+
+#include <climits>
+#include <thread>
+
+// Helpers
+
+/**
+ * Make a move, unless it ends the mover's turn with the mover in check
+ *
+ * @param endedTurn set to whether the move ended the mover's turn
+ *
+ * @return true if the move was made
+ */
+bool MateSearch::makeLegalMove(
+	Position& position, const Position::Move& move, Position::Undo& undo, bool& endedTurn
+) const {
+	const unsigned int mover = position.getCurTurn();
+	position.makeMove(move, undo);
+	endedTurn = !position.hasPendingMove();
+
+	if (endedTurn && position.isInCheck(mover)) {
+		position.unmakeMove(undo);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Get the number of the attacker's turns left after a move
+ */
+unsigned int MateSearch::getChildMovesLeft(unsigned int mover, bool endedTurn, unsigned int movesLeft) const {
+	return (endedTurn && mover == attacker) ? (movesLeft - 1) : (movesLeft);
+}
+
+/**
+ * Determine whether the defender to move has already been beaten
+ */
+bool MateSearch::isBeaten(Position& position, unsigned long long& nodes) const {
+	const unsigned int defender = position.getCurTurn();
+	if (defender == attacker) {
+		return false;
+	}
+
+	if (!position.hasPendingMove() && position.hasLost(defender)) {
+		return true;
+	}
+
+	// Check whether the defender has any legal moves
+	std::vector<Position::Move> moves;
+	position.generateMoves(moves);
+
+	Position::Undo undo;
+	bool endedTurn;
+	for (std::vector<Position::Move>::const_iterator i = moves.begin(); i != moves.end(); ++i) {
+		nodes++;
+		if (makeLegalMove(position, *i, undo, endedTurn)) {
+			position.unmakeMove(undo);
+			return false;
+		}
+	}
+
+	return position.isInCheck(defender);
+}
+
+/**
+ * Determine whether the attacker can force a win
+ *
+ * @param movesLeft the number of turns the attacker has left, including the current one if it is the attacker's turn
+ */
+bool MateSearch::forcesWin(Position& position, unsigned int movesLeft, unsigned long long& nodes) const {
+	const unsigned int mover = position.getCurTurn();
+	const bool isTurnStart = !position.hasPendingMove();
+
+	if (mover == attacker) {
+		if (movesLeft == 0 || (isTurnStart && position.hasLost(attacker))) {
+			return false;
+		}
+	} else if (isTurnStart && position.hasLost(mover)) {
+		return true;
+	}
+
+	std::vector<Position::Move> moves;
+	position.generateMoves(moves);
+
+	Position::Undo undo;
+	bool endedTurn;
+	bool hasLegalMove = false;
+	for (std::vector<Position::Move>::const_iterator i = moves.begin(); i != moves.end(); ++i) {
+		nodes++;
+		if (!makeLegalMove(position, *i, undo, endedTurn)) continue;
+		hasLegalMove = true;
+
+		const bool wins = forcesWin(position, getChildMovesLeft(mover, endedTurn, movesLeft), nodes);
+		position.unmakeMove(undo);
+
+		// The attacker needs one winning move, the defender needs one escape
+		if (mover == attacker && wins) {
+			return true;
+		} else if (mover != attacker && !wins) {
+			return false;
+		}
+	}
+
+	// Without a legal move, the attacker cannot win and the defender is beaten only if in check
+	if (mover == attacker) {
+		return false;
+	}
+
+	return hasLegalMove || position.isInCheck(mover);
+}
+
+/**
+ * Get the fewest turns the attacker needs to force a win, or UINT_MAX if it takes more than the maximum
+ */
+unsigned int MateSearch::getMovesToWin(Position& position, unsigned int maxMoves, unsigned long long& nodes) const {
+	for (unsigned int numMoves = 0; numMoves <= maxMoves; numMoves++) {
+		if (forcesWin(position, numMoves, nodes)) {
+			return numMoves;
+		}
+	}
+
+	return UINT_MAX;
+}
+
+/**
+ * Search the root moves shared between the threads, keeping the earliest winning move. The nodes are counted locally
+ * and written once at the end, so that the threads do not share the cache line of the counters while searching.
+ */
+void MateSearch::searchRoot(
+	const std::vector<Position::Move>* moves, unsigned int movesLeft,
+	std::atomic<unsigned int>* nextMove, std::atomic<unsigned int>* bestMove, unsigned long long* nodes
+) const {
+	Position position = root;
+	Position::Undo undo;
+	bool endedTurn;
+	unsigned long long numNodes = 0;
+
+	for (unsigned int i = (*nextMove)++; i < moves->size(); i = (*nextMove)++) {
+		// Skip moves after one that is already known to win
+		if (i > *bestMove) break;
+
+		numNodes++;
+		position.makeMove((*moves)[i], undo);
+		endedTurn = !position.hasPendingMove();
+
+		if (forcesWin(position, getChildMovesLeft(attacker, endedTurn, movesLeft), numNodes)) {
+			unsigned int best = *bestMove;
+			while (i < best && !bestMove->compare_exchange_weak(best, i)) {}
+		}
+
+		position.unmakeMove(undo);
+	}
+
+	*nodes = numNodes;
+}
+
+/**
+ * Build the winning line, with the defender choosing the longest resistance
+ */
+void MateSearch::buildLine(unsigned int firstMove, unsigned int numMoves, Result& result) const {
+	Position position = root;
+	Position::Undo undo;
+	bool endedTurn;
+
+	std::vector<Position::Move> moves;
+	std::vector<Position::Move> legalMoves;
+	position.generateMoves(moves);
+	for (std::vector<Position::Move>::const_iterator i = moves.begin(); i != moves.end(); ++i) {
+		if (makeLegalMove(position, *i, undo, endedTurn)) {
+			position.unmakeMove(undo);
+			legalMoves.push_back(*i);
+		}
+	}
+
+	// Play the first move
+	result.line.push_back(position.moveToString(legalMoves[firstMove]));
+	position.makeMove(legalMoves[firstMove], undo);
+	unsigned int movesLeft = getChildMovesLeft(attacker, !position.hasPendingMove(), numMoves);
+
+	while (!isBeaten(position, result.nodes)) {
+		const unsigned int mover = position.getCurTurn();
+		position.generateMoves(moves);
+
+		bool found = false;
+		Position::Move bestMove;
+		unsigned int bestMovesToWin = 0;
+		for (std::vector<Position::Move>::const_iterator i = moves.begin(); i != moves.end(); ++i) {
+			if (!makeLegalMove(position, *i, undo, endedTurn)) continue;
+
+			const unsigned int childMovesLeft = getChildMovesLeft(mover, endedTurn, movesLeft);
+			const unsigned int movesToWin = getMovesToWin(position, childMovesLeft, result.nodes);
+			position.unmakeMove(undo);
+
+			if (movesToWin == UINT_MAX) continue;
+
+			// The attacker takes the fastest win and the defender takes the slowest loss
+			if (!found ||
+				(mover == attacker && movesToWin < bestMovesToWin) ||
+				(mover != attacker && movesToWin > bestMovesToWin)
+			) {
+				found = true;
+				bestMove = *i;
+				bestMovesToWin = movesToWin;
+			}
+		}
+
+		if (!found) break;
+
+		result.line.push_back(position.moveToString(bestMove));
+		position.makeMove(bestMove, undo);
+		movesLeft = bestMovesToWin;
+	}
+}
+
+
+
+// Constructors
+
+/**
+ * Constructor
+ *
+ * @param numThreads_ the number of threads to split the root moves between
+ */
+MateSearch::MateSearch(const Position& root_, unsigned int numThreads_) :
+	root{root_},
+	attacker{root_.getCurTurn()},
+	numThreads{(numThreads_ == 0) ? (1) : (numThreads_)}
+{
+}
+
+
+
+// Methods
+
+/**
+ * Find the shortest forced win of at most the given number of turns
+ */
+MateSearch::Result MateSearch::solve(unsigned int maxMoves) const {
+	Result result{ false, 0, std::vector<std::string>(), 0 };
+
+	// Find the legal root moves
+	Position position = root;
+	Position::Undo undo;
+	bool endedTurn;
+
+	std::vector<Position::Move> moves;
+	std::vector<Position::Move> legalMoves;
+	position.generateMoves(moves);
+	for (std::vector<Position::Move>::const_iterator i = moves.begin(); i != moves.end(); ++i) {
+		if (makeLegalMove(position, *i, undo, endedTurn)) {
+			position.unmakeMove(undo);
+			legalMoves.push_back(*i);
+		}
+	}
+
+	// Deepen one turn at a time so that the shortest win is found first
+	for (unsigned int numMoves = 1; numMoves <= maxMoves; numMoves++) {
+		std::atomic<unsigned int> nextMove(0);
+		std::atomic<unsigned int> bestMove(UINT_MAX);
+		std::vector<unsigned long long> nodes(numThreads, 0);
+		std::vector<std::thread> threads;
+
+		for (unsigned int i = 0; i < numThreads; i++) {
+			threads.push_back(std::thread(
+				&MateSearch::searchRoot, this, &legalMoves, numMoves, &nextMove, &bestMove, &nodes[i]
+			));
+		}
+
+		for (std::vector<std::thread>::iterator i = threads.begin(); i != threads.end(); ++i) {
+			i->join();
+		}
+
+		for (std::vector<unsigned long long>::const_iterator i = nodes.begin(); i != nodes.end(); ++i) {
+			result.nodes += *i;
+		}
+
+		if (bestMove != UINT_MAX) {
+			result.found = true;
+			result.numMoves = numMoves;
+			buildLine(bestMove, numMoves, result);
+			break;
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,51 @@
+#ifndef CHESS_MATE_SEARCH_H
+#define CHESS_MATE_SEARCH_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "position.h"
+
+// Class declaration
+
+/**
+ * Searches for forced wins for the team whose turn it is. A team is beaten when it has no legal
+ * moves while in check, or when it has lost all of its pieces or royal pieces.
+ */
+class MateSearch {
+public:
+	// Helper structs
+	struct Result {
+		bool found;
+		unsigned int numMoves;
+		std::vector<std::string> line;
+		unsigned long long nodes;
+	};
+
+private:
+	// Members
+	const Position root;
+	const unsigned int attacker;
+	const unsigned int numThreads;
+
+	// Helpers
+	bool makeLegalMove(Position& position, const Position::Move& move, Position::Undo& undo, bool& endedTurn) const;
+	unsigned int getChildMovesLeft(unsigned int mover, bool endedTurn, unsigned int movesLeft) const;
+	bool isBeaten(Position& position, unsigned long long& nodes) const;
+	bool forcesWin(Position& position, unsigned int movesLeft, unsigned long long& nodes) const;
+	unsigned int getMovesToWin(Position& position, unsigned int maxMoves, unsigned long long& nodes) const;
+	void searchRoot(
+		const std::vector<Position::Move>* moves, unsigned int movesLeft,
+		std::atomic<unsigned int>* nextMove, std::atomic<unsigned int>* bestMove, unsigned long long* nodes
+	) const;
+	void buildLine(unsigned int firstMove, unsigned int numMoves, Result& result) const;
+
+public:
+	// Constructors
+	MateSearch(const Position& root_, unsigned int numThreads_);
+
+	// Methods
+	Result solve(unsigned int maxMoves) const;
+};
+
+#endif // CHESS_MATE_SEARCH_H
@@ -0,0 +1,177 @@
+#include "playout.h"
+
+#include <algorithm>
+#include <thread>
+
+// Helpers
+
+/**
+ * Make a random legal move
+ *
+ * @return false if there are no legal moves
+ */
+bool Playout::makeRandomMove(Position& position, std::vector<Position::Move>& moves, std::mt19937& random) const {
+	const unsigned int mover = position.getCurTurn();
+	position.generateMoves(moves);
+
+	// Try captures before other moves
+	std::size_t numCaptures = 0;
+	if (policy == CAPTURES) {
+		numCaptures = std::partition(moves.begin(), moves.end(), [&](const Position::Move& move){
+			const int target = (move.piece < 0) ? (-1) : (position.getPiece(move.to));
+			return target >= 0 && position.getPieces()[target].team != mover;
+		}) - moves.begin();
+	}
+
+	Position::Undo undo;
+	while (!moves.empty()) {
+		// Pick from the captures while there are any left
+		const std::size_t numCandidates = (numCaptures > 0) ? (numCaptures) : (moves.size());
+		std::size_t index = std::uniform_int_distribution<std::size_t>(0, numCandidates - 1)(random);
+
+		position.makeMove(moves[index], undo);
+		if (position.hasPendingMove() || !position.isInCheck(mover)) {
+			return true;
+		}
+
+		// Discard moves that end the turn in check
+		position.unmakeMove(undo);
+		if (index < numCaptures) {
+			std::swap(moves[index], moves[--numCaptures]);
+			index = numCaptures;
+		}
+		std::swap(moves[index], moves.back());
+		moves.pop_back();
+	}
+
+	return false;
+}
+
+/**
+ * Get the index of the only team left, DRAW if there are no teams left, or NONE if the game is not over
+ */
+int Playout::getWinner(const Position& position) const {
+	int winner = DRAW;
+	const std::vector<Position::Team>& teams = position.getTeams();
+	for (std::size_t i = 0; i < teams.size(); i++) {
+		if (!position.hasLost(teams[i].teamIndex)) {
+			if (winner != DRAW) return NONE;
+			winner = i;
+		}
+	}
+
+	return winner;
+}
+
+/**
+ * Play a single game
+ *
+ * @return the index of the winning team, DRAW or TIMEOUT
+ */
+int Playout::playGame(unsigned int gameIndex, unsigned long long& plies) const {
+	Position position = root;
+	std::seed_seq seedSequence{ seed, gameIndex };
+	std::mt19937 random(seedSequence);
+	std::vector<Position::Move> moves;
+
+	int lastMover = DRAW;
+	for (unsigned int ply = 0; ply < maxPlies; ply++) {
+		if (!position.hasPendingMove()) {
+			const int winner = getWinner(position);
+			if (winner != NONE) return winner;
+		}
+
+		const unsigned int mover = position.getCurTurn();
+		if (!makeRandomMove(position, moves, random)) {
+			// Checkmate wins for the team that gave it and stalemate is a draw
+			return position.isInCheck(mover) ? (lastMover) : (DRAW);
+		}
+
+		plies++;
+		for (std::size_t i = 0; i < position.getTeams().size(); i++) {
+			if (position.getTeams()[i].teamIndex == mover) lastMover = i;
+		}
+	}
+
+	return TIMEOUT;
+}
+
+/**
+ * Play games until the batch is finished. The results are counted on the stack and copied out once at the end, so
+ * that the threads do not share the cache lines of their results while playing.
+ */
+void Playout::playGames(unsigned int numGames, std::atomic<unsigned int>* nextGame, Result* result) const {
+	Result local = *result;
+	for (unsigned int i = (*nextGame)++; i < numGames; i = (*nextGame)++) {
+		const int winner = playGame(i, local.plies);
+		local.games++;
+
+		if (winner == DRAW) {
+			local.draws++;
+		} else if (winner == TIMEOUT) {
+			local.timeouts++;
+		} else {
+			local.wins[winner]++;
+		}
+	}
+
+	*result = local;
+}
+
+
+
+// Constructors
+
+/**
+ * Constructor
+ *
+ * @param maxPlies_ the number of moves after which a game counts as a timeout
+ */
+Playout::Playout(const Position& root_, Policy policy_, unsigned int maxPlies_, unsigned int seed_) :
+	root{root_},
+	policy{policy_},
+	maxPlies{maxPlies_},
+	seed{seed_}
+{
+}
+
+
+
+// Methods
+
+/**
+ * Play a batch of games split between threads, each with its own copy of the position
+ */
+Playout::Result Playout::run(unsigned int numGames, unsigned int numThreads) const {
+	if (numThreads == 0) {
+		numThreads = 1;
+	}
+
+	const Result empty{ std::vector<unsigned long long>(root.getTeams().size(), 0), 0, 0, 0, 0 };
+	std::vector<Result> results(numThreads, empty);
+	std::vector<std::thread> threads;
+	std::atomic<unsigned int> nextGame(0);
+
+	for (unsigned int i = 0; i < numThreads; i++) {
+		threads.push_back(std::thread(&Playout::playGames, this, numGames, &nextGame, &results[i]));
+	}
+
+	for (std::vector<std::thread>::iterator i = threads.begin(); i != threads.end(); ++i) {
+		i->join();
+	}
+
+	// Combine the results
+	Result result = empty;
+	for (std::vector<Result>::const_iterator i = results.begin(); i != results.end(); ++i) {
+		for (std::size_t j = 0; j < result.wins.size(); j++) {
+			result.wins[j] += i->wins[j];
+		}
+
+		result.draws += i->draws;
+		result.timeouts += i->timeouts;
+		result.games += i->games;
+		result.plies += i->plies;
+	}
+
+	return result;
+}
@@ -0,0 +1,60 @@
+#ifndef CHESS_PLAYOUT_H
+#define CHESS_PLAYOUT_H
+
+#include <atomic>
+#include <random>
+#include <vector>
+#include "position.h"
+
+// Class declaration
+
+/**
+ * Plays batches of random games from a position to estimate how balanced it is.
+ * Each game is seeded from its own index, so the results do not depend on the number of threads.
+ */
+class Playout {
+public:
+	enum Policy {
+		RANDOM, CAPTURES
+	};
+
+	// Helper structs
+
+	/**
+	 * The outcomes of a batch of games, with the wins in the same order as Position::getTeams
+	 */
+	struct Result {
+		std::vector<unsigned long long> wins;
+		unsigned long long draws;
+		unsigned long long timeouts;
+		unsigned long long games;
+		unsigned long long plies;
+	};
+
+private:
+	// Constants
+	static const int DRAW = -1;
+	static const int TIMEOUT = -2;
+	static const int NONE = -3;
+
+	// Members
+	const Position root;
+	const Policy policy;
+	const unsigned int maxPlies;
+	const unsigned int seed;
+
+	// Helpers
+	bool makeRandomMove(Position& position, std::vector<Position::Move>& moves, std::mt19937& random) const;
+	int getWinner(const Position& position) const;
+	int playGame(unsigned int gameIndex, unsigned long long& plies) const;
+	void playGames(unsigned int numGames, std::atomic<unsigned int>* nextGame, Result* result) const;
+
+public:
+	// Constructors
+	Playout(const Position& root_, Policy policy_, unsigned int maxPlies_, unsigned int seed_);
+
+	// Methods
+	Result run(unsigned int numGames, unsigned int numThreads) const;
+};
+
+#endif // CHESS_PLAYOUT_H
@@ -0,0 +1,637 @@
+#include "position.h"
+
+#include <algorithm>
+#include "../components/event.h"
+#include "../components/moveDef.h"
+#include "../components/numRule.h"
+#include "../components/piece.h"
+#include "../components/targetingRule.h"
+
+// Private helpers
+
+/**
+ * Determine whether a candidate meets any of the num rules
+ */
+bool Position::meetsAnyRule(const std::vector<NumRule*>* numRules, unsigned int candidate) {
+	for (std::vector<NumRule*>::const_iterator i = numRules->begin(); i != numRules->end(); ++i) {
+		if ((*i)->matches(candidate)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Get the rays for a move, in the same order as MoveDef::generateMarkers
+ */
+void Position::getRays(const BoardPiece& piece, const MoveDef* move, std::vector<Ray>& rays) const {
+	rays.clear();
+
+	for (int x = (move->isXSymmetric ? 0 : 1); x < 2; x++) {
+		for (int y = (move->isYSymmetric ? 0 : 1); y < 2; y++) {
+			for (int xy = (move->isXYSymmetric ? 0 : 1); xy < 2; xy++) {
+				const sf::Vector2i reflected = VectorUtils::reflect(move->baseVector, !x, !y, !xy);
+				const sf::Vector2i rotated = MoveDef::rotate(reflected, piece.dir);
+
+				// Skip empty and duplicate rays: the move tracker only keeps the first marker at each position
+				if (rotated == sf::Vector2i(0, 0)) continue;
+				bool isDuplicate = false;
+				for (std::vector<Ray>::const_iterator i = rays.begin(); i != rays.end(); ++i) {
+					if (i->dir == rotated) isDuplicate = true;
+				}
+
+				if (!isDuplicate) {
+					rays.push_back(Ray{ move, rotated, !x, !y, !xy });
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Determine whether a move marker at the position would be a valid move destination
+ */
+bool Position::canMove(
+	const BoardPiece& piece, const Ray& ray, sf::Vector2i pos,
+	unsigned int lambda, unsigned int numObstructions, bool requireChainedMove
+) const {
+	const MoveDef* move = ray.move;
+
+	// Check if the position meets the movement requirements
+	if (!meetsAnyRule(move->leapingRules, numObstructions) ||
+		!meetsAnyRule(move->scalingRules, lambda) ||
+		!meetsAnyRule(move->nthStepRules, piece.moveCount)
+	) {
+		return false;
+	}
+
+	// Check the targeting rules
+	for (std::vector<const TargetingRule*>::const_iterator i = move->targetingRules->begin();
+		i != move->targetingRules->end(); ++i
+	) {
+		const sf::Vector2i rotated = MoveDef::rotate((*i)->offsetVector, piece.dir);
+		const sf::Vector2i transformed = VectorUtils::reflect(rotated, ray.switchedX, ray.switchedY, ray.switchedXY);
+		const int target = getPiece(pos + transformed);
+
+		if (target < 0) {
+			if (!(*i)->matches(piece.team, nullptr, 0, 0, 0)) return false;
+		} else {
+			const BoardPiece& candidate = pieces[target];
+			if (!(*i)->matches(piece.team, candidate.def, candidate.team, candidate.moveCount, candidate.lastMove)) {
+				return false;
+			}
+		}
+	}
+
+	// Check if the move meets chained move requirements
+	return !requireChainedMove || isChainedMove(piece, move->index);
+}
+
+/**
+ * Find the move marker that a move would have at the destination, if any
+ */
+bool Position::findMarker(
+	const BoardPiece& piece, const MoveDef* move, sf::Vector2i dest,
+	Ray& ray, unsigned int& lambda, unsigned int& numObstructions
+) const {
+	// No markers are generated if the piece does not meet the move's nth step rules
+	if (!move->meetsNthStepRules(piece.moveCount)) {
+		return false;
+	}
+
+	const sf::Vector2i displacement = dest - piece.pos;
+	std::vector<Ray> rays;
+	getRays(piece, move, rays);
+
+	for (std::vector<Ray>::const_iterator i = rays.begin(); i != rays.end(); ++i) {
+		// Check whether the destination lies on the ray
+		long long multiple;
+		if (i->dir.x != 0) {
+			if (displacement.x % i->dir.x != 0) continue;
+			multiple = displacement.x / i->dir.x;
+			if ((long long) i->dir.y * multiple != displacement.y) continue;
+		} else {
+			if (displacement.x != 0 || displacement.y % i->dir.y != 0) continue;
+			multiple = displacement.y / i->dir.y;
+		}
+
+		if (multiple < 1 || (move->constantMultiple && multiple > move->constantMultiple)) continue;
+
+		// Count the pieces in the way
+		ray = *i;
+		lambda = multiple;
+		numObstructions = 0;
+		for (unsigned int j = 1; j < lambda; j++) {
+			numObstructions += (getPiece(piece.pos + i->dir * (int) j) >= 0);
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * Determine whether a move index may follow the piece's last move
+ */
+bool Position::isChainedMove(const BoardPiece& piece, int moveIndex) const {
+	const std::map<int, const MoveDef*>::const_iterator lastMoveIter = piece.def->moves->find(piece.lastMove);
+	if (lastMoveIter == piece.def->moves->end()) {
+		return true;
+	}
+
+	const std::vector<int>* chainedMoves = lastMoveIter->second->chainedMoves;
+	return std::find(chainedMoves->begin(), chainedMoves->end(), moveIndex) != chainedMoves->end();
+}
+
+/**
+ * Determine whether a position is inside the searched area
+ */
+bool Position::isInBounds(sf::Vector2i pos) const {
+	return bounds.contains(pos);
+}
+
+/**
+ * Generate all the valid destinations for a piece
+ */
+void Position::generateMoves(int pieceIndex, bool requireChainedMove, std::vector<Move>& moves) const {
+	const BoardPiece& piece = pieces[pieceIndex];
+	const std::size_t firstMove = moves.size();
+	std::vector<Ray> rays;
+
+	for (std::map<int, const MoveDef*>::const_iterator i = piece.def->moves->begin(); i != piece.def->moves->end(); ++i) {
+		const MoveDef* move = i->second;
+		if (!move->meetsNthStepRules(piece.moveCount)) continue;
+
+		const unsigned int maxLambda = NumRule::getUpperBound(move->scalingRules);
+		const unsigned int maxObstructions = NumRule::getUpperBound(move->leapingRules);
+
+		getRays(piece, move, rays);
+		for (std::vector<Ray>::const_iterator ray = rays.begin(); ray != rays.end(); ++ray) {
+			unsigned int numObstructions = 0;
+
+			// Walk along the ray until no further position can be valid
+			for (unsigned int lambda = 1; lambda <= maxLambda; lambda++) {
+				if (move->constantMultiple && lambda > move->constantMultiple) break;
+
+				const sf::Vector2i pos = piece.pos + ray->dir * (int) lambda;
+				if (lambda > 1 && !isInBounds(pos)) break;
+
+				if (canMove(piece, *ray, pos, lambda, numObstructions, requireChainedMove)) {
+					// Only keep one move per destination
+					bool isDuplicate = false;
+					for (std::size_t j = firstMove; j < moves.size(); j++) {
+						if (moves[j].to == pos) isDuplicate = true;
+					}
+
+					if (!isDuplicate) {
+						moves.push_back(Move{ pieceIndex, pos });
+					}
+				}
+
+				numObstructions += (getPiece(pos) >= 0);
+				if (numObstructions > maxObstructions) break;
+			}
+		}
+	}
+}
+
+/**
+ * Store a piece's state before it is modified
+ */
+void Position::save(int pieceIndex, Undo& undo) const {
+	undo.pieces.push_back(std::make_pair(pieceIndex, pieces[pieceIndex]));
+}
+
+/**
+ * Store a team's state before it is modified
+ */
+void Position::saveTeam(unsigned int team, Undo& undo) const {
+	undo.teams.push_back(std::make_pair(team, teams[team]));
+}
+
+/**
+ * Take a piece off the board
+ */
+void Position::removeFromBoard(int pieceIndex) {
+	BoardPiece& piece = pieces[pieceIndex];
+	if (!piece.onBoard) return;
+
+	std::unordered_map<std::int64_t, int>::iterator found = occupancy.find(key(piece.pos));
+	if (found != occupancy.end() && found->second == pieceIndex) {
+		occupancy.erase(found);
+	}
+
+	piece.onBoard = false;
+}
+
+/**
+ * Put a piece on the board, unless the position is already occupied
+ */
+void Position::placeOnBoard(int pieceIndex, sf::Vector2i pos) {
+	BoardPiece& piece = pieces[pieceIndex];
+	piece.pos = pos;
+	piece.onBoard = occupancy.insert(std::make_pair(key(pos), pieceIndex)).second;
+}
+
+/**
+ * Destroy a piece
+ */
+void Position::destroy(int pieceIndex, Undo& undo) {
+	BoardPiece& piece = pieces[pieceIndex];
+	if (piece.destroyed) return;
+
+	const int team = findTeam(piece.team);
+	if (team >= 0) {
+		saveTeam(team, undo);
+		teams[team].numPieces--;
+		if (piece.def->isRoyal) teams[team].numRoyals--;
+	}
+
+	piece.destroyed = true;
+}
+
+/**
+ * Advance to the next team that still has pieces, as in Controller::advanceTurn
+ */
+void Position::advanceTurn() {
+	moved = false;
+
+	for (std::size_t i = 0; i < teams.size(); i++) {
+		curTurn = (curTurn + 1) % teams.size();
+		if (teams[curTurn].numPieces != 0) break;
+	}
+}
+
+/**
+ * Get the index of a team in the turn order
+ */
+int Position::findTeam(unsigned int teamIndex) const {
+	for (std::size_t i = 0; i < teams.size(); i++) {
+		if (teams[i].teamIndex == teamIndex) return i;
+	}
+
+	return -1;
+}
+
+
+
+// Constructors
+
+/**
+ * Constructor
+ *
+ * @param margin the number of tiles around the pieces' bounding box that rays are allowed to extend into
+ */
+Position::Position(
+	const std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams_,
+	unsigned int curTurn_,
+	const std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces_,
+	unsigned int margin
+) :
+	curTurn{0},
+	moved{false},
+	pendingPiece{-1},
+	chainLength{0}
+{
+	// Store the teams in turn order
+	for (std::map<const unsigned int, std::pair<const std::string, sf::Color>>::const_iterator i = teams_->begin();
+		i != teams_->end(); ++i
+	) {
+		teams.push_back(Team{ i->first, i->second.first, 0, 0, false });
+	}
+
+	// Copy the pieces and find the bounding box
+	sf::Vector2i min, max;
+	for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::const_iterator i = pieces_->begin();
+		i != pieces_->end(); ++i
+	) {
+		const Piece* piece = i->second;
+		const int index = pieces.size();
+		pieces.push_back(BoardPiece{
+			piece->getDef(), piece->getTeam(), piece->getPos(), piece->getDir(),
+			piece->getMoveCount(), piece->getLastMove(), false, false
+		});
+		placeOnBoard(index, piece->getPos());
+
+		if (index == 0) {
+			min = max = piece->getPos();
+		} else {
+			min.x = std::min(min.x, piece->getPos().x);
+			min.y = std::min(min.y, piece->getPos().y);
+			max.x = std::max(max.x, piece->getPos().x);
+			max.y = std::max(max.y, piece->getPos().y);
+		}
+
+		const int team = findTeam(piece->getTeam());
+		if (team >= 0) {
+			teams[team].numPieces++;
+			if (piece->getDef()->isRoyal) {
+				teams[team].numRoyals++;
+				teams[team].hasRoyals = true;
+			}
+		}
+	}
+
+	bounds = sf::IntRect(
+		min.x - (int) margin, min.y - (int) margin,
+		max.x - min.x + 2 * (int) margin + 1, max.y - min.y + 2 * (int) margin + 1
+	);
+
+	const int turn = findTeam(curTurn_);
+	curTurn = (turn < 0) ? (0) : (turn);
+}
+
+
+
+// Accessors
+
+/**
+ * Get the index of the piece at a position, or -1 if the position is empty
+ */
+int Position::getPiece(sf::Vector2i pos) const {
+	std::unordered_map<std::int64_t, int>::const_iterator found = occupancy.find(key(pos));
+	return (found == occupancy.end()) ? (-1) : (found->second);
+}
+
+/**
+ * Determine whether any other team can move to a position
+ */
+bool Position::isAttacked(sf::Vector2i pos, unsigned int team) const {
+	Ray ray;
+	unsigned int lambda;
+	unsigned int numObstructions;
+
+	for (std::vector<BoardPiece>::const_iterator i = pieces.begin(); i != pieces.end(); ++i) {
+		if (!i->onBoard || i->destroyed || i->team == team) continue;
+
+		for (std::map<int, const MoveDef*>::const_iterator j = i->def->moves->begin(); j != i->def->moves->end(); ++j) {
+			if (findMarker(*i, j->second, pos, ray, lambda, numObstructions) &&
+				canMove(*i, ray, pos, lambda, numObstructions, false)
+			) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Determine whether any of a team's check-vulnerable pieces are attacked
+ */
+bool Position::isInCheck(unsigned int team) const {
+	for (std::vector<BoardPiece>::const_iterator i = pieces.begin(); i != pieces.end(); ++i) {
+		if (i->onBoard && !i->destroyed && i->team == team && i->def->isCheckVulnerable && isAttacked(i->pos, team)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Determine whether a team has no pieces left or has lost all of its royal pieces
+ */
+bool Position::hasLost(unsigned int team) const {
+	const int index = findTeam(team);
+	if (index < 0) return true;
+
+	const Team& t = teams[index];
+	return t.numPieces == 0 || (t.hasRoyals && t.numRoyals == 0);
+}
+
+/**
+ * Get a readable description of a move
+ */
+std::string Position::moveToString(const Move& move) const {
+	if (move.piece < 0) {
+		return "pass";
+	}
+
+	const BoardPiece& piece = pieces[move.piece];
+	return piece.def->name +
+		" (" + std::to_string(piece.pos.x) + ", " + std::to_string(piece.pos.y) + ") -> (" +
+		std::to_string(move.to.x) + ", " + std::to_string(move.to.y) + ")";
+}
+
+
+
+// Methods
+
+/**
+ * Mark the current turn as already started by the piece at a position, which must continue with chained moves
+ */
+void Position::continueTurn(sf::Vector2i pos) {
+	moved = true;
+	pendingPiece = getPiece(pos);
+	chainLength = 0;
+}
+
+/**
+ * Generate all the moves for the team whose turn it is
+ */
+void Position::generateMoves(std::vector<Move>& moves) const {
+	moves.clear();
+
+	// Only the selected piece may continue a turn that has not ended
+	if (pendingPiece >= 0) {
+		if (chainLength < MAX_CHAIN_LENGTH && pieces[pendingPiece].onBoard && !pieces[pendingPiece].destroyed) {
+			generateMoves(pendingPiece, true, moves);
+		}
+
+		moves.push_back(Move{ -1, pieces[pendingPiece].pos });
+		return;
+	}
+
+	const unsigned int team = teams[curTurn].teamIndex;
+	for (std::size_t i = 0; i < pieces.size(); i++) {
+		if (pieces[i].onBoard && !pieces[i].destroyed && pieces[i].team == team) {
+			generateMoves(i, moved, moves);
+		}
+	}
+}
+
+/**
+ * Find the valid move between two positions
+ *
+ * @return true if the move is valid
+ */
+bool Position::findMove(sf::Vector2i from, sf::Vector2i to, Move& move) const {
+	std::vector<Move> moves;
+	generateMoves(moves);
+
+	const int piece = getPiece(from);
+	for (std::vector<Move>::const_iterator i = moves.begin(); i != moves.end(); ++i) {
+		if (i->piece == piece && i->to == to) {
+			move = *i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Make a move with the same effects as Controller::move
+ */
+void Position::makeMove(const Move& move, Undo& undo) {
+	undo.pieces.clear();
+	undo.teams.clear();
+	undo.curTurn = curTurn;
+	undo.moved = moved;
+	undo.pendingPiece = pendingPiece;
+	undo.chainLength = chainLength;
+
+	// End the turn
+	if (move.piece < 0) {
+		advanceTurn();
+		pendingPiece = -1;
+		chainLength = 0;
+		return;
+	}
+
+	const BoardPiece piece = pieces[move.piece];
+	const sf::Vector2i pos = move.to;
+
+	// Find the move markers at the destination
+	struct MarkerAtDest {
+		Ray ray;
+		bool canMove;
+	};
+	std::vector<MarkerAtDest> markers;
+	const MarkerAtDest* dest = nullptr;
+	for (std::map<int, const MoveDef*>::const_iterator i = piece.def->moves->begin(); i != piece.def->moves->end(); ++i) {
+		Ray ray;
+		unsigned int lambda, numObstructions;
+		if (findMarker(piece, i->second, pos, ray, lambda, numObstructions)) {
+			markers.push_back(MarkerAtDest{ ray, canMove(piece, ray, pos, lambda, numObstructions, moved) });
+		}
+	}
+
+	for (std::vector<MarkerAtDest>::const_iterator i = markers.begin(); i != markers.end(); ++i) {
+		if (i->canMove) {
+			dest = &(*i);
+			break;
+		}
+	}
+
+	if (dest == nullptr) return;
+
+	// Get the targets before the board changes
+	struct Action {
+		int piece;
+		bool isDestroy;
+		sf::Vector2i dest;
+	};
+	std::vector<Action> actions;
+	const int destPiece = getPiece(pos);
+
+	for (std::vector<MarkerAtDest>::const_iterator i = markers.begin(); i != markers.end(); ++i) {
+		if (!i->canMove) continue;
+
+		// Targets are visited in position order, keeping the first rule at each position
+		std::map<sf::Vector2i, const TargetingRule*, VectorUtils::cmpVectorLexicographically> targets;
+		for (std::vector<const TargetingRule*>::const_iterator j = i->ray.move->targetingRules->begin();
+			j != i->ray.move->targetingRules->end(); ++j
+		) {
+			const sf::Vector2i rotated = MoveDef::rotate((*j)->offsetVector, piece.dir);
+			targets.insert(std::make_pair(
+				pos + VectorUtils::reflect(rotated, i->ray.switchedX, i->ray.switchedY, i->ray.switchedXY), *j
+			));
+		}
+
+		for (std::map<sf::Vector2i, const TargetingRule*, VectorUtils::cmpVectorLexicographically>::const_iterator j =
+			targets.begin(); j != targets.end(); ++j
+		) {
+			const int targetPiece = getPiece(j->first);
+			if (targetPiece < 0 || targetPiece == destPiece) continue;
+
+			const std::vector<Event>* targetEvents = j->second->getEvents();
+			for (std::vector<Event>::const_iterator k = targetEvents->begin(); k != targetEvents->end(); ++k) {
+				if (k->action == Event::MOVE) {
+					sf::Vector2i targetVector = MoveDef::rotate(k->dest, piece.dir);
+					targetVector = VectorUtils::reflect(
+						targetVector, dest->ray.switchedX, dest->ray.switchedY, dest->ray.switchedXY
+					);
+					actions.push_back(Action{ targetPiece, false, targetVector + pieces[targetPiece].pos });
+				} else if (k->action == Event::DESTROY) {
+					actions.push_back(Action{ targetPiece, true, pieces[targetPiece].pos });
+				}
+			}
+		}
+	}
+
+	// Take the moving piece and the captured piece off the board
+	save(move.piece, undo);
+	removeFromBoard(move.piece);
+	if (destPiece >= 0) {
+		save(destPiece, undo);
+		removeFromBoard(destPiece);
+	}
+
+	// Apply the targets' actions
+	for (std::vector<Action>::const_iterator i = actions.begin(); i != actions.end(); ++i) {
+		save(i->piece, undo);
+		removeFromBoard(i->piece);
+
+		if (i->isDestroy) {
+			destroy(i->piece, undo);
+		} else {
+			BoardPiece& target = pieces[i->piece];
+			target.moveCount++;
+			target.lastMove = -1;
+			placeOnBoard(i->piece, i->dest);
+		}
+	}
+
+	// Move the piece and destroy the captured piece
+	BoardPiece& moving = pieces[move.piece];
+	moving.moveCount++;
+	moving.lastMove = dest->ray.move->index;
+	placeOnBoard(move.piece, pos);
+
+	if (destPiece >= 0) {
+		destroy(destPiece, undo);
+	}
+
+	// Update the turn
+	moved = true;
+	if (dest->ray.move->endsTurn) {
+		advanceTurn();
+		pendingPiece = -1;
+		chainLength = 0;
+	} else {
+		pendingPiece = move.piece;
+		chainLength++;
+	}
+}
+
+/**
+ * Unmake a move made with makeMove
+ */
+void Position::unmakeMove(const Undo& undo) {
+	// Restore the pieces in reverse order
+	for (std::vector<std::pair<int, BoardPiece>>::const_reverse_iterator i = undo.pieces.rbegin();
+		i != undo.pieces.rend(); ++i
+	) {
+		removeFromBoard(i->first);
+		pieces[i->first] = i->second;
+		if (i->second.onBoard) {
+			occupancy[key(i->second.pos)] = i->first;
+		}
+	}
+
+	// Restore the teams in reverse order
+	for (std::vector<std::pair<int, Team>>::const_reverse_iterator i = undo.teams.rbegin();
+		i != undo.teams.rend(); ++i
+	) {
+		teams[i->first] = i->second;
+	}
+
+	curTurn = undo.curTurn;
+	moved = undo.moved;
+	pendingPiece = undo.pendingPiece;
+	chainLength = undo.chainLength;
+}
@@ -0,0 +1,152 @@
+#ifndef CHESS_POSITION_H
+#define CHESS_POSITION_H
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../components/pieceDef.h"
+#include "../utils/vectorUtils.h"
+
+// Forward declarations
+class MoveDef;
+class NumRule;
+class Piece;
+
+
+
+/**
+ * A compact, copyable snapshot of a board for searching without the move marker machinery.
+ * Moves are evaluated with the same rules as MoveMarker and applied with the same effects as
+ * Controller::move, but everything is computed on demand so that moves can be made and unmade cheaply.
+ */
+class Position {
+public:
+	// Helper structs
+	struct BoardPiece {
+		const PieceDef* def;
+		unsigned int team;
+		sf::Vector2i pos;
+		PieceDef::Direction dir;
+		unsigned int moveCount;
+		int lastMove;
+		bool onBoard;
+		bool destroyed;
+	};
+
+	struct Team {
+		unsigned int teamIndex;
+		std::string name;
+		unsigned int numPieces;
+		unsigned int numRoyals;
+		bool hasRoyals;
+	};
+
+	/**
+	 * A single step of a turn. A piece of -1 passes the rest of the turn after a move that does not end it.
+	 */
+	struct Move {
+		int piece;
+		sf::Vector2i to;
+	};
+
+	/**
+	 * The state needed to unmake a move
+	 */
+	struct Undo {
+		std::vector<std::pair<int, BoardPiece>> pieces;
+		std::vector<std::pair<int, Team>> teams;
+		unsigned int curTurn;
+		bool moved;
+		int pendingPiece;
+		unsigned int chainLength;
+	};
+
+private:
+	// Helper structs
+
+	/**
+	 * A ray of potential move markers for a single symmetry of a move
+	 */
+	struct Ray {
+		const MoveDef* move;
+		sf::Vector2i dir;
+		bool switchedX;
+		bool switchedY;
+		bool switchedXY;
+	};
+
+	// Constants
+	static const unsigned int MAX_CHAIN_LENGTH = 8;
+
+	// Members
+	std::vector<BoardPiece> pieces;
+	std::vector<Team> teams;
+	std::unordered_map<std::int64_t, int> occupancy;
+
+	unsigned int curTurn;
+	bool moved;
+	int pendingPiece;
+	unsigned int chainLength;
+
+	sf::IntRect bounds;
+
+	// Helpers
+	static inline std::int64_t key(const sf::Vector2i pos) {
+		return (static_cast<std::int64_t>(pos.x) << 32) ^ static_cast<std::uint32_t>(pos.y);
+	}
+
+	static bool meetsAnyRule(const std::vector<NumRule*>* numRules, unsigned int candidate);
+
+	void getRays(const BoardPiece& piece, const MoveDef* move, std::vector<Ray>& rays) const;
+	bool canMove(
+		const BoardPiece& piece, const Ray& ray, sf::Vector2i pos,
+		unsigned int lambda, unsigned int numObstructions, bool requireChainedMove
+	) const;
+	bool findMarker(
+		const BoardPiece& piece, const MoveDef* move, sf::Vector2i dest,
+		Ray& ray, unsigned int& lambda, unsigned int& numObstructions
+	) const;
+	bool isChainedMove(const BoardPiece& piece, int moveIndex) const;
+	bool isInBounds(sf::Vector2i pos) const;
+	void generateMoves(int pieceIndex, bool requireChainedMove, std::vector<Move>& moves) const;
+
+	void save(int pieceIndex, Undo& undo) const;
+	void saveTeam(unsigned int team, Undo& undo) const;
+	void removeFromBoard(int pieceIndex);
+	void placeOnBoard(int pieceIndex, sf::Vector2i pos);
+	void destroy(int pieceIndex, Undo& undo);
+	void advanceTurn();
+	int findTeam(unsigned int teamIndex) const;
+
+public:
+	// Constructors
+	Position(
+		const std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams_,
+		unsigned int curTurn_,
+		const std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces_,
+		unsigned int margin
+	);
+
+	// Accessors
+	inline const std::vector<BoardPiece>& getPieces() const { return pieces; }
+	inline const std::vector<Team>& getTeams() const { return teams; }
+	inline unsigned int getCurTurn() const { return teams[curTurn].teamIndex; }
+	inline bool hasPendingMove() const { return pendingPiece >= 0; }
+	int getPiece(sf::Vector2i pos) const;
+	bool isAttacked(sf::Vector2i pos, unsigned int team) const;
+	bool isInCheck(unsigned int team) const;
+	bool hasLost(unsigned int team) const;
+	std::string moveToString(const Move& move) const;
+
+	// Methods
+	void continueTurn(sf::Vector2i pos);
+	void generateMoves(std::vector<Move>& moves) const;
+	bool findMove(sf::Vector2i from, sf::Vector2i to, Move& move) const;
+	void makeMove(const Move& move, Undo& undo);
+	void unmakeMove(const Undo& undo);
+};
+
+#endif // CHESS_POSITION_H
@@ -0,0 +1,248 @@
+#include "search.h"
+
+#include <algorithm>
+
+// Helpers
+
+/**
+ * Determine whether the search should stop, checking the clock every few nodes
+ */
+bool Search::shouldStop() {
+	if (stopRequested) {
+		return true;
+	}
+
+	if (limits.moveTime != 0 && nodes % CHECK_INTERVAL == 0 &&
+		timer.getElapsedTime().asMilliseconds() >= (sf::Int32) limits.moveTime
+	) {
+		stopRequested = true;
+	}
+
+	return stopRequested;
+}
+
+/**
+ * Evaluate the material balance for the root team
+ */
+int Search::evaluate(const Position& position) const {
+	int score = 0;
+	const std::vector<Position::Team>& teams = position.getTeams();
+	for (std::vector<Position::Team>::const_iterator i = teams.begin(); i != teams.end(); ++i) {
+		score += ((i->teamIndex == rootTeam) ? (1) : (-1)) * PIECE_VALUE * (int) i->numPieces;
+	}
+
+	return score;
+}
+
+/**
+ * Order the moves so that captures are searched first
+ */
+void Search::orderMoves(const Position& position, std::vector<Position::Move>& moves) const {
+	const unsigned int mover = position.getCurTurn();
+	std::stable_partition(moves.begin(), moves.end(), [&](const Position::Move& move){
+		const int target = (move.piece < 0) ? (-1) : (position.getPiece(move.to));
+		return target >= 0 && position.getPieces()[target].team != mover;
+	});
+}
+
+/**
+ * Describe a line of moves from the root by their positions
+ */
+std::vector<Search::Step> Search::getSteps(const std::vector<Position::Move>& moves) const {
+	std::vector<Step> steps;
+	Position position = root;
+	Position::Undo undo;
+
+	for (std::vector<Position::Move>::const_iterator i = moves.begin(); i != moves.end(); ++i) {
+		if (i->piece < 0) {
+			steps.push_back(Step{ true, i->to, i->to });
+		} else {
+			steps.push_back(Step{ false, position.getPieces()[i->piece].pos, i->to });
+		}
+
+		position.makeMove(*i, undo);
+	}
+
+	return steps;
+}
+
+/**
+ * Search a position, maximizing for the root team and minimizing for the others
+ */
+int Search::alphaBeta(Position& position, unsigned int depth, unsigned int ply, int alpha, int beta) {
+	pvTable[ply].clear();
+
+	// Check whether the game is over
+	if (position.hasLost(rootTeam)) {
+		return -MATE_SCORE + ply;
+	}
+
+	bool othersLost = true;
+	const std::vector<Position::Team>& teams = position.getTeams();
+	for (std::vector<Position::Team>::const_iterator i = teams.begin(); i != teams.end(); ++i) {
+		if (i->teamIndex != rootTeam && !position.hasLost(i->teamIndex)) {
+			othersLost = false;
+		}
+	}
+
+	if (othersLost) {
+		return MATE_SCORE - ply;
+	}
+
+	if (depth == 0 || ply + 1 >= MAX_DEPTH) {
+		return evaluate(position);
+	}
+
+	std::vector<Position::Move> moves;
+	position.generateMoves(moves);
+	if (moves.empty()) {
+		return 0;
+	}
+
+	orderMoves(position, moves);
+
+	// Search the moves
+	const bool isMaximizing = position.getCurTurn() == rootTeam;
+	int best = isMaximizing ? (-MATE_SCORE - 1) : (MATE_SCORE + 1);
+	Position::Undo undo;
+
+	for (std::vector<Position::Move>::const_iterator i = moves.begin(); i != moves.end(); ++i) {
+		nodes++;
+		position.makeMove(*i, undo);
+		const int score = alphaBeta(position, depth - 1, ply + 1, alpha, beta);
+		position.unmakeMove(undo);
+
+		if (shouldStop()) {
+			return best;
+		}
+
+		// Update the best score and principal variation
+		if (isMaximizing ? (score > best) : (score < best)) {
+			best = score;
+			pvTable[ply].clear();
+			pvTable[ply].push_back(*i);
+			pvTable[ply].insert(pvTable[ply].end(), pvTable[ply + 1].begin(), pvTable[ply + 1].end());
+		}
+
+		if (isMaximizing) {
+			alpha = std::max(alpha, score);
+		} else {
+			beta = std::min(beta, score);
+		}
+
+		if (alpha >= beta) break;
+	}
+
+	return best;
+}
+
+/**
+ * Deepen the search until it is stopped or reaches its limits
+ */
+void Search::run(InfoCallback onInfo, BestMoveCallback onBestMove) {
+	std::vector<Position::Move> moves;
+	root.generateMoves(moves);
+	orderMoves(root, moves);
+
+	bool found = !moves.empty();
+	Position::Move bestMove = found ? (moves[0]) : (Position::Move{ -1, sf::Vector2i() });
+	const unsigned int maxDepth = (limits.depth == 0 || limits.depth > MAX_DEPTH - 1) ? (MAX_DEPTH - 1) : (limits.depth);
+
+	for (unsigned int depth = 1; found && depth <= maxDepth && !shouldStop(); depth++) {
+		Position position = root;
+		Position::Undo undo;
+		int bestScore = -MATE_SCORE - 1;
+		std::vector<Position::Move> pv;
+
+		for (std::vector<Position::Move>::const_iterator i = moves.begin(); i != moves.end(); ++i) {
+			nodes++;
+			position.makeMove(*i, undo);
+			const int score = alphaBeta(position, depth - 1, 1, bestScore, MATE_SCORE + 1);
+			position.unmakeMove(undo);
+
+			if (shouldStop()) break;
+
+			if (score > bestScore) {
+				bestScore = score;
+				pv.clear();
+				pv.push_back(*i);
+				pv.insert(pv.end(), pvTable[1].begin(), pvTable[1].end());
+			}
+		}
+
+		// Only use completed iterations
+		if (shouldStop() || pv.empty()) break;
+
+		bestMove = pv[0];
+
+		// Search the best move first in the next iteration
+		for (std::vector<Position::Move>::iterator i = moves.begin(); i != moves.end(); ++i) {
+			if (i->piece == bestMove.piece && i->to == bestMove.to) {
+				std::rotate(moves.begin(), i, i + 1);
+				break;
+			}
+		}
+
+		const Info info{
+			depth, bestScore, nodes, (unsigned int) timer.getElapsedTime().asMilliseconds(), getSteps(pv)
+		};
+		onInfo(info);
+
+		// Stop once a forced win or loss has been found
+		if (bestScore >= MATE_SCORE - (int) MAX_DEPTH || bestScore <= -MATE_SCORE + (int) MAX_DEPTH) break;
+	}
+
+	std::vector<Position::Move> line(1, bestMove);
+	onBestMove(found, found ? (getSteps(line)[0]) : (Step{ true, sf::Vector2i(), sf::Vector2i() }));
+}
+
+
+
+// Constructors
+
+/**
+ * Constructor
+ */
+Search::Search(const Position& root_) :
+	root{root_},
+	rootTeam{root_.getCurTurn()},
+	stopRequested{false},
+	limits{0, 0},
+	nodes{0},
+	pvTable(MAX_DEPTH + 1)
+{
+}
+
+Search::~Search() {
+	stop();
+}
+
+
+
+// Methods
+
+/**
+ * Start searching on a background thread
+ *
+ * @param onInfo called after each completed iteration
+ * @param onBestMove called once when the search finishes
+ */
+void Search::start(const Limits& limits_, InfoCallback onInfo, BestMoveCallback onBestMove) {
+	stop();
+
+	limits = limits_;
+	stopRequested = false;
+	nodes = 0;
+	timer.restart();
+	thread = std::thread(&Search::run, this, onInfo, onBestMove);
+}
+
+/**
+ * Stop the search and wait for it to report its best move
+ */
+void Search::stop() {
+	stopRequested = true;
+	if (thread.joinable()) {
+		thread.join();
+	}
+}
@@ -0,0 +1,85 @@
+#ifndef CHESS_SEARCH_H
+#define CHESS_SEARCH_H
+
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "position.h"
+
+// Class declaration
+
+/**
+ * Iterative deepening alpha-beta search on a background thread. Scores are from the point of view of the team
+ * whose turn it is at the root, with every other team trying to minimize them.
+ */
+class Search {
+public:
+	// Helper structs
+
+	/**
+	 * A move described by its positions, which stays meaningful after the board changes
+	 */
+	struct Step {
+		bool isPass;
+		sf::Vector2i from;
+		sf::Vector2i to;
+	};
+
+	struct Limits {
+		unsigned int depth;
+		unsigned int moveTime;
+	};
+
+	struct Info {
+		unsigned int depth;
+		int score;
+		unsigned long long nodes;
+		unsigned int time;
+		std::vector<Step> pv;
+	};
+
+	typedef std::function<void(const Info&)> InfoCallback;
+	typedef std::function<void(bool, const Step&)> BestMoveCallback;
+
+	// Constants
+	static const int MATE_SCORE = 1000000;
+	static const unsigned int MAX_DEPTH = 64;
+
+private:
+	// Constants
+	static const int PIECE_VALUE = 100;
+	static const unsigned int CHECK_INTERVAL = 1024;
+
+	// Members
+	Position root;
+	const unsigned int rootTeam;
+
+	std::thread thread;
+	std::atomic<bool> stopRequested;
+
+	Limits limits;
+	sf::Clock timer;
+	unsigned long long nodes;
+	std::vector<std::vector<Position::Move>> pvTable;
+
+	// Helpers
+	bool shouldStop();
+	int evaluate(const Position& position) const;
+	void orderMoves(const Position& position, std::vector<Position::Move>& moves) const;
+	std::vector<Step> getSteps(const std::vector<Position::Move>& moves) const;
+	int alphaBeta(Position& position, unsigned int depth, unsigned int ply, int alpha, int beta);
+	void run(InfoCallback onInfo, BestMoveCallback onBestMove);
+
+public:
+	// Constructors
+	Search(const Position& root_);
+	~Search();
+
+	// Methods
+	void start(const Limits& limits_, InfoCallback onInfo, BestMoveCallback onBestMove);
+	void stop();
+};
+
+#endif // CHESS_SEARCH_H
@@ -1,10 +1,16 @@
 #include "game.h"
 
+#include <iomanip>
 #include <iostream>
+#include <thread>
+#include "io/binaryBoard.h"
 #include "io/boardLoader.h"
+#include "io/journal.h"
 #include "io/pieceDefLoader.h"
 #include "io/resourceLoader.h"
+#include "utils/metrics.h"
 #include "utils/stringUtils.h"
+#include "utils/trace.h"
 #include "ui/windowLayer.h"
 #include "ui/button.h"
 
@@ -13,7 +19,17 @@
 /**
  * Constructor
  */
-Game::Game() {
+Game::Game() :
+	pieceDefs{nullptr},
+	textures{nullptr},
+	uiTextures{nullptr},
+	teams{nullptr},
+	traceFileName{"trace.json"},
+	measuring{false},
+	renderThread{false},
+	running{false},
+	generationMargin{0}
+{
 	const unsigned int WIDTH  = sf::VideoMode::getDesktopMode().width * 3. / 4.;
 	const unsigned int HEIGHT = sf::VideoMode::getDesktopMode().height * 3. / 4.;
 
@@ -27,6 +43,32 @@ Game::Game() {
 	inputHandler   = new InputHandler(this, window, renderer);
 	pieceTracker   = new PieceTracker(this);
 	controller     = new Controller(this, pieceTracker);
+	journal        = nullptr;
+}
+
+/**
+ * Constructor for running without a window. Move markers are generated within a margin around the pieces instead
+ * of the screen.
+ *
+ * @param generationMargin_ the number of tiles around the pieces' bounding box in which to generate move markers
+ */
+Game::Game(unsigned int generationMargin_) :
+	window{nullptr},
+	renderer{nullptr},
+	inputHandler{nullptr},
+	pieceDefs{nullptr},
+	textures{nullptr},
+	uiTextures{nullptr},
+	teams{nullptr},
+	traceFileName{"trace.json"},
+	measuring{false},
+	renderThread{false},
+	running{false},
+	generationMargin{generationMargin_}
+{
+	pieceTracker   = new PieceTracker(this);
+	controller     = new Controller(this, pieceTracker);
+	journal        = nullptr;
 }
 
 /**
@@ -38,12 +80,14 @@ Game::~Game() {
 	delete inputHandler;
 	delete renderer;
 	delete window;
+	delete journal;
 
 	controller     = nullptr;
 	pieceTracker   = nullptr;
 	inputHandler   = nullptr;
 	renderer       = nullptr;
 	window         = nullptr;
+	journal        = nullptr;
 }
 
 
@@ -73,7 +117,7 @@ void Game::run() {
 		menuLayer->addClickable(button);
 		button = new Button(0, 50, 80, 40, "Save", "button", [&, this]{ saveBoard("saves/output.chess"); });
 		menuLayer->addClickable(button);
-		button = new Button(0, 100, 80, 40, "Exit", "button", [&, this]{ window->close(); });
+		button = new Button(0, 100, 80, 40, "Exit", "button", [&, this]{ quit(); });
 		menuLayer->addClickable(button);
 		uiTextures = ResourceLoader::loadTextures(uiTextureNames, "res/textures/ui/", ".png");
 
@@ -93,26 +137,127 @@ void Game::run() {
         return;
 	}
 
+	sf::Clock runTimer;
 	sf::Clock timer;
 	sf::Time delay = sf::seconds(0.01f);
+	unsigned int numTicks = 0;
 
-	// Run the main game loop
-	while (window->isOpen()) {
-		// Wait until the tick has passed
-		if (timer.getElapsedTime() < delay) continue;
+	// Draw the frames that the game loop prepares on a thread of their own, so that drawing never holds up input
+	std::thread renderLoop;
+	if (renderThread) {
+		window->setActive(false);
+		renderLoop = std::thread([this]{
+			window->setActive(true);
+			while (renderer->waitForFrame()) {
+				renderer->presentFrame();
+			}
 
-		// Schedule the next tick
+			window->setActive(false);
+		});
+	}
+
+	// Run the main game loop
+	running = true;
+	while (running && window->isOpen()) {
 		timer.restart();
+		numTicks++;
 
 		// Perform actions for the tick
-		inputHandler->tick();
-		renderer->draw();
+		{
+			Trace::Span span("tick");
+			inputHandler->tick();
+			renderer->onSimulated(timer.getElapsedTime().asMicroseconds() / 1000.f);
+			if (renderThread) {
+				renderer->prepareFrame();
+			} else {
+				renderer->draw();
+			}
+		}
+
+		// Sleep until there is input if nothing is changing, otherwise until the next tick
+		Metrics::Timer waitTimer(Metrics::WAIT);
+		if (!renderer->needsRedraw && !inputHandler->isMovingCamera()) {
+			inputHandler->waitForEvent();
+		} else if (timer.getElapsedTime() < delay) {
+			sf::sleep(delay - timer.getElapsedTime());
+		}
 	}
+
+	// Stop drawing before the window is closed
+	if (renderThread) {
+		renderer->stopPresenting();
+		renderLoop.join();
+		window->setActive(true);
+	}
+
+	window->close();
+
+	// Report how busy the game loop was and how quickly input reached the screen
+	if (measuring) {
+		const float seconds = runTimer.getElapsedTime().asSeconds();
+		const float waitSeconds = Metrics::read(Metrics::WAIT).totalNanos / 1e9f;
+		const Metrics::Histogram latency = Metrics::read(Metrics::INPUT_LATENCY);
+		std::cout << std::fixed << std::setprecision(1);
+		std::cout << "Ran for " << seconds << " s with " << numTicks << " ticks, busy for " <<
+			(100 * (seconds - waitSeconds) / seconds) << "% of the time" << std::endl;
+		std::cout << "Input latency: " << latency.count << " inputs, p50 " << (latency.percentile(0.5) / 1e6) <<
+			" ms, p99 " << (latency.percentile(0.99) / 1e6) << " ms, max " << (latency.maxNanos / 1e6) << " ms" <<
+			std::endl;
+	}
+}
+
+/**
+ * Record the game in a journal, starting with the board that is loaded
+ *
+ * @throw ResourceLoader::IOException if the journal cannot be opened
+ */
+void Game::startJournal(std::string fileName) {
+	controller->setJournal(nullptr);
+	delete journal;
+
+	journal = new Journal(fileName);
+	controller->setJournal(journal);
+
+	if (teams != nullptr) {
+		const std::vector<Piece*>* pieces = pieceTracker->getPieces();
+		journal->onLoad(controller->teamsToString(), controller->getCurTurn(), pieces);
+		delete pieces;
+	}
+}
+
+/**
+ * Write the spans recorded so far as Chrome trace event JSON
+ *
+ * @throw ResourceLoader::IOException if the file cannot be opened
+ */
+void Game::saveTrace(std::string fileName) {
+	ResourceLoader::write(fileName, Trace::toJson());
+}
+
+/**
+ * Set the number of threads used to update the move markers when a board is loaded or pieces enter the board
+ */
+void Game::setThreads(unsigned int numThreads) {
+	controller->setThreads(numThreads);
+}
+
+/**
+ * Select a piece as a click on it does, so that its moves are drawn
+ *
+ * @return true if the piece could be selected this turn
+ */
+bool Game::select(sf::Vector2i pos) {
+	return controller->select(pos);
 }
 
 // Event processors
 
 void Game::onCameraChange() {
+	// The move markers are left as they are while zoomed out, and are brought up to date when zooming back in
+	if (renderer != nullptr && renderer->isZoomedOut()) {
+		return;
+	}
+
 	pieceTracker->onCameraChange();
 }
 
@@ -120,27 +265,75 @@ void Game::onGeneration(MoveMarker* marker) {
     controller->onGeneration(marker);
 }
 
+void Game::onDeletion(MoveMarker* marker) {
+    controller->onDeletion(marker);
+}
+
 // Helpers
 void Game::loadBoard(std::string fileName) {
-	std::tuple<
-		std::map<const unsigned int, std::pair<const std::string, sf::Color>>*,
-		unsigned int,
-		std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>*
-	> board = BoardLoader::loadBoard(fileName, pieceDefs);
+	if (ResourceLoader::isValidFileName(fileName, BinaryBoard::getExtension())) {
+		loadBoard(BinaryBoard::loadBoard(fileName, pieceDefs));
+	} else {
+		loadBoard(BoardLoader::loadBoard(fileName, pieceDefs));
+	}
+}
 
-	// Initialize everything
+void Game::loadBoard(std::tuple<
+	std::map<const unsigned int, std::pair<const std::string, sf::Color>>*,
+	unsigned int,
+	std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>*
+> board) {
+	Metrics::Timer timer(Metrics::LOAD_INITIALIZE);
+	teams = std::get<0>(board);
+
+	// Without a window, generate move markers around the pieces
+	if (renderer == nullptr) {
+		std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces = std::get<2>(board);
+		sf::Vector2i min, max;
+		for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::const_iterator i =
+			pieces->begin(); i != pieces->end(); ++i
+		) {
+			if (i == pieces->begin()) {
+				min = max = i->first;
+			} else {
+				min.x = std::min(min.x, i->first.x);
+				min.y = std::min(min.y, i->first.y);
+				max.x = std::max(max.x, i->first.x);
+				max.y = std::max(max.y, i->first.y);
+			}
+		}
 
+		generationBounds = sf::IntRect(
+			min.x - (int) generationMargin, min.y - (int) generationMargin,
+			max.x - min.x + 2 * (int) generationMargin + 1, max.y - min.y + 2 * (int) generationMargin + 1
+		);
+	}
+
+	// Initialize everything
 	pieceTracker->onStartup(pieceDefs, std::get<2>(board));
-	renderer->onStartup(textures, uiTextures, std::get<0>(board));
+	if (renderer != nullptr) {
+		renderer->onStartup(textures, uiTextures, std::get<0>(board));
+	}
 	controller->onStartup(std::get<0>(board), std::get<1>(board));
 }
 
+/**
+ * Save the board, in the binary format if the file has its extension and as text otherwise
+ */
 void Game::saveBoard(std::string fileName) {
-    std::string toWrite = "[" +
+	if (ResourceLoader::isValidFileName(fileName, BinaryBoard::getExtension())) {
+		std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teamMap = controller->getTeams();
+		BinaryBoard::saveBoard(fileName, teamMap, controller->getCurTurn(), pieceTracker->getPieceMap());
+		delete teamMap;
+	} else {
+		ResourceLoader::write(fileName, boardToString());
+	}
+}
+
+std::string Game::boardToString() const {
+	return "[" +
 		controller->teamsToString() + "," +
 		std::to_string(controller->getCurTurn()) + "," +
 		pieceTracker->piecesToString() + ",\n" +
 	"]";
-
-	ResourceLoader::write(fileName, toWrite);
 }
@@ -13,6 +13,8 @@ class Renderer;
 class InputHandler;
 class PieceTracker;
 class Controller;
+class EngineProtocol;
+class Journal;
 class ResourceLoader;
 
 
@@ -26,32 +28,80 @@ private:
 	InputHandler*     inputHandler;
 	PieceTracker*     pieceTracker;
 	Controller*       controller;
+	Journal*          journal;
 
 	std::map<std::string, const PieceDef*>* pieceDefs;
 	std::map<std::string, sf::Texture*>* textures;
 	std::map<std::string, sf::Texture*>* uiTextures;
+	std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams;
+
+	// The file that the trace is written to when the trace key is pressed
+	std::string traceFileName;
+
+	// Whether to report how busy the game loop was and the input latency when the window closes
+	bool measuring;
+
+	// Whether frames are drawn on a thread of their own, and whether the game is still running
+	bool renderThread;
+	bool running;
+
+	// Headless members
+	const unsigned int generationMargin;
+	sf::IntRect generationBounds;
 
 	// Friends
 	friend Renderer;
 	friend InputHandler;
 	friend Controller;
 	friend PieceTracker;
+	friend EngineProtocol;
 
 	// Helpers
 	void loadBoard(std::string fileName);
+	void loadBoard(std::tuple<
+		std::map<const unsigned int, std::pair<const std::string, sf::Color>>*,
+		unsigned int,
+		std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>*
+	> board);
 	void saveBoard(std::string fileName);
+	std::string boardToString() const;
 
 public:
 	// Constructors
 	Game();
+	Game(unsigned int generationMargin_);
 	~Game();
 
 	// Methods
 	void run();
+	void startJournal(std::string fileName);
+	void saveTrace(std::string fileName);
+	void setThreads(unsigned int numThreads);
+	bool select(sf::Vector2i pos);
+
+	/**
+	 * Use the given piece definitions for the boards loaded after this instead of res/pieces.def. The game takes
+	 * ownership of them.
+	 */
+	inline void setPieceDefs(std::map<std::string, const PieceDef*>* pieceDefs_) { pieceDefs = pieceDefs_; }
+	inline void setTraceFile(std::string fileName) { traceFileName = fileName; }
+	inline void setMeasuring(bool measuring_) { measuring = measuring_; }
+	inline void setRenderThread(bool renderThread_) { renderThread = renderThread_; }
+
+	/**
+	 * Stop the game loop, which closes the window once the last frame has been drawn
+	 */
+	inline void quit() { running = false; }
+
+	/**
+	 * Get the piece at a position, or nullptr if there is none
+	 */
+	inline const Piece* getPiece(sf::Vector2i pos) const { return pieceTracker->getPiece(pos); }
 
 	// Event handlers
 	void onCameraChange();
 	void onGeneration(MoveMarker* marker);
+	void onDeletion(MoveMarker* marker);
 };
 
 #endif // CHESS_GAME_H
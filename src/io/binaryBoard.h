@@ -0,0 +1,385 @@
+#ifndef CHESS_BINARY_BOARD_H
+#define CHESS_BINARY_BOARD_H
+
+#include <SFML/Graphics.hpp>
+#include <climits>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "mappedFile.h"
+#include "resourceLoader.h"
+#include "../components/piece.h"
+#include "../components/pieceDef.h"
+#include "../utils/metrics.h"
+#include "../utils/vectorUtils.h"
+
+// Class declaration
+
+/**
+ * Reads and writes boards in a compact binary format, which holds everything in the text format and is converted to
+ * and from it without loss. Every integer is a varint, with signed integers zigzag encoded first:
+ *
+ *   magic "ICBB", version
+ *   current turn
+ *   team count, then for each team: index, name length and name, red, green, blue and alpha bytes
+ *   piece definition name count, then each name length and name
+ *   piece count, then for each piece: name table index, team * 4 + direction, x and y as signed deltas from the
+ *   previous piece, move count, last move (signed)
+ *
+ * The pieces are written in the order of the board, by x and then by y, so the deltas are small on dense boards and
+ * the pieces can be added to the board in order.
+ */
+class BinaryBoard {
+public:
+	// Constants
+	static const unsigned int VERSION = 1;
+
+	/**
+	 * The extension of binary boards, which is how the game tells them from text boards
+	 */
+	static const std::string& getExtension() {
+		static const std::string EXTENSION = ".chessb";
+		return EXTENSION;
+	}
+
+private:
+	// Constants
+	static const unsigned int MAGIC_LENGTH = 4;
+
+	inline static const char* getMagic() {
+		return "ICBB";
+	}
+
+	// Helper classes
+
+	/**
+	 * Reads the integers and strings of a binary board from a buffer
+	 */
+	class Reader {
+	private:
+		const unsigned char* pos;
+		const unsigned char* const end;
+
+	public:
+		inline Reader(const char* begin_, const char* end_) :
+			pos{reinterpret_cast<const unsigned char*>(begin_)},
+			end{reinterpret_cast<const unsigned char*>(end_)}
+		{
+		}
+
+		inline std::uint8_t readByte() {
+			if (pos == end) {
+				throw ResourceLoader::FileFormatException("Unexpected end of binary board");
+			}
+
+			return *pos++;
+		}
+
+		inline std::uint64_t readVarint() {
+			std::uint64_t value = 0;
+			for (unsigned int shift = 0; shift < 64; shift += 7) {
+				const std::uint8_t byte = readByte();
+				value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+				if ((byte & 0x80) == 0) {
+					return value;
+				}
+			}
+
+			throw ResourceLoader::FileFormatException("Invalid integer in binary board");
+		}
+
+		inline std::int64_t readSigned() {
+			const std::uint64_t value = readVarint();
+			return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+		}
+
+		inline std::string readString() {
+			const std::uint64_t length = readVarint();
+			if (length > static_cast<std::uint64_t>(end - pos)) {
+				throw ResourceLoader::FileFormatException("Unexpected end of binary board");
+			}
+
+			const std::string s(reinterpret_cast<const char*>(pos), length);
+			pos += length;
+			return s;
+		}
+
+		inline bool atEnd() const {
+			return pos == end;
+		}
+	};
+
+	// Helpers
+
+	inline static void writeVarint(std::string& bytes, std::uint64_t value) {
+		while (value >= 0x80) {
+			bytes += static_cast<char>((value & 0x7f) | 0x80);
+			value >>= 7;
+		}
+
+		bytes += static_cast<char>(value);
+	}
+
+	inline static void writeSigned(std::string& bytes, std::int64_t value) {
+		writeVarint(bytes, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+	}
+
+	inline static void writeString(std::string& bytes, const std::string& s) {
+		writeVarint(bytes, s.length());
+		bytes += s;
+	}
+
+	/**
+	 * Check that a value read from a binary board fits in an int
+	 */
+	inline static int toInt(std::int64_t value) {
+		if (value < INT_MIN || value > INT_MAX) {
+			throw ResourceLoader::FileFormatException("Integer out of range in binary board");
+		}
+
+		return static_cast<int>(value);
+	}
+
+	/**
+	 * Check that a value read from a binary board fits in an unsigned int
+	 */
+	inline static unsigned int toUnsigned(std::uint64_t value) {
+		if (value > UINT_MAX) {
+			throw ResourceLoader::FileFormatException("Integer out of range in binary board");
+		}
+
+		return static_cast<unsigned int>(value);
+	}
+
+	/**
+	 * Move a coordinate by a delta read from a binary board, checking that the result fits in an int before adding
+	 */
+	inline static int addDelta(int coordinate, std::int64_t delta) {
+		if (delta < static_cast<std::int64_t>(INT_MIN) - coordinate ||
+			delta > static_cast<std::int64_t>(INT_MAX) - coordinate
+		) {
+			throw ResourceLoader::FileFormatException("Coordinate out of range in binary board");
+		}
+
+		return coordinate + static_cast<int>(delta);
+	}
+
+public:
+	// Methods
+
+	/**
+	 * Write a board in the binary format
+	 *
+	 * @return the bytes of the board
+	 */
+	inline static std::string toBytes(
+		const std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams,
+		unsigned int curTurn,
+		const std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces
+	) {
+		std::string bytes(getMagic(), MAGIC_LENGTH);
+		writeVarint(bytes, VERSION);
+		writeVarint(bytes, curTurn);
+
+		// Write the teams
+		writeVarint(bytes, teams->size());
+		for (std::map<const unsigned int, std::pair<const std::string, sf::Color>>::const_iterator i = teams->begin();
+			i != teams->end(); ++i
+		) {
+			writeVarint(bytes, i->first);
+			writeString(bytes, i->second.first);
+			bytes += static_cast<char>(i->second.second.r);
+			bytes += static_cast<char>(i->second.second.g);
+			bytes += static_cast<char>(i->second.second.b);
+			bytes += static_cast<char>(i->second.second.a);
+		}
+
+		// Number the piece definitions that are used, in the order that they are first used
+		std::map<const PieceDef*, unsigned int> defIndices;
+		std::vector<const PieceDef*> defs;
+		for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::const_iterator i =
+			pieces->begin(); i != pieces->end(); ++i
+		) {
+			if (defIndices.insert(std::make_pair(i->second->getDef(), defs.size())).second) {
+				defs.push_back(i->second->getDef());
+			}
+		}
+
+		writeVarint(bytes, defs.size());
+		for (std::vector<const PieceDef*>::const_iterator i = defs.begin(); i != defs.end(); ++i) {
+			writeString(bytes, (*i)->name);
+		}
+
+		// Write the pieces
+		writeVarint(bytes, pieces->size());
+		sf::Vector2i prevPos;
+		for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::const_iterator i =
+			pieces->begin(); i != pieces->end(); ++i
+		) {
+			const Piece* piece = i->second;
+			writeVarint(bytes, defIndices.find(piece->getDef())->second);
+			writeVarint(bytes, static_cast<std::uint64_t>(piece->getTeam()) * 4 + piece->getDir());
+			writeSigned(bytes, static_cast<std::int64_t>(i->first.x) - prevPos.x);
+			writeSigned(bytes, static_cast<std::int64_t>(i->first.y) - prevPos.y);
+			writeVarint(bytes, piece->getMoveCount());
+			writeSigned(bytes, piece->getLastMove());
+			prevPos = i->first;
+		}
+
+		return bytes;
+	}
+
+	/**
+	 * Read a board in the binary format from a buffer
+	 *
+	 * @throw ResourceLoader::FileFormatException if the buffer does not hold a valid board, or the board uses a piece
+	 *        definition or team that does not exist
+	 */
+	inline static std::tuple<
+		std::map<const unsigned int, std::pair<const std::string, sf::Color>>*,
+		unsigned int,
+		std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>*
+	> fromBytes(const char* data, std::size_t size, const std::map<std::string, const PieceDef*>* pieceDefs) {
+		Metrics::Timer timer(Metrics::LOAD_BOARD);
+		if (size < MAGIC_LENGTH || std::string(data, MAGIC_LENGTH) != getMagic()) {
+			throw ResourceLoader::FileFormatException("Not a binary board");
+		}
+
+		Reader reader(data + MAGIC_LENGTH, data + size);
+		const std::uint64_t version = reader.readVarint();
+		if (version != VERSION) {
+			throw ResourceLoader::FileFormatException(
+				"Unsupported binary board version " + std::to_string(version)
+			);
+		}
+
+		const unsigned int curTurn = toUnsigned(reader.readVarint());
+
+		// Read the teams
+		std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams =
+			new std::map<const unsigned int, std::pair<const std::string, sf::Color>>();
+		std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces =
+			new std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>();
+
+		try {
+			for (std::uint64_t numTeams = reader.readVarint(); numTeams > 0; numTeams--) {
+				const unsigned int index = toUnsigned(reader.readVarint());
+				const std::string name = reader.readString();
+				const std::uint8_t r = reader.readByte();
+				const std::uint8_t g = reader.readByte();
+				const std::uint8_t b = reader.readByte();
+				const std::uint8_t a = reader.readByte();
+
+				// Check whether a team already exists with the desired index
+				if (!teams->insert(std::make_pair(index, std::make_pair(name, sf::Color(r, g, b, a)))).second) {
+					throw ResourceLoader::FileFormatException("Duplicate team index for " + std::to_string(index));
+				}
+			}
+
+			// Find the piece definitions, so that each piece is looked up by its index
+			std::vector<const PieceDef*> defs;
+			for (std::uint64_t numDefs = reader.readVarint(); numDefs > 0; numDefs--) {
+				const std::string name = reader.readString();
+				std::map<std::string, const PieceDef*>::const_iterator defIter = pieceDefs->find(name);
+				if (defIter == pieceDefs->end()) {
+					throw ResourceLoader::FileFormatException("Could not find definition for " + name);
+				}
+
+				defs.push_back(defIter->second);
+			}
+
+			// Read the pieces, which are in the order of the board so each one is added at the end
+			sf::Vector2i pos;
+			for (std::uint64_t numPieces = reader.readVarint(); numPieces > 0; numPieces--) {
+				const std::uint64_t defIndex = reader.readVarint();
+				const std::uint64_t teamAndDir = reader.readVarint();
+				pos.x = addDelta(pos.x, reader.readSigned());
+				pos.y = addDelta(pos.y, reader.readSigned());
+				const unsigned int moveCount = toUnsigned(reader.readVarint());
+				const int lastMove = toInt(reader.readSigned());
+
+				if (defIndex >= defs.size()) {
+					throw ResourceLoader::FileFormatException("Invalid piece definition index in binary board");
+				}
+
+				const unsigned int teamIndex = toUnsigned(teamAndDir / 4);
+				if (teams->find(teamIndex) == teams->end()) {
+					throw ResourceLoader::FileFormatException(
+						"Could not find a team with the index " + std::to_string(teamIndex)
+					);
+				}
+
+				const std::size_t numBefore = pieces->size();
+				std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::iterator inserted =
+					pieces->insert(pieces->end(), std::make_pair(pos, nullptr));
+				if (pieces->size() == numBefore) {
+					throw ResourceLoader::FileFormatException(
+						"Duplicate piece definition for " + VectorUtils::toString(pos)
+					);
+				}
+
+				inserted->second = new Piece(
+					defs[defIndex], teamIndex, pos, (PieceDef::Direction) (teamAndDir % 4), moveCount, lastMove
+				);
+			}
+
+			if (!reader.atEnd()) {
+				throw ResourceLoader::FileFormatException("Unexpected data after binary board");
+			}
+		} catch (...) {
+			for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::iterator i =
+				pieces->begin(); i != pieces->end(); ++i
+			) {
+				delete i->second;
+			}
+			delete pieces;
+			delete teams;
+			throw;
+		}
+
+		return std::make_tuple(teams, curTurn, pieces);
+	}
+
+	/**
+	 * Load a binary board from file, reading it in place from a mapping of the file
+	 */
+	inline static std::tuple<
+		std::map<const unsigned int, std::pair<const std::string, sf::Color>>*,
+		unsigned int,
+		std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>*
+	> loadBoard(const std::string& fileName, const std::map<std::string, const PieceDef*>* pieceDefs) {
+		// Check whether filename is valid
+		if (!ResourceLoader::isValidFileName(fileName, getExtension())) {
+			throw ResourceLoader::FileFormatException("Invalid file name");
+		}
+
+		const MappedFile file(fileName);
+		return fromBytes(file.getData(), file.getSize(), pieceDefs);
+	}
+
+	/**
+	 * Save a board to file in the binary format
+	 */
+	inline static void saveBoard(
+		const std::string& fileName,
+		const std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams,
+		unsigned int curTurn,
+		const std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces
+	) {
+		const std::string bytes = toBytes(teams, curTurn, pieces);
+		std::ofstream file(fileName, std::ios::out | std::ios::binary);
+
+		// Check whether the file is open
+		if (!file.is_open()) {
+			throw ResourceLoader::IOException("Unable to open file: " + fileName);
+		}
+
+		file.write(bytes.data(), bytes.length());
+		file.close();
+	}
+};
+
+#endif // CHESS_BINARY_BOARD_H
@@ -2,93 +2,76 @@
 #define CHESS_BOARD_LOADER_H
 
 #include <SFML/Graphics.hpp>
+#include "mappedFile.h"
+#include "parser.h"
+#include "resourceLoader.h"
 #include "../components/piece.h"
-#include "../utils/stringUtils.h"
+#include "../utils/metrics.h"
 #include "../utils/vectorUtils.h"
 
 // Class declaration
 class BoardLoader {
 private:
-	// Constants
-	static const unsigned int COLOR_NUM_ARGS = 4;
-	static const unsigned int BOARD_NUM_ARGS = 3;
-	static const unsigned int PIECE_NUM_ARGS = 6;
-
     // Object generation methods
 
     /**
-     * Create a color from a string
+     * Read a color, written as [r,g,b,a,]
      */
-    inline static sf::Color getColorFromString(const std::string& colorString) {
-		// Validate input
-		ResourceLoader::checkBracketEnclosed(colorString);
-        ResourceLoader::checkNumArgs(colorString.substr(1, colorString.length() - 2), COLOR_NUM_ARGS);
-
-		unsigned int argIndex = 0;
-		std::vector<std::string>* args = StringUtils::getList(
-			colorString.substr(1, colorString.length() - 2),
-			ResourceLoader::SEPARATOR, ResourceLoader::BRACKET_OPEN, ResourceLoader::BRACKET_CLOSE
-		);
-
-		const unsigned int R = std::stoi((*args)[argIndex++]);
-		const unsigned int G = std::stoi((*args)[argIndex++]);
-		const unsigned int B = std::stoi((*args)[argIndex++]);
-		const unsigned int A = std::stoi((*args)[argIndex++]);
+    inline static sf::Color readColor(Parser& parser) {
+		parser.open();
+		unsigned int components[4];
+		for (unsigned int i = 0; i < 4; i++) {
+			components[i] = parser.readInt();
+			parser.separator();
+		}
+		parser.close();
 
-		// Clean up and return
-		delete args;
-		return sf::Color(R, G, B, A);
+		return sf::Color(components[0], components[1], components[2], components[3]);
     }
 
     /**
-     * Create a team from a string
+     * Read a team, written as [index,name,color,]
      */
-    inline static const std::pair<const unsigned int, std::pair<const std::string, sf::Color>> getTeamFromString (
-		const std::string& teamString
+    inline static const std::pair<const unsigned int, std::pair<const std::string, sf::Color>> readTeam(
+		Parser& parser
 	) {
-		// Validate input
-		ResourceLoader::checkBracketEnclosed(teamString);
-
-		unsigned int argIndex = 0;
-		std::vector<std::string>* args = StringUtils::getList(
-			teamString.substr(1, teamString.length() - 2),
-			ResourceLoader::SEPARATOR, ResourceLoader::BRACKET_OPEN, ResourceLoader::BRACKET_CLOSE
-		);
-
-		const unsigned int index = std::stoi((*args)[argIndex++]);
-        const std::string teamName = (*args)[argIndex++];
-        sf::Color teamColor = getColorFromString((*args)[argIndex++]);
+		parser.open();
+		const unsigned int index = parser.readInt();
+		parser.separator();
+        const std::string teamName = parser.readToken();
+		parser.separator();
+        const sf::Color teamColor = readColor(parser);
+		parser.separator();
+		parser.close();
 
         return std::make_pair(index, std::make_pair(teamName, teamColor));
 	}
 
 	/**
-	 * Create a piece from a string
+	 * Read a piece, written as [name,team,position,direction,move count,last move,]
+	 *
+	 * @param pieceName a string to read the name into, which is reused between pieces so that reading them does not
+	 *                  allocate
 	 */
-	inline static Piece* getPieceFromString(
-		const std::string& pieceString,
+	inline static Piece* readPiece(
+		Parser& parser,
 		const std::map<std::string, const PieceDef*>* pieceDefs,
-		const std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams
+		const std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams,
+		std::string& pieceName
 	) {
-		// Validate input
-		ResourceLoader::checkBracketEnclosed(pieceString);
-		ResourceLoader::checkNumArgs(pieceString.substr(1, pieceString.length() - 2), PIECE_NUM_ARGS);
-
-		unsigned int argIndex = 0;
-		std::vector<std::string>* args = StringUtils::getList(
-			pieceString.substr(1, pieceString.length() - 2),
-			ResourceLoader::SEPARATOR, ResourceLoader::BRACKET_OPEN, ResourceLoader::BRACKET_CLOSE
-		);
+		parser.open();
 
 		// Check whether a piece definition with the desired name exists
-        const std::string pieceName = (*args)[argIndex++];
+		parser.readToken(pieceName);
+		parser.separator();
 		std::map<std::string, const PieceDef*>::const_iterator defIter = pieceDefs->find(pieceName);
 		if (defIter == pieceDefs->end()) {
 			throw ResourceLoader::FileFormatException("Could not find definition for " + pieceName);
 		}
 
 		// Check whether a team with the desired index exists
-		const unsigned int teamIndex = std::stoi((*args)[argIndex++]);
+		const unsigned int teamIndex = parser.readInt();
+		parser.separator();
 		std::map<const unsigned int, std::pair<const std::string, sf::Color>>::const_iterator teamIter =
 			teams->find(teamIndex);
 		if (teamIter == teams->end()) {
@@ -98,13 +81,16 @@ private:
 		}
 
 		// Get other piece properties
-        sf::Vector2i pos = VectorUtils::fromString((*args)[argIndex++]);
-        const unsigned int dir = std::stoi((*args)[argIndex++]) % 4;
-        const unsigned int moveCount = std::stoi((*args)[argIndex++]);
-        const int lastMove = std::stoi((*args)[argIndex++]);
+        const sf::Vector2i pos = parser.readVector();
+		parser.separator();
+        const unsigned int dir = parser.readInt() % 4;
+		parser.separator();
+        const unsigned int moveCount = parser.readInt();
+		parser.separator();
+        const int lastMove = parser.readInt();
+		parser.separator();
+		parser.close();
 
-		// Clean up and return
-		delete args;
 		return new Piece(
 			defIter->second,
 			teamIter->first,
@@ -116,108 +102,120 @@ private:
 	}
 
     /**
-     * Create the teams from a string
+     * Read the list of teams
      */
-	inline static std::map<const unsigned int, std::pair<const std::string, sf::Color>>* getTeamsFromString (
-		const std::string& teamsString
-	) {
-		// Validate input
-		ResourceLoader::checkBracketEnclosed(teamsString);
-
+	inline static std::map<const unsigned int, std::pair<const std::string, sf::Color>>* readTeams(Parser& parser) {
 		std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams =
 			new std::map<const unsigned int, std::pair<const std::string, sf::Color>>();
-		std::vector<std::string>* teamStrings = StringUtils::getList(
-			teamsString.substr(1, teamsString.length() - 2),
-			ResourceLoader::SEPARATOR, ResourceLoader::BRACKET_OPEN, ResourceLoader::BRACKET_CLOSE
-		);
 
-        for (std::vector<std::string>::iterator i = teamStrings->begin(); i != teamStrings->end(); ++i) {
-            std::pair<const unsigned int, std::pair<const std::string, sf::Color>> team =
-				getTeamFromString(*i);
+		try {
+			parser.open();
+			while (!parser.tryClose()) {
+				const std::pair<const unsigned int, std::pair<const std::string, sf::Color>> team = readTeam(parser);
 
-            // Check whether a team already exists with the desired index
-			if (teams->find(team.first) != teams->end()) {
-				throw ResourceLoader::FileFormatException(
-					"Duplicate team index for " + std::to_string(team.first)
-				);
-			}
+				// Check whether a team already exists with the desired index
+				if (!teams->insert(team).second) {
+					throw ResourceLoader::FileFormatException(
+						"Duplicate team index for " + std::to_string(team.first)
+					);
+				}
 
-			// Add the team
-			teams->insert(team);
-        }
+				parser.separator();
+			}
+		} catch (...) {
+			delete teams;
+			throw;
+		}
 
-        // Clean up and return
-        delete teamStrings;
         return teams;
 	}
 
     /**
-     * Create the pieces from a string
+     * Read the list of pieces
      */
-    inline static std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* getPiecesFromString (
-		const std::string& piecesString, const std::map<std::string, const PieceDef*>* pieceDefs,
+    inline static std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* readPieces(
+		Parser& parser, const std::map<std::string, const PieceDef*>* pieceDefs,
 		const std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams
 	) {
-		// Validate input
-		ResourceLoader::checkBracketEnclosed(piecesString);
-
 		std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces =
 			new std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>();
-		std::vector<std::string>* pieceStrings = StringUtils::getList(
-			piecesString.substr(1, piecesString.length() - 2),
-			ResourceLoader::SEPARATOR, ResourceLoader::BRACKET_OPEN, ResourceLoader::BRACKET_CLOSE
-		);
-
-        // Create the pieces
-        for (std::vector<std::string>::iterator i = pieceStrings->begin(); i != pieceStrings->end(); ++i) {
-            Piece* piece = getPieceFromString(*i, pieceDefs, teams);
-
-            // Check whether a piece already exists at the desired location
-			if (pieces->find(piece->getPos()) != pieces->end()) {
-				throw ResourceLoader::FileFormatException(
-					"Duplicate piece definition for " + VectorUtils::toString(piece->getPos())
-				);
+		std::string pieceName;
+
+		try {
+			parser.open();
+			while (!parser.tryClose()) {
+				Piece* piece = readPiece(parser, pieceDefs, teams, pieceName);
+
+				// Check whether a piece already exists at the desired location
+				if (!pieces->insert(std::make_pair(piece->getPos(), piece)).second) {
+					const sf::Vector2i pos = piece->getPos();
+					delete piece;
+					throw ResourceLoader::FileFormatException(
+						"Duplicate piece definition for " + VectorUtils::toString(pos)
+					);
+				}
+
+				parser.separator();
 			}
+		} catch (...) {
+			for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::iterator i =
+				pieces->begin(); i != pieces->end(); ++i
+			) {
+				delete i->second;
+			}
+			delete pieces;
+			throw;
+		}
 
-            // Add the piece
-            pieces->insert(std::make_pair(piece->getPos(), piece));
-        }
-
-        // Clean up and return
-        delete pieceStrings;
         return pieces;
 	}
 
     /**
-	 * Load game board from file
+	 * Read a game board, written as [teams,current turn,pieces,]
 	 */
 	inline static std::tuple<
 		std::map<const unsigned int, std::pair<const std::string, sf::Color>>*,
         unsigned int,
 		std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>*
-	> getBoardFromString(const std::string& boardString, std::map<std::string, const PieceDef*>* pieceDefs) {
-        // Validate input
-		ResourceLoader::checkBracketEnclosed(boardString);
-		ResourceLoader::checkNumArgs(boardString.substr(1, boardString.length() - 2), BOARD_NUM_ARGS);
-
-		const std::vector<std::string>* properties = StringUtils::getList(
-			boardString.substr(1, boardString.length() - 2),
-			ResourceLoader::SEPARATOR, ResourceLoader::BRACKET_OPEN, ResourceLoader::BRACKET_CLOSE
-		);
+	> readBoard(Parser& parser, std::map<std::string, const PieceDef*>* pieceDefs) {
+		Metrics::Timer timer(Metrics::LOAD_BOARD);
 
 		// Get the teams
-		unsigned int propertyIndex = 0;
-		std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams =
-			getTeamsFromString((*properties)[propertyIndex++]);
-
-        // Get the current turn
-        const unsigned int curTurn = std::stoi((*properties)[propertyIndex++]);
-
-        // Get the pieces
-        std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces =
-			getPiecesFromString((*properties)[propertyIndex++], pieceDefs, teams);
+		parser.open();
+		std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams = readTeams(parser);
+
+		try {
+			parser.separator();
+
+			// Get the current turn
+			const unsigned int curTurn = parser.readInt();
+			parser.separator();
+
+			// Get the pieces
+			std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces =
+				readPieces(parser, pieceDefs, teams);
+
+			try {
+				parser.separator();
+				parser.close();
+				if (!parser.atEnd()) {
+					throw parser.error("the end of the board");
+				}
+			} catch (...) {
+				for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::iterator i =
+					pieces->begin(); i != pieces->end(); ++i
+				) {
+					delete i->second;
+				}
+				delete pieces;
+				throw;
+			}
 
-		return std::make_tuple(teams, curTurn, pieces);
+			return std::make_tuple(teams, curTurn, pieces);
+		} catch (...) {
+			delete teams;
+			throw;
+		}
 	}
 
 public:
@@ -235,7 +233,21 @@ public:
 			throw ResourceLoader::FileFormatException("Invalid file name");
 		}
 
-		return getBoardFromString(ResourceLoader::removeWhiteSpace(fileName), pieceDefs);
+		const MappedFile file(fileName);
+		Parser parser(file.getData(), file.getData() + file.getSize());
+		return readBoard(parser, pieceDefs);
+	}
+
+	/**
+	 * Load game board from a string in the same format as the files
+	 */
+	inline static std::tuple<
+		std::map<const unsigned int, std::pair<const std::string, sf::Color>>*,
+        unsigned int,
+		std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>*
+	> loadBoardFromString(const std::string& boardString, std::map<std::string, const PieceDef*>* pieceDefs) {
+		Parser parser(boardString);
+		return readBoard(parser, pieceDefs);
 	}
 };
 
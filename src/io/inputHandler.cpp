@@ -1,6 +1,8 @@
 #include "inputHandler.h"
 
+#include <iostream>
 #include "../ui/windowLayer.h"
+#include "../utils/trace.h"
 
 // Private methods
 
@@ -20,6 +22,7 @@ void InputHandler::checkKeyboard() {
 	if (translationVec.x != 0 || translationVec.y != 0) {
 		renderer->moveCamera(translationVec);
 		game->onCameraChange();
+		renderer->onInput();
 	}
 }
 
@@ -29,51 +32,63 @@ void InputHandler::checkKeyboard() {
 void InputHandler::checkEvents() {
 	sf::Event event;
 	while (window->pollEvent(event)) {
-        // Only process events if the window is focused or the event is critical
-        if (!window->hasFocus() && !isCritical(event.type)) continue;
-
-		switch (event.type) {
-
-		// Check whether the window needs to be closed
-		case sf::Event::Closed:
-			window->close();
-			break;
-
-        // Check whether the window gained focus
-        case sf::Event::GainedFocus:
-            renderer->draw();
-            break;
-
-		// Check whether the dimensions need to be updated
-		case sf::Event::Resized:
-			renderer->onResize(event.size.width, event.size.height);
-			game->onCameraChange();
-			break;
-
-		// Check whether the tile size needs to be updated
-		case sf::Event::MouseWheelScrolled:
-			renderer->onZoom(event.mouseWheelScroll.delta);
-			game->onCameraChange();
-			break;
-
-		// Check whether a key was pressed
-		case sf::Event::KeyPressed:
-			onKeyPress(event.key);
-			break;
-
-		// Check whether the mouse was moved
-		case sf::Event::MouseMoved:
-			renderer->needsRedraw = true;
-			break;
-
-		// Check whether the mouse was clicked
-		case sf::Event::MouseButtonPressed:
-			onMousePress(event.mouseButton);
-            break;
-
-		default:
-			break;
-		}
+		handleEvent(event);
+	}
+}
+
+/**
+ * Handle an event from the window
+ */
+void InputHandler::handleEvent(const sf::Event& event) {
+	// Only process events if the window is focused or the event is critical
+	if (!window->hasFocus() && !isCritical(event.type)) return;
+
+	switch (event.type) {
+
+	// Check whether the window needs to be closed
+	case sf::Event::Closed:
+		game->quit();
+		break;
+
+    // Check whether the window gained focus
+    case sf::Event::GainedFocus:
+        renderer->needsRedraw = true;
+        break;
+
+	// Check whether the dimensions need to be updated
+	case sf::Event::Resized:
+		renderer->onResize(event.size.width, event.size.height);
+		game->onCameraChange();
+		break;
+
+	// Check whether the tile size needs to be updated
+	case sf::Event::MouseWheelScrolled:
+		renderer->onZoom(event.mouseWheelScroll.delta);
+		game->onCameraChange();
+		break;
+
+	// Check whether a key was pressed
+	case sf::Event::KeyPressed:
+		onKeyPress(event.key);
+		break;
+
+	// Check whether the mouse was moved
+	case sf::Event::MouseMoved:
+		renderer->needsRedraw = true;
+		break;
+
+	// Check whether the mouse was clicked
+	case sf::Event::MouseButtonPressed:
+		onMousePress(event.mouseButton);
+        break;
+
+	default:
+		break;
+	}
+
+	// Measure how long the input takes to be drawn
+	if (renderer->needsRedraw) {
+		renderer->onInput();
 	}
 }
 
@@ -85,6 +100,25 @@ void InputHandler::onKeyPress(sf::Event::KeyEvent keyEvent) {
 	if      (keyEvent.code == KEY_DEBUG) renderer->toggleDisplayDebugData();
 	// Toggle the menu
 	else if (keyEvent.code == KEY_MENU) renderer->toggleMenu();
+	// Write the recent spans to the trace file
+	else if (keyEvent.code == KEY_TRACE) saveTrace();
+	// Toggle the performance HUD
+	else if (keyEvent.code == KEY_HUD) renderer->toggleHud();
+	// Take back a move or make it again
+	else if (keyEvent.control && keyEvent.code == KEY_UNDO) game->controller->undo();
+	else if (keyEvent.control && keyEvent.code == KEY_REDO) game->controller->redo();
+}
+
+/**
+ * Write the recent spans to the game's trace file
+ */
+void InputHandler::saveTrace() {
+	try {
+		game->saveTrace(game->traceFileName);
+		std::cout << "Wrote trace to " << game->traceFileName << std::endl;
+	} catch (ResourceLoader::IOException ex) {
+		std::cout << "IOException: " << ex.what() << std::endl;
+	}
 }
 
 /**
@@ -102,7 +136,11 @@ void InputHandler::onMousePress(sf::Event::MouseButtonEvent event) {
 		}
     }
 
-    // Handle the button press on the board
+    // Handle the button press on the board, unless it is zoomed out too far to pick out a tile
+    if (renderer->isZoomedOut()) {
+		return;
+    }
+
     game->controller->onMousePress(renderer->getMouseTilePosition());
 }
 
@@ -150,7 +188,30 @@ InputHandler::~InputHandler() {
 
 // Public methods
 
+/**
+ * Determine whether the camera is being moved with the keyboard, which is polled on every tick rather than sent as
+ * events
+ */
+bool InputHandler::isMovingCamera() const {
+	return window->hasFocus() && (
+		sf::Keyboard::isKeyPressed(KEY_MOVE_UP) || sf::Keyboard::isKeyPressed(KEY_MOVE_DOWN) ||
+		sf::Keyboard::isKeyPressed(KEY_MOVE_LEFT) || sf::Keyboard::isKeyPressed(KEY_MOVE_RIGHT)
+	);
+}
+
+/**
+ * Sleep until the window receives an event, then handle it
+ */
+void InputHandler::waitForEvent() {
+	sf::Event event;
+	if (window->waitEvent(event)) {
+		handleEvent(event);
+	}
+}
+
 void InputHandler::tick() {
+	Trace::Span span("input");
+
 	// Only process keyboard input if the window is focused
 	if (window->hasFocus()) {
         checkKeyboard();
@@ -26,6 +26,12 @@ private:
 	// Options keybinds
 	const sf::Keyboard::Key KEY_DEBUG = sf::Keyboard::Key::F3;
 	const sf::Keyboard::Key KEY_MENU  = sf::Keyboard::Key::Escape;
+	const sf::Keyboard::Key KEY_TRACE = sf::Keyboard::Key::F4;
+	const sf::Keyboard::Key KEY_HUD   = sf::Keyboard::Key::F5;
+
+	// History keybinds, which are pressed with control
+	const sf::Keyboard::Key KEY_UNDO = sf::Keyboard::Key::Z;
+	const sf::Keyboard::Key KEY_REDO = sf::Keyboard::Key::Y;
 
 	// Members
 	Game* game;
@@ -36,7 +42,9 @@ private:
 	// Methods
 	void checkKeyboard();
 	void checkEvents();
+	void handleEvent(const sf::Event& event);
 	void onKeyPress(sf::Event::KeyEvent keyEvent);
+	void saveTrace();
 	bool isCritical(sf::Event::EventType eventType);
 	void onMousePress(sf::Event::MouseButtonEvent event);
 
@@ -50,6 +58,8 @@ public:
         layers.push_back(layer);
 	}
 
+	bool isMovingCamera() const;
+	void waitForEvent();
 	void tick();
 };
 
@@ -0,0 +1,247 @@
+#include "journal.h"
+
+#include "resourceLoader.h"
+#include "../components/event.h"
+#include "../components/piece.h"
+#include "../components/pieceDef.h"
+
+// Constants
+const char Journal::CHECKPOINT;
+const char Journal::EVENT;
+const char Journal::PLY;
+const char Journal::UNDO;
+const std::string Journal::MAGIC = "ICJ2";
+const std::size_t Journal::CHECKPOINT_HEADER_SIZE;
+
+
+
+// Helpers
+
+/**
+ * Append a little-endian 32-bit number to a buffer
+ */
+void Journal::writeUint32(std::vector<char>& buffer, std::uint32_t value) {
+	for (unsigned int i = 0; i < 4; i++) {
+		buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+	}
+}
+
+/**
+ * Read a little-endian 32-bit number
+ */
+std::uint32_t Journal::readUint32(const char* data) {
+	std::uint32_t value = 0;
+	for (unsigned int i = 0; i < 4; i++) {
+		value |= static_cast<std::uint32_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+	}
+
+	return value;
+}
+
+/**
+ * Hand the records for the ply in progress to the writer thread
+ */
+void Journal::submit() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.insert(pending.end(), records.begin(), records.end());
+	}
+
+	records.clear();
+	pendingChanged.notify_one();
+}
+
+/**
+ * Format a checkpoint, writing the board in the same way as the game saves it
+ */
+void Journal::formatCheckpoint(std::vector<char>& buffer, const PendingCheckpoint& checkpoint) {
+	std::string board = "[" + checkpoint.teams + "," + std::to_string(checkpoint.curTurn) + ",[\n";
+	for (std::vector<PieceState>::const_iterator i = checkpoint.pieces.begin(); i != checkpoint.pieces.end(); ++i) {
+		board += "[" +
+			i->def->name + "," +
+			std::to_string(i->team) + "," +
+			"[" + std::to_string(i->x) + "," + std::to_string(i->y) + ",]," +
+			std::to_string(i->dir) + "," +
+			std::to_string(i->moveCount) + "," +
+			std::to_string(i->lastMove) + "," +
+		"],\n";
+	}
+	board += "],\n]";
+
+	buffer.push_back(CHECKPOINT);
+	writeUint32(buffer, checkpoint.ply);
+	writeUint32(buffer, board.size());
+	writeUint32(buffer, checkpoint.pieces.size());
+	buffer.insert(buffer.end(), board.begin(), board.end());
+	for (std::vector<PieceState>::const_iterator i = checkpoint.pieces.begin(); i != checkpoint.pieces.end(); ++i) {
+		writeUint32(buffer, i->id);
+	}
+}
+
+/**
+ * Write the pending records until the journal is destroyed, formatting the checkpoints between them and flushing
+ * after each batch so that a crash loses at most the ply in progress
+ */
+void Journal::run() {
+	std::vector<char> batch;
+	std::vector<PendingCheckpoint> batchCheckpoints;
+	std::vector<char> formatted;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		pendingChanged.wait(lock, [this]{ return stopping || !pending.empty() || !checkpoints.empty(); });
+		if (pending.empty() && checkpoints.empty()) break;
+
+		batch.swap(pending);
+		batchCheckpoints.swap(checkpoints);
+		lock.unlock();
+
+		std::size_t written = 0;
+		for (std::vector<PendingCheckpoint>::const_iterator i = batchCheckpoints.begin();
+			i != batchCheckpoints.end(); ++i
+		) {
+			file.write(batch.data() + written, i->offset - written);
+			written = i->offset;
+
+			formatCheckpoint(formatted, *i);
+			file.write(formatted.data(), formatted.size());
+			formatted.clear();
+		}
+
+		file.write(batch.data() + written, batch.size() - written);
+		file.flush();
+		batch.clear();
+		batchCheckpoints.clear();
+
+		lock.lock();
+	}
+}
+
+
+// Constructors
+
+Journal::Journal(const std::string& fileName) :
+	file{fileName, std::ios::out | std::ios::trunc | std::ios::binary},
+	ply{0},
+	loaded{false},
+	nextId{0},
+	stopping{false}
+{
+	if (!file.is_open()) {
+		throw ResourceLoader::IOException("Unable to open file: " + fileName);
+	}
+
+	records.insert(records.end(), MAGIC.begin(), MAGIC.end());
+	writer = std::thread(&Journal::run, this);
+}
+
+Journal::~Journal() {
+	submit();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+
+	pendingChanged.notify_one();
+	writer.join();
+	file.close();
+}
+
+
+
+// Event handlers
+
+/**
+ * Record an event that has been executed
+ */
+void Journal::onEvent(const Event& event) {
+	std::unordered_map<const Piece*, std::uint32_t>::const_iterator id = pieceIds.find(event.piece);
+	if (id == pieceIds.end()) return;
+
+	records.push_back(EVENT);
+	writeUint32(records, id->second);
+	records.push_back(static_cast<char>(event.action));
+	writeUint32(records, static_cast<std::uint32_t>(event.moveIndex));
+	writeUint32(records, static_cast<std::uint32_t>(event.dest.x));
+	writeUint32(records, static_cast<std::uint32_t>(event.dest.y));
+}
+
+/**
+ * Record the end of a ply
+ *
+ * @return true if a checkpoint is due
+ */
+bool Journal::onPly(unsigned int curTurn, bool moved) {
+	ply++;
+
+	records.push_back(PLY);
+	writeUint32(records, ply);
+	writeUint32(records, curTurn);
+	records.push_back(moved ? 1 : 0);
+	submit();
+
+	return ply % CHECKPOINT_INTERVAL == 0;
+}
+
+/**
+ * Record a board that was loaded, as a new ply
+ */
+void Journal::onLoad(const std::string& teams, unsigned int curTurn, const std::vector<Piece*>* pieces) {
+	// The first board is ply 0
+	if (loaded) {
+		ply++;
+	}
+
+	// The pieces of the new board are numbered from the start
+	loaded = true;
+	pieceIds.clear();
+	nextId = 0;
+	checkpoint(teams, curTurn, pieces);
+}
+
+/**
+ * Record a move being taken back, as a new ply
+ */
+void Journal::onUndo(unsigned int targetPly) {
+	ply++;
+
+	records.push_back(UNDO);
+	writeUint32(records, ply);
+	writeUint32(records, targetPly);
+	submit();
+}
+
+
+
+// Methods
+
+/**
+ * Record the whole board, giving an id to each piece that does not have one yet
+ */
+void Journal::checkpoint(const std::string& teams, unsigned int curTurn, const std::vector<Piece*>* pieces) {
+	// The checkpoint goes after the records before it
+	submit();
+
+	PendingCheckpoint state{0, ply, teams, curTurn, std::vector<PieceState>()};
+	state.pieces.reserve(pieces->size());
+	for (std::vector<Piece*>::const_iterator i = pieces->begin(); i != pieces->end(); ++i) {
+		const std::pair<std::unordered_map<const Piece*, std::uint32_t>::iterator, bool> id =
+			pieceIds.insert(std::make_pair(*i, nextId));
+		if (id.second) {
+			nextId++;
+		}
+
+		state.pieces.push_back(PieceState{
+			id.first->second, (*i)->getDef(), (*i)->getTeam(), (*i)->getPos().x, (*i)->getPos().y,
+			static_cast<int>((*i)->getDir()), (*i)->getMoveCount(), (*i)->getLastMove()
+		});
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		state.offset = pending.size();
+		checkpoints.push_back(std::move(state));
+	}
+
+	pendingChanged.notify_one();
+}
@@ -0,0 +1,174 @@
+#ifndef CHESS_JOURNAL_H
+#define CHESS_JOURNAL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Forward declarations
+class Event;
+class Piece;
+class PieceDef;
+
+
+
+// Class declaration
+
+/**
+ * An append-only binary record of the events executed in a game, written on a background thread.
+ *
+ * The file starts with the four bytes "ICJ2", followed by records that each start with a one byte tag. Numbers are
+ * little-endian.
+ *
+ *     'C' u32 ply, u32 length, u32 count, board, u32 id * count
+ *                                       a checkpoint of the whole board in the save file format, followed by the id
+ *                                       of each piece in the order that the board lists them
+ *     'E' u32 piece, u8 action, i32 move index, i32 x, i32 y
+ *     'P' u32 ply, u32 team, u8 moved   the end of a ply, with the team to move and whether it has moved
+ *     'U' u32 ply, u32 target           a move taken back, as a ply with the same board as an earlier ply
+ *
+ * Pieces are identified by the id that they were given in the first checkpoint that listed them, which they keep
+ * until another board is loaded. The first board is ply 0, and loading another board counts as a ply that is written
+ * as a checkpoint without any events.
+ *
+ * Checkpoints are formatted by the writer thread from a copy of the state of the pieces, so that the game thread
+ * only copies the pieces when one is due.
+ */
+class Journal {
+public:
+	// Constants
+	static const char CHECKPOINT = 'C';
+	static const char EVENT = 'E';
+	static const char PLY = 'P';
+	static const char UNDO = 'U';
+
+	static const std::string MAGIC;
+
+	/**
+	 * The size of a checkpoint record before the board
+	 */
+	static const std::size_t CHECKPOINT_HEADER_SIZE = 13;
+
+	/**
+	 * The number of plies between checkpoints
+	 */
+	static const unsigned int CHECKPOINT_INTERVAL = 64;
+
+	// Helpers
+	static void writeUint32(std::vector<char>& buffer, std::uint32_t value);
+	static std::uint32_t readUint32(const char* data);
+
+private:
+	// Helper structs
+
+	/**
+	 * The state of a piece that is written in a checkpoint
+	 */
+	struct PieceState {
+		std::uint32_t id;
+		const PieceDef* def;
+		unsigned int team;
+		int x;
+		int y;
+		int dir;
+		unsigned int moveCount;
+		int lastMove;
+	};
+
+	/**
+	 * A checkpoint waiting to be formatted, which goes before the pending record at an offset
+	 */
+	struct PendingCheckpoint {
+		std::size_t offset;
+		unsigned int ply;
+		std::string teams;
+		unsigned int curTurn;
+		std::vector<PieceState> pieces;
+	};
+
+	// Members
+	std::ofstream file;
+	unsigned int ply;
+	bool loaded;
+	std::unordered_map<const Piece*, std::uint32_t> pieceIds;
+	std::uint32_t nextId;
+
+	// The records for the ply in progress, which are only touched by the game thread
+	std::vector<char> records;
+
+	// The records waiting to be written by the writer thread
+	std::vector<char> pending;
+	std::vector<PendingCheckpoint> checkpoints;
+	bool stopping;
+	std::mutex mutex;
+	std::condition_variable pendingChanged;
+	std::thread writer;
+
+	// Helpers
+	void submit();
+	void run();
+	static void formatCheckpoint(std::vector<char>& buffer, const PendingCheckpoint& checkpoint);
+
+public:
+	// Constructors
+
+	/**
+	 * Constructor
+	 *
+	 * @throw ResourceLoader::IOException if the file cannot be opened
+	 */
+	Journal(const std::string& fileName);
+	~Journal();
+
+	// Accessors
+	inline unsigned int getPly() const { return ply; }
+
+	// Event handlers
+
+	/**
+	 * Record an event that has been executed
+	 */
+	void onEvent(const Event& event);
+
+	/**
+	 * Record the end of a ply
+	 *
+	 * @return true if a checkpoint is due
+	 */
+	bool onPly(unsigned int curTurn, bool moved);
+
+	/**
+	 * Record a board that was loaded, as a new ply
+	 *
+	 * @param teams   the teams in the save file format, starting from the team to move
+	 * @param curTurn the team to move
+	 * @param pieces  the pieces in the same order as the piece tracker
+	 */
+	void onLoad(const std::string& teams, unsigned int curTurn, const std::vector<Piece*>* pieces);
+
+	/**
+	 * Record a move being taken back, as a new ply
+	 *
+	 * @param targetPly the ply of the board before the move
+	 */
+	void onUndo(unsigned int targetPly);
+
+	// Methods
+
+	/**
+	 * Record the whole board, giving an id to each piece that does not have one yet
+	 *
+	 * @param teams   the teams in the save file format, starting from the team to move
+	 * @param curTurn the team to move
+	 * @param pieces  the pieces in the same order as the piece tracker
+	 */
+	void checkpoint(const std::string& teams, unsigned int curTurn, const std::vector<Piece*>* pieces);
+};
+
+#endif // CHESS_JOURNAL_H
@@ -0,0 +1,96 @@
+#include "mappedFile.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "resourceLoader.h"
+#include "../utils/metrics.h"
+
+// Constructors
+
+/**
+ * Constructor, which maps the whole file. An empty file is not mapped, and has no data.
+ *
+ * @throw ResourceLoader::IOException if the file cannot be opened or mapped
+ */
+MappedFile::MappedFile(const std::string& fileName) :
+	data{nullptr},
+	size{0},
+	file{nullptr},
+	mapping{nullptr}
+{
+	Metrics::Timer timer(Metrics::LOAD_FILE);
+
+#ifdef _WIN32
+	HANDLE fileHandle = CreateFileA(
+		fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+	);
+	LARGE_INTEGER fileSize;
+	if (fileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx(fileHandle, &fileSize)) {
+		if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+		throw ResourceLoader::IOException("Unable to open file: " + fileName);
+	}
+
+	file = fileHandle;
+	size = fileSize.QuadPart;
+	if (size == 0) {
+		return;
+	}
+
+	HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const void* view = (mappingHandle == nullptr) ? (nullptr) : (MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (view == nullptr) {
+		if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		throw ResourceLoader::IOException("Unable to map file: " + fileName);
+	}
+
+	mapping = mappingHandle;
+	data = static_cast<const char*>(view);
+#else
+	const int descriptor = open(fileName.c_str(), O_RDONLY);
+	struct stat status;
+	if (descriptor == -1 || fstat(descriptor, &status) == -1) {
+		if (descriptor != -1) close(descriptor);
+		throw ResourceLoader::IOException("Unable to open file: " + fileName);
+	}
+
+	size = status.st_size;
+	if (size > 0) {
+		void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		if (view == MAP_FAILED) {
+			close(descriptor);
+			throw ResourceLoader::IOException("Unable to map file: " + fileName);
+		}
+
+		data = static_cast<const char*>(view);
+	}
+
+	// The mapping stays valid once the file is closed
+	close(descriptor);
+#endif
+}
+
+/**
+ * Destructor, which unmaps the file
+ */
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+	if (data != nullptr) UnmapViewOfFile(data);
+	if (mapping != nullptr) CloseHandle(mapping);
+	if (file != nullptr) CloseHandle(file);
+#else
+	if (data != nullptr) munmap(const_cast<char*>(data), size);
+#endif
+
+	data = nullptr;
+	mapping = nullptr;
+	file = nullptr;
+}
@@ -0,0 +1,36 @@
+#ifndef CHESS_MAPPED_FILE_H
+#define CHESS_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Class declaration
+
+/**
+ * A file mapped into memory read-only for as long as the object lives, so that it can be read in place without
+ * copying it into a buffer first
+ */
+class MappedFile {
+private:
+	// Members
+	const char* data;
+	std::size_t size;
+
+	// The handles that keep the mapping open, which depend on the platform
+	void* file;
+	void* mapping;
+
+public:
+	// Constructors
+	MappedFile(const std::string& fileName);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Accessors
+	inline const char* getData() const { return data; }
+	inline std::size_t getSize() const { return size; }
+};
+
+#endif // CHESS_MAPPED_FILE_H
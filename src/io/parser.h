@@ -0,0 +1,245 @@
+#ifndef CHESS_PARSER_H
+#define CHESS_PARSER_H
+
+#include <SFML/Graphics.hpp>
+#include <climits>
+#include <string>
+#include "resourceLoader.h"
+
+// Class declaration
+
+/**
+ * Reads the bracketed list format of the save files and piece definitions in one pass over a buffer, without copying
+ * the parts of it. Whitespace and comments are skipped as they are reached, so the buffer can be a file mapped into
+ * memory.
+ *
+ * A list is written as [a,b,c,], with a separator after every element. Its elements are read in order between open()
+ * and close(), or until tryClose() finds the end of a list of any length. The loaders build their objects as they go.
+ */
+class Parser {
+private:
+	// Members
+	const char* const begin;
+	const char* const end;
+	const char* pos;
+
+	// Helpers
+
+	/**
+	 * Skip whitespace and comments, which run to the end of the line
+	 */
+	inline void skip() {
+		while (pos != end) {
+			if (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r') {
+				pos++;
+			} else if (*pos == ResourceLoader::COMMENT_MARKER) {
+				while (pos != end && *pos != '\n') pos++;
+			} else {
+				break;
+			}
+		}
+	}
+
+	/**
+	 * Whether a character ends a token
+	 */
+	inline static bool isDelimiter(const char c) {
+		return c == ResourceLoader::SEPARATOR || c == ResourceLoader::BRACKET_OPEN ||
+			c == ResourceLoader::BRACKET_CLOSE;
+	}
+
+	/**
+	 * Consume a character, or throw if it is not next
+	 */
+	inline void expect(const char c) {
+		skip();
+		if (pos == end || *pos != c) {
+			throw error(std::string("'") + c + "'");
+		}
+
+		pos++;
+	}
+
+public:
+	// Constructors
+
+	/**
+	 * Constructor
+	 *
+	 * @param begin_ the first character to read
+	 * @param end_   one past the last character to read
+	 */
+	inline Parser(const char* begin_, const char* end_) :
+		begin{begin_},
+		end{end_},
+		pos{begin_}
+	{
+	}
+
+	/**
+	 * Constructor for reading a string, which must outlive the parser
+	 */
+	inline Parser(const std::string& s) :
+		Parser(s.data(), s.data() + s.length())
+	{
+	}
+
+	// Accessors
+
+	/**
+	 * Whether everything but whitespace and comments has been read
+	 */
+	inline bool atEnd() {
+		skip();
+		return pos == end;
+	}
+
+	/**
+	 * Create an exception for something that was expected at the current position, with its line and column
+	 */
+	inline ResourceLoader::FileFormatException error(const std::string& expected) const {
+		unsigned int line = 1;
+		const char* lineBegin = begin;
+		for (const char* i = begin; i != pos; ++i) {
+			if (*i == '\n') {
+				line++;
+				lineBegin = i + 1;
+			}
+		}
+
+		return ResourceLoader::FileFormatException(
+			"Expected " + expected + " at line " + std::to_string(line) + ", column " +
+			std::to_string(pos - lineBegin + 1)
+		);
+	}
+
+	// Methods
+
+	/**
+	 * Start reading a list
+	 */
+	inline void open() {
+		expect(ResourceLoader::BRACKET_OPEN);
+	}
+
+	/**
+	 * Finish reading a list, which must have no more elements
+	 */
+	inline void close() {
+		expect(ResourceLoader::BRACKET_CLOSE);
+	}
+
+	/**
+	 * Finish reading a list if it has no more elements
+	 *
+	 * @return true if the list was finished
+	 */
+	inline bool tryClose() {
+		skip();
+		if (pos != end && *pos == ResourceLoader::BRACKET_CLOSE) {
+			pos++;
+			return true;
+		}
+
+		return false;
+	}
+
+	/**
+	 * Read the separator after an element
+	 */
+	inline void separator() {
+		expect(ResourceLoader::SEPARATOR);
+	}
+
+	/**
+	 * Read a token, which is everything up to the next separator or bracket apart from whitespace and comments. The
+	 * token is written to a string that can be reused, so that reading tokens does not allocate.
+	 */
+	inline void readToken(std::string& token) {
+		token.clear();
+		for (skip(); pos != end && !isDelimiter(*pos); skip()) {
+			token += *pos++;
+		}
+
+		if (token.empty()) {
+			throw error("a value");
+		}
+	}
+
+	/**
+	 * Read a token into a new string
+	 */
+	inline std::string readToken() {
+		std::string token;
+		readToken(token);
+		return token;
+	}
+
+	/**
+	 * Read a decimal integer
+	 */
+	inline int readInt() {
+		skip();
+		const bool negative = (pos != end && *pos == '-');
+		if (negative || (pos != end && *pos == '+')) {
+			pos++;
+		}
+
+		long long value = 0;
+		bool hasDigits = false;
+		for (skip(); pos != end && *pos >= '0' && *pos <= '9'; skip()) {
+			value = value * 10 + (*pos++ - '0');
+			hasDigits = true;
+			if (value > (long long) INT_MAX + 1) {
+				throw error("an integer within range");
+			}
+		}
+
+		if (!hasDigits || (pos != end && !isDelimiter(*pos))) {
+			throw error("an integer");
+		}
+
+		if (negative) {
+			value = -value;
+		}
+
+		if (value > INT_MAX) {
+			throw error("an integer within range");
+		}
+
+		return (int) value;
+	}
+
+	/**
+	 * Read a vector, written as [x,y,]
+	 */
+	inline sf::Vector2i readVector() {
+		open();
+		const int x = readInt();
+		separator();
+		const int y = readInt();
+		separator();
+		close();
+		return sf::Vector2i(x, y);
+	}
+
+	/**
+	 * Skip an element, which is either a token or a list
+	 */
+	inline void skipElement() {
+		skip();
+		if (pos != end && *pos == ResourceLoader::BRACKET_OPEN) {
+			open();
+			while (!tryClose()) {
+				skipElement();
+				separator();
+			}
+		} else {
+			while (pos != end && !isDelimiter(*pos)) {
+				pos++;
+			}
+		}
+	}
+};
+
+#endif // CHESS_PARSER_H
@@ -7,194 +7,226 @@
 #include "../components/numRule.h"
 #include "../components/targetingRule.h"
 #include "../components/pieceDef.h"
+#include "mappedFile.h"
+#include "parser.h"
 #include "resourceLoader.h"
+#include "../utils/metrics.h"
 #include "../utils/vectorUtils.h"
 
 // Class declaration
 class PieceDefLoader {
 private:
     // Constants
-	static const int NUM_MOVE_ARGS = 8;
-	static const int NUM_TARGETTING_RULE_ARGS = 4;
+	static const unsigned int NUM_MOVE_FLAGS = 4;
+	static const unsigned int NUM_PIECE_FLAGS = 2;
 
 	// Object generation methods
 
-    /**
-	 * Create a targeting rule from a string
+	/**
+	 * Read a string of flags, written as a digit for each flag
 	 *
-	 * @param s the string from which to generate the targeting rule
+	 * @param flags filled with the flags
+	 * @param numFlags the number of flags that are expected
+	 */
+	inline static void readFlags(Parser& parser, bool* flags, const unsigned int numFlags) {
+		const std::string token = parser.readToken();
+		if (token.length() != numFlags) {
+			throw parser.error(std::to_string(numFlags) + " flags");
+		}
+
+		for (unsigned int i = 0; i < numFlags; i++) {
+			flags[i] = token[i] - '0';
+		}
+	}
+
+	/**
+	 * Read a list of number rules
+	 */
+	inline static const std::vector<NumRule*>* readNumRules(Parser& parser) {
+		std::vector<NumRule*>* numRules = new std::vector<NumRule*>();
+		std::string token;
+
+		parser.open();
+		while (!parser.tryClose()) {
+			parser.readToken(token);
+			numRules->push_back(new NumRule(token));
+			parser.separator();
+		}
+
+		return numRules;
+	}
+
+    /**
+	 * Read a targeting rule, written as [offset,target name,data specifiers,actions,]
 	 *
-	 * @return the targeting rule represented by the string
+	 * @return the targeting rule
 	 */
-	inline static const TargetingRule* getTargetingRuleFromString(const std::string& targetingRulesString) {
-		// Validate input
-		ResourceLoader::checkBracketEnclosed(targetingRulesString);
-		ResourceLoader::checkNumArgs(targetingRulesString.substr(1, targetingRulesString.length() - 2), NUM_TARGETTING_RULE_ARGS);
-
-		// Get all arguments
-		const std::vector<std::string>* args = StringUtils::getList(
-			targetingRulesString.substr(1, targetingRulesString.length() - 2),
-			ResourceLoader::SEPARATOR, ResourceLoader::BRACKET_OPEN, ResourceLoader::BRACKET_CLOSE
-		);
-		unsigned int argIndex = 0;
+	inline static const TargetingRule* readTargetingRule(Parser& parser) {
+		parser.open();
 
 		// Get properties
-		const sf::Vector2i offsetVector = VectorUtils::fromString((*args)[argIndex++]);
-		const std::string targetName = (*args)[argIndex++];
-
-		// Get data specifiers
-		const std::vector<std::pair<std::string, const NumRule*>>* dataSpecifierList = ResourceLoader::getListFromString(
-			(*args)[argIndex++],
-			(std::pair<std::string, const NumRule*>(*)(const std::string& s)) [](auto s){
-				// Validate input
-				ResourceLoader::checkBracketEnclosed(s);
-				ResourceLoader::checkNumArgs(s.substr(1, s.length() - 2), 2);
-
-				// Generate pair
-				const std::vector<std::string>* dataSpecArgs = StringUtils::getList(
-					s.substr(1, s.length() - 2),
-					ResourceLoader::SEPARATOR, ResourceLoader::BRACKET_OPEN, ResourceLoader::BRACKET_CLOSE
-				);
-				std::pair<std::string, const NumRule*> result =
-					std::make_pair((*dataSpecArgs)[0], new NumRule((*dataSpecArgs)[1]));
-
-				// Clean up and return
-				delete dataSpecArgs;
-				return result;
-			}
-		);
+		const sf::Vector2i offsetVector = parser.readVector();
+		parser.separator();
+		const std::string targetName = parser.readToken();
+		parser.separator();
 
-		// Create map from vector
+		// Get data specifiers, each written as [name,rule,]
 		std::map<std::string, const NumRule*>* dataSpecifiers = new std::map<std::string, const NumRule*>();
-		for (
-			std::vector<std::pair<std::string, const NumRule*>>::const_iterator i = dataSpecifierList->begin();
-			i != dataSpecifierList->end(); ++i
-		) {
-			dataSpecifiers->insert(*i);
+		parser.open();
+		while (!parser.tryClose()) {
+			parser.open();
+			const std::string name = parser.readToken();
+			parser.separator();
+			const NumRule* numRule = new NumRule(parser.readToken());
+			parser.separator();
+			parser.close();
+
+			dataSpecifiers->insert(std::make_pair(name, numRule));
+			parser.separator();
 		}
+		parser.separator();
+
+		// Get actions to perform, each written as [action,argument,], compiled to events with the offset of a move
+		// stored as the destination
+		std::vector<Event>* actions = new std::vector<Event>();
+		std::string actionName;
+		parser.open();
+		while (!parser.tryClose()) {
+			parser.open();
+			parser.readToken(actionName);
+			parser.separator();
 
-		// Get action to perform
-		std::vector<Event*>* actions = ResourceLoader::getListFromString(
-			(*args)[argIndex++],
-			(Event*(*)(const std::string& s)) [](auto s){
-				// Validate input
-				ResourceLoader::checkBracketEnclosed(s);
-				ResourceLoader::checkNumArgs(s.substr(1, s.length() - 2), 2);
-
-				// Generate event
-				const std::vector<std::string>* eventArgs = StringUtils::getList(
-					s.substr(1, s.length() - 2),
-					ResourceLoader::SEPARATOR, ResourceLoader::BRACKET_OPEN, ResourceLoader::BRACKET_CLOSE
-				);
-				Event* result =	new Event(nullptr, (*eventArgs)[0], (*eventArgs)[1]);
-
-				// Clean up and return
-				delete eventArgs;
-				return result;
+			Event::Action action;
+			if (!Event::actionFromString(actionName, action)) {
+				throw ResourceLoader::FileFormatException("Invalid action: " + actionName);
 			}
-		);
 
-		// Create targeting rule
-		TargetingRule* targetingRule = new TargetingRule(offsetVector, targetName, dataSpecifiers, actions);
+			Event result(nullptr, action);
+			if (action == Event::MOVE) {
+				result.dest = parser.readVector();
+			} else {
+				parser.skipElement();
+			}
+			parser.separator();
+			parser.close();
+
+			actions->push_back(result);
+			parser.separator();
+		}
+		parser.separator();
+		parser.close();
 
-		// Clean up and return
-		delete args;
-		delete dataSpecifierList;
-		return targetingRule;
+		return new TargetingRule(offsetVector, targetName, dataSpecifiers, actions);
 	}
 
     /**
-	 * Create a move from a string
+	 * Read a move, written as [index,base vector,flags,chained moves,leaping rules,scaling rules,nth step rules,
+	 * targeting rules,]
 	 *
-	 * @param the string from which to generate the move
-	 *
-	 * @return a move generated from the string
+	 * @return the move
 	 */
-	inline static const MoveDef* getMoveFromString(const std::string& moveString) {
-		// Validate input
-		ResourceLoader::checkBracketEnclosed(moveString);
-		ResourceLoader::checkNumArgs(moveString.substr(1, moveString.length() - 2), NUM_MOVE_ARGS);
-
-		// Get all arguments
-		const std::vector<std::string>* args = StringUtils::getList(
-			moveString.substr(1, moveString.length() - 2),
-			ResourceLoader::SEPARATOR, ResourceLoader::BRACKET_OPEN, ResourceLoader::BRACKET_CLOSE
-		);
-		unsigned int argIndex = 0;
+	inline static const MoveDef* readMove(Parser& parser) {
+		parser.open();
 
-		const int moveIndex = std::stoi((*args)[argIndex++]);
-		const sf::Vector2i baseVector = VectorUtils::fromString((*args)[argIndex++]);
+		const int moveIndex = parser.readInt();
+		parser.separator();
+		const sf::Vector2i baseVector = parser.readVector();
+		parser.separator();
 
-		// Get the move properties
-		unsigned int index = 0;
-		const bool endsTurn      = (*args)[argIndex][index++] - '0';
-		const bool isXSymmetric  = (*args)[argIndex][index++] - '0';
-		const bool isYSymmetric  = (*args)[argIndex][index++] - '0';
-		const bool isXYSymmetric = (*args)[argIndex][index++] - '0';
-		argIndex++;
+		// Get the move properties: whether it ends the turn, and its symmetries
+		bool flags[NUM_MOVE_FLAGS];
+		readFlags(parser, flags, NUM_MOVE_FLAGS);
+		parser.separator();
 
 		// Load chained moves and movement rules
-		const std::vector<int>* chainedMoves = ResourceLoader::getListFromString
-			((*args)[argIndex++], (int(*)(const std::string&)) [](auto s){ return std::stoi(s); });
-		const std::vector<NumRule*>* leapingRules = ResourceLoader::getListFromString
-			((*args)[argIndex++], (NumRule*(*)(const std::string& s)) [](auto s){ return new NumRule(s); });
-		const std::vector<NumRule*>* scalingRules = ResourceLoader::getListFromString
-			((*args)[argIndex++], (NumRule*(*)(const std::string& s)) [](auto s){ return new NumRule(s); });
-		const std::vector<NumRule*>* nthStepRules = ResourceLoader::getListFromString
-			((*args)[argIndex++], (NumRule*(*)(const std::string& s)) [](auto s){ return new NumRule(s); });
-		const std::vector<const TargetingRule*>* targetingRules = ResourceLoader::getListFromString
-			((*args)[argIndex++], getTargetingRuleFromString);
-
-		MoveDef* newMove = new MoveDef(
-			moveIndex, baseVector, endsTurn, isXSymmetric, isYSymmetric, isXYSymmetric,
+		std::vector<int>* chainedMoves = new std::vector<int>();
+		parser.open();
+		while (!parser.tryClose()) {
+			chainedMoves->push_back(parser.readInt());
+			parser.separator();
+		}
+		parser.separator();
+
+		const std::vector<NumRule*>* leapingRules = readNumRules(parser);
+		parser.separator();
+		const std::vector<NumRule*>* scalingRules = readNumRules(parser);
+		parser.separator();
+		const std::vector<NumRule*>* nthStepRules = readNumRules(parser);
+		parser.separator();
+
+		std::vector<const TargetingRule*>* targetingRules = new std::vector<const TargetingRule*>();
+		parser.open();
+		while (!parser.tryClose()) {
+			targetingRules->push_back(readTargetingRule(parser));
+			parser.separator();
+		}
+		parser.separator();
+		parser.close();
+
+		return new MoveDef(
+			moveIndex, baseVector, flags[0], flags[1], flags[2], flags[3],
 			chainedMoves, leapingRules, scalingRules, nthStepRules, targetingRules
 		);
-
-		// Clean up and return
-		delete args;
-		return newMove;
 	}
 
     /**
-	 * Create a piece definition from a string
-	 *
-	 * @param pieceString the string from which to generate the piece definition
+	 * Read a piece definition, written as [name,flags,moves,]
 	 *
-	 * @return a piece definition generated from the string
+	 * @return the piece definition
 	 *
-	 * @throw ResourceLoader::FileFormatException if the piece string is not bracket-enclosed,
-	 *        if the piece name cannot be found, or if the move set cannot be found
+	 * @throw ResourceLoader::FileFormatException if the piece definition is not in the expected format, or if two of
+	 *        its moves have the same index
 	 */
-	inline static const PieceDef* getPieceDefFromString(const std::string& pieceString) {
-		// Validate input
-		ResourceLoader::checkBracketEnclosed(pieceString);
-		ResourceLoader::checkNumArgs(pieceString.substr(1, pieceString.length() - 2), 3);
-
-		const std::vector<std::string>* properties = StringUtils::getList(
-			pieceString.substr(1, pieceString.length() - 2),
-			ResourceLoader::SEPARATOR, ResourceLoader::BRACKET_OPEN, ResourceLoader::BRACKET_CLOSE
-		);
+	inline static const PieceDef* readPieceDef(Parser& parser) {
+		parser.open();
 
 		// Get the name
-		unsigned int propertyIndex = 0;
-		const std::string pieceName = (*properties)[propertyIndex++];
+		const std::string pieceName = parser.readToken();
+		parser.separator();
 
-		// Get piece properties
-		unsigned int index = 0;
-		const bool isCheckVulnerable = (*properties)[propertyIndex][index++] - '0';
-		const bool isRoyal = (*properties)[propertyIndex][index++] - '0';
-		propertyIndex++;
+		// Get piece properties: whether it is vulnerable to check, and whether it is royal
+		bool flags[NUM_PIECE_FLAGS];
+		readFlags(parser, flags, NUM_PIECE_FLAGS);
+		parser.separator();
 
 		// Get move set
-		const std::map<int, const MoveDef*>* moveSet = ResourceLoader::getMapFromString(
-			(*properties)[propertyIndex++],
-			(int(*)(const MoveDef*)) [](auto val){ return val->index; },
-			(const MoveDef*(*)(const std::string&)) [](auto s){ return getMoveFromString(s); }
-		);
+		std::map<int, const MoveDef*>* moveSet = new std::map<int, const MoveDef*>();
+		parser.open();
+		while (!parser.tryClose()) {
+			const MoveDef* move = readMove(parser);
+			if (!moveSet->insert(std::make_pair(move->index, move)).second) {
+				throw ResourceLoader::FileFormatException("Duplicate definition for key");
+			}
+
+			parser.separator();
+		}
+		parser.separator();
+		parser.close();
+
+		return new PieceDef(pieceName, flags[0], flags[1], moveSet);
+	}
+
+	/**
+	 * Read the list of piece definitions, which must be all that is left
+	 */
+	inline static std::map<std::string, const PieceDef*>* readPieceDefs(Parser& parser) {
+		std::map<std::string, const PieceDef*>* pieceDefs = new std::map<std::string, const PieceDef*>();
+
+		parser.open();
+		while (!parser.tryClose()) {
+			const PieceDef* pieceDef = readPieceDef(parser);
+			if (!pieceDefs->insert(std::make_pair(pieceDef->name, pieceDef)).second) {
+				throw ResourceLoader::FileFormatException("Duplicate definition for key");
+			}
+
+			parser.separator();
+		}
+
+		if (!parser.atEnd()) {
+			throw parser.error("the end of the piece definitions");
+		}
 
-		// Clean up and return
-		delete properties;
-		return new PieceDef(pieceName, isCheckVulnerable, isRoyal, moveSet);
+		return pieceDefs;
 	}
 
 public:
@@ -204,17 +236,25 @@ public:
 	inline static std::map<std::string, const PieceDef*>* loadPieceDefs (
 		const std::string& fileName
 	) {
+		Metrics::Timer timer(Metrics::LOAD_PIECE_DEFS);
+
 		// Check whether filename is valid
 		if (!ResourceLoader::isValidFileName(fileName, ".def")) {
 			throw ResourceLoader::FileFormatException("Invalid file name");
 		}
 
 		// Create the piece definitions
-		return ResourceLoader::getMapFromString(
-			ResourceLoader::removeWhiteSpace(fileName),
-			(std::string(*)(const PieceDef*))[](auto val){ return val->name; },
-			(const PieceDef*(*)(const std::string&))[](auto s){ return getPieceDefFromString(s); }
-		);
+		const MappedFile file(fileName);
+		Parser parser(file.getData(), file.getData() + file.getSize());
+		return readPieceDefs(parser);
+	}
+
+	/**
+	 * Load piece definitions from a string in the same format as the files
+	 */
+	inline static std::map<std::string, const PieceDef*>* loadPieceDefsFromString(const std::string& pieceDefsString) {
+		Parser parser(pieceDefsString);
+		return readPieceDefs(parser);
 	}
 };
 
@@ -1,8 +1,10 @@
 #ifndef CHESS_RESOURCE_LOADER_H
 #define CHESS_RESOURCE_LOADER_H
 
+#include <algorithm>
 #include <fstream>
 #include <SFML/Graphics.hpp>
+#include "../utils/metrics.h"
 #include "../utils/stringUtils.h"
 
 // Forward declarations
@@ -12,207 +14,6 @@ class PieceDefLoader;
 // Class declaration
 class ResourceLoader {
 private:
-	// Utility methods
-
-    /**
-	 * Determine the number of arguments in the string
-	 */
-	inline static const unsigned int getNumArgs(const std::string& s) {
-		// Check whether the string is empty
-		if (s.empty()) {
-			return 0;
-		}
-
-		// Count the number of arguments
-		unsigned int nestLevel = 0;
-		unsigned int argCount = 0;
-
-		for (unsigned int i = 0; i < s.length(); ++i) {
-			char curChar = s[i];
-
-			if (curChar == BRACKET_OPEN) {
-				nestLevel++;
-			} else if (curChar == BRACKET_CLOSE) {
-				nestLevel--;
-			} else if (nestLevel == 0 && curChar == SEPARATOR) {
-				argCount++;
-			}
-		}
-
-		return argCount;
-	}
-
-	// Validation methods
-    /**
-	 * Determine whether a file name is valid. A file name is valid if it ends with
-	 * the correct extension
-	 *
-	 * @param fileName the candidate file name
-	 *
-	 * @return true if the file name is valid, false otherwise
-	 */
-	inline static const bool isValidFileName(const std::string& fileName, const std::string& extension) {
-		// Check whether the filename has the required length
-		if (fileName.length() < extension.length()) {
-			return false;
-		}
-
-		// Check whether the file ends with the correct extension
-		for (unsigned int i = 1; i <= extension.length(); i++) {
-			if (extension[extension.length() - i] != fileName[fileName.length() - i]) {
-				return false;
-			}
-		}
-
-		return true;
-	}
-
-    /**
-	 * Check whether the string is bracket enclosed
-	 */
-	inline static const void checkBracketEnclosed(const std::string& s) {
-		// Check whether the string is bracket-enclosed
-		if (s[0] != BRACKET_OPEN || s[s.length() - 1] != BRACKET_CLOSE) {
-			throw FileFormatException("Expected bracket-enclosed string");
-		}
-	}
-
-    /**
-	 * Check whether the string contains the expected number of arguments
-	 */
-	inline static const void checkNumArgs(const std::string& s, unsigned int expected) {
-		unsigned int numMoveArgs = getNumArgs(s);
-		if (numMoveArgs != expected) {
-			throw FileFormatException(
-				"Expecting " + std::to_string(expected) + " arguments, " +
-				"received " + std::to_string(numMoveArgs) + ": " + s
-			);
-		}
-	}
-
-	// Object generation
-
-	/**
-	 * Get a list of objects from a string
-	 *
-	 * @param listString the string from which to generate the list of objects
-	 * @param objectFromString a function for generating an object from a string
-	 * @param T the type of object to stored in the returned list
-	 *
-	 * @return the list of objects represented by the string
-	 */
-	template <typename T> inline static std::vector<T>* getListFromString(
-		const std::string& listString,
-		T(*objectFromString)(const std::string&)
-	) {
-		// Validate input
-		checkBracketEnclosed(listString);
-
-		// Instantiate the list
-		std::vector<T>* objectList = new std::vector<T>();
-		const std::vector<std::string>* objectStrings =	StringUtils::getList(
-			listString.substr(1, listString.length() - 2), SEPARATOR, BRACKET_OPEN, BRACKET_CLOSE
-		);
-
-		// Load objects
-		for (std::vector<std::string>::const_iterator i = objectStrings->begin(); i != objectStrings->end(); ++i) {
-			objectList->push_back(objectFromString(*i));
-		}
-
-		// Clean up and return
-		delete objectStrings;
-		return objectList;
-	}
-
-	/**
-	 * Get a map of objects from a string
-	 *
-	 * @param listString the string from which to generate the map of objects
-	 * @param keyFromObject a function for generating a key from an object
-	 * @param objectFromString a function for generating an object from a string
-	 * @param K the key type by which to index the objects
-	 * @param V the type of object to be stored in the map
-	 *
-	 * @return the map of objects represented by the string
-	 */
-	template <typename K, typename V> inline static std::map<K, V>* getMapFromString(
-		const std::string& listString,
-		K(*keyFromObject)(V),
-		V(*objectFromString)(const std::string&)
-	) {
-		// Validate input
-		checkBracketEnclosed(listString);
-
-		// Instantiate the map
-		std::map<K, V>* objectMap = new std::map<K, V>();
-		const std::vector<std::string>* objectStrings = StringUtils::getList(
-			listString.substr(1, listString.length() - 2), SEPARATOR, BRACKET_OPEN, BRACKET_CLOSE
-		);
-
-		// Load objects
-		for (std::vector<std::string>::const_iterator i = objectStrings->begin(); i != objectStrings->end(); ++i) {
-			// Create the key-value pair
-			V val = objectFromString(*i);
-			K key = keyFromObject(val);
-
-			// Validate the key
-			if (objectMap->find(key) != objectMap->end()) {
-				throw ResourceLoader::FileFormatException("Duplicate definition for key");
-			}
-
-			// Add the key-value pair
-			objectMap->insert(std::make_pair(key, val));
-		}
-
-		// Clean up and return
-		delete objectStrings;
-		return objectMap;
-	}
-
-	// I/O Methods
-	/**
-	 * Read a file into a single string, removing whitespace
-	 */
-	inline static const std::string removeWhiteSpace(const std::string& fileName) {
-		std::ifstream file(fileName, std::ios::in);
-		std::string line;
-
-		// Check whether the file is open
-		if (!file.is_open()) {
-			throw ResourceLoader::IOException("Unable to open file: " + fileName);
-		}
-
-		// Read each line of the file into a single string
-		std::string compressedString = "";
-		while (std::getline(file, line)) {
-			unsigned int beginIndex = 0;
-			for (unsigned int i = 0; i < line.length(); i++) {
-				// Skip the rest of the line if it is commented out
-				if (line[i] == ResourceLoader::COMMENT_MARKER) {
-					compressedString += line.substr(beginIndex, i - beginIndex);
-					beginIndex = line.length();
-					break;
-				}
-
-				// Skip whitespace
-				if (line[i] == ' ' || line[i] == '\t') {
-					if (beginIndex != i) {
-						compressedString += line.substr(beginIndex, i - beginIndex);
-					}
-
-					beginIndex = i + 1;
-				}
-			}
-
-			compressedString += line.substr(beginIndex);
-		}
-
-		// Close the file
-		file.close();
-
-		return compressedString;
-	}
-
 	// Friends
 	friend BoardLoader;
 	friend PieceDefLoader;
@@ -254,6 +55,30 @@ public:
 		}
 	};
 
+    /**
+	 * Determine whether a file name is valid. A file name is valid if it ends with
+	 * the correct extension
+	 *
+	 * @param fileName the candidate file name
+	 *
+	 * @return true if the file name is valid, false otherwise
+	 */
+	inline static const bool isValidFileName(const std::string& fileName, const std::string& extension) {
+		// Check whether the filename has the required length
+		if (fileName.length() < extension.length()) {
+			return false;
+		}
+
+		// Check whether the file ends with the correct extension
+		for (unsigned int i = 1; i <= extension.length(); i++) {
+			if (extension[extension.length() - i] != fileName[fileName.length() - i]) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
 	/**
 	 * Get a list of objects from the entries of a map
 	 *
@@ -280,6 +105,7 @@ public:
     inline static std::map<std::string, sf::Texture*>* loadTextures(
 		const std::vector<std::string>* fileNames, const std::string& texturesDirectory, const std::string& texturesExtension
 	) {
+		Metrics::Timer timer(Metrics::LOAD_TEXTURES);
 		std::map<std::string, sf::Texture*>* textures = new std::map<std::string, sf::Texture*>();
 		for (std::vector<std::string>::const_iterator i = fileNames->begin(); i != fileNames->end(); ++i) {
 			sf::Texture* texture = new sf::Texture();
@@ -290,6 +116,57 @@ public:
 		return textures;
     }
 
+	/**
+	 * Pack textures into one atlas, so that everything drawn with them can be drawn in one call
+	 *
+	 * The textures are laid out in rows, with a pixel between them so that scaled textures do not bleed into each
+	 * other.
+	 *
+	 * @param textures the textures to pack
+	 * @param regions  filled with the region of the atlas that holds each texture
+	 *
+	 * @return the atlas
+	 */
+	inline static sf::Texture* packTextures(
+		const std::map<std::string, sf::Texture*>* textures, std::map<std::string, sf::IntRect>* regions
+	) {
+		Metrics::Timer timer(Metrics::LOAD_TEXTURES);
+		const unsigned int PADDING = 1;
+		const unsigned int maxWidth = std::min(sf::Texture::getMaximumSize(), 1024u);
+
+		// Lay out the textures, starting a new row when one is full
+		sf::Vector2u size;
+		sf::Vector2u cursor;
+		unsigned int rowHeight = 0;
+		for (std::map<std::string, sf::Texture*>::const_iterator i = textures->begin(); i != textures->end(); ++i) {
+			if (i->second == nullptr) continue;
+
+			const sf::Vector2u textureSize = i->second->getSize();
+			if (cursor.x > 0 && cursor.x + textureSize.x > maxWidth) {
+				cursor.x = 0;
+				cursor.y += rowHeight + PADDING;
+				rowHeight = 0;
+			}
+
+			regions->insert(std::make_pair(i->first, sf::IntRect(cursor.x, cursor.y, textureSize.x, textureSize.y)));
+			cursor.x += textureSize.x + PADDING;
+			rowHeight = std::max(rowHeight, textureSize.y);
+			size.x = std::max(size.x, cursor.x);
+			size.y = cursor.y + rowHeight;
+		}
+
+		// Copy the textures into the atlas
+		sf::Image image;
+		image.create(std::max(size.x, 1u), std::max(size.y, 1u), sf::Color::Transparent);
+		for (std::map<std::string, sf::IntRect>::const_iterator i = regions->begin(); i != regions->end(); ++i) {
+			image.copy(textures->find(i->first)->second->copyToImage(), i->second.left, i->second.top);
+		}
+
+		sf::Texture* atlas = new sf::Texture();
+		atlas->loadFromImage(image);
+		return atlas;
+	}
+
     /**
      * Write to file
      */
@@ -1,7 +1,80 @@
+#include <iostream>
+#include <string>
 #include "game.h"
+#include "engine/engineProtocol.h"
+#include "io/resourceLoader.h"
+#include "utils/metrics.h"
+
+/**
+ * Write the metrics and the trace recorded while running to files, if they were given
+ */
+int writeOnExit(Game& game, const std::string& metricsFileName, const std::string& traceFileName) {
+	try {
+		if (!metricsFileName.empty()) ResourceLoader::write(metricsFileName, Metrics::toString());
+		if (!traceFileName.empty()) game.saveTrace(traceFileName);
+	} catch (ResourceLoader::IOException ex) {
+		std::cerr << "IOException: " << ex.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
+	// Read the options
+	bool engine = false;
+	bool measure = false;
+	bool renderThread = false;
+	std::string journalFileName;
+	std::string metricsFileName;
+	std::string traceFileName;
+	for (int i = 1; i < argc; i++) {
+		const std::string option = argv[i];
+		if (option == "--engine") {
+			engine = true;
+		} else if (option == "--measure") {
+			measure = true;
+		} else if (option == "--render-thread") {
+			renderThread = true;
+		} else if (option == "--journal" && i + 1 < argc) {
+			journalFileName = argv[++i];
+		} else if (option == "--metrics" && i + 1 < argc) {
+			metricsFileName = argv[++i];
+		} else if (option == "--trace" && i + 1 < argc) {
+			traceFileName = argv[++i];
+		} else {
+			std::cerr << "Invalid option: " << option << std::endl;
+			return 1;
+		}
+	}
+
+	// Run the text protocol without a window
+	if (engine) {
+		const unsigned int GENERATION_MARGIN = 8;
+		Game engineGame(GENERATION_MARGIN);
+		try {
+			if (!journalFileName.empty()) engineGame.startJournal(journalFileName);
+		} catch (ResourceLoader::IOException ex) {
+			std::cerr << "IOException: " << ex.what() << std::endl;
+			return 1;
+		}
+
+		EngineProtocol protocol(&engineGame, std::cout);
+		protocol.run(std::cin);
+		return writeOnExit(engineGame, metricsFileName, traceFileName);
+	}
 
-int main() {
     Game chessGame;
+	try {
+		if (!journalFileName.empty()) chessGame.startJournal(journalFileName);
+		if (!traceFileName.empty()) chessGame.setTraceFile(traceFileName);
+		chessGame.setMeasuring(measure);
+		chessGame.setRenderThread(renderThread);
+	} catch (ResourceLoader::IOException ex) {
+		std::cerr << "IOException: " << ex.what() << std::endl;
+		return 1;
+	}
+
 	chessGame.run();
-    return 0;
+    return writeOnExit(chessGame, metricsFileName, traceFileName);
 }
@@ -1,12 +1,21 @@
 #include "renderer.h"
 
+#include <cmath>
 #include <string>
 #include "components/moveMarker.h"
 #include "component_trackers/moveTracker.h"
 #include "components/piece.h"
+#include "io/resourceLoader.h"
+#include "utils/metrics.h"
+#include "utils/trace.h"
 #include "utils/vectorUtils.h"
 #include "ui/windowLayer.h"
 
+// Colors
+
+const sf::Color Renderer::BACKGROUND_COLOR = sf::Color( 0,  0,  0, 255);
+const sf::Color Renderer::FOREGROUND_COLOR = sf::Color(50, 50, 50, 255);
+
 // Private utility methods
 
 /**
@@ -20,86 +29,197 @@ sf::Vector2i Renderer::getScreenPos(sf::Vector2i pos) const {
 }
 
 /**
- * Draw the board
+ * Get the tile at a position on screen
  */
-void Renderer::drawBoard() const {
-	sf::RectangleShape tile(sf::Vector2f(tileSize, tileSize));
-	tile.setFillColor(FOREGROUND_COLOR);
+sf::Vector2i Renderer::getTilePos(sf::Vector2f screenPos) const {
+	return sf::Vector2i(
+		std::floor((screenPos.x - tileStartPos.x) / tileSize + cameraPos.x - dimensionsInTiles.x / 2),
+		std::floor((screenPos.y - tileStartPos.y) / tileSize + cameraPos.y - dimensionsInTiles.y / 2)
+	);
+}
 
-	// Draw the board
-	for (unsigned int x = 0; x < dimensionsInTiles.x; x++) {
-		for (unsigned int y = 0; y < dimensionsInTiles.y; y++) {
-			// Determine whether the tile needs to be colored
-			if ((x + y) % 2 == parity) {
-				tile.setPosition(
-					tileStartPos.x + cameraShift.x + tileSize * x,
-					tileStartPos.y + cameraShift.y + tileSize * y
-				);
+/**
+ * Get the position of the cursor in the window, or the middle of the texture when drawing offscreen
+ */
+sf::Vector2i Renderer::getMouseScreenPos() const {
+	if (window == nullptr) {
+		return sf::Vector2i(target->getSize() / 2u);
+	}
 
-				window->draw(tile);
-			}
-		}
+	return sf::Mouse::getPosition(*window);
+}
+
+/**
+ * Draw the board into a frame, copying its tiles if they have been rebuilt since the frame was last built
+ */
+void Renderer::drawBoard(Frame& frame) const {
+	Metrics::Timer timer(Metrics::DRAW_BOARD);
+	if (frame.boardVersion != boardVersion) {
+		frame.boardVertices = boardVertices;
+		frame.boardVersion = boardVersion;
 	}
+
+	// Shift every tile to the camera
+	frame.boardShift = tileStartPos + cameraShift;
 }
 
 /**
  * Draw the layers
  */
 void Renderer::drawUILayers() const {
-	// Check whether the menu should be drawn
-	if (!displayMenu) {
-		return;
-	}
+	Metrics::Timer timer(Metrics::DRAW_UI);
 
 	for (std::vector<WindowLayer*>::const_iterator i = layers.begin(); i != layers.end(); ++i) {
-        (*i)->draw(uiTextures, debugFont, window);
+        (*i)->draw(uiTextures, debugFont, target);
 	}
 }
 
 /**
- * Draw the pieces
+ * Draw the pieces on screen into a frame, batching the textured pieces into one call
  */
-void Renderer::drawPieces() const {
+void Renderer::drawPieces(Frame& frame) const {
+	Metrics::Timer timer(Metrics::DRAW_PIECES);
 	std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces = game->pieceTracker->pieces;
+	frame.pieceVertices.clear();
+	frame.densityVertices.clear();
+	frame.circles.clear();
+	frame.piecesDrawn = 0;
+	frame.tileSize = tileSize;
+
+	// Draw the chunks of pieces instead when zoomed out
+	if (isZoomedOut()) {
+		drawDensity(frame);
+		return;
+	}
 
-	// Draw the pieces
-    for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::iterator it = pieces->begin();
-		it != pieces->end();
-		++it
-	) {
-        drawPiece(it->second);
-    }
+	// Find the tiles on screen
+	const sf::Vector2i minTile = getTilePos(sf::Vector2f(0, 0));
+	const sf::Vector2i maxTile = getTilePos(sf::Vector2f(target->getSize()));
+
+	// The pieces are sorted by column, so find the visible ones in each column
+	for (int x = minTile.x; x <= maxTile.x; x++) {
+		for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::iterator it =
+				pieces->lower_bound(sf::Vector2i(x, minTile.y));
+			it != pieces->end() && it->first.x == x && it->first.y <= maxTile.y;
+			++it
+		) {
+			drawPiece(frame, it->second);
+		}
+	}
+
+	frame.piecesDrawn = frame.pieceVertices.getVertexCount() / 4 + frame.circles.size();
 }
 
 /**
- * Draw tile overlays
+ * Draw a cell for each chunk of pieces on screen into a frame, using the smallest chunks that are at least
+ * LOD_CELL_SIZE pixels wide. The chunks are counted by the piece tracker as the pieces move, so the time taken only
+ * depends on the number of cells on screen, however many pieces are in them.
  */
-void Renderer::drawOverlays() const {
-	const sf::Vector2i mousePos = getMouseTilePosition();
-	Piece* selectedPiece = game->controller->getSelectedPiece();
+void Renderer::drawDensity(Frame& frame) const {
+	const ChunkIndex& chunks = game->pieceTracker->chunks;
 
-    // Draw selection overlay
-    if (selectedPiece != nullptr) {
-		drawTile(selectedPiece->getPos().x, selectedPiece->getPos().y, PIECE_SELECTED_COLOR);
+	// Find the level of the chunks to draw
+	unsigned int level = ChunkIndex::MIN_LEVEL;
+	while (level < ChunkIndex::MAX_LEVEL && tileSize * (1 << level) < LOD_CELL_SIZE) {
+		level++;
+	}
 
-		// Draw possible moves
-		for (std::map<const MoveDef*, std::map<
-				sf::Vector2i, MoveMarker*, VectorUtils::cmpVectorLexicographically>*
-			>::iterator i = selectedPiece->moveTracker->moveMarkers->begin();
-			i != selectedPiece->moveTracker->moveMarkers->end();
-			++i
+	// Find the chunks on screen
+	const sf::Vector2i minChunk = ChunkIndex::getChunk(getTilePos(sf::Vector2f(0, 0)), level);
+	const sf::Vector2i maxChunk = ChunkIndex::getChunk(getTilePos(sf::Vector2f(target->getSize())), level);
+	const std::unordered_map<std::int64_t, ChunkIndex::Chunk>& levelChunks = chunks.getChunks(level);
+	const unsigned long long numVisible =
+		(unsigned long long) (maxChunk.x - minChunk.x + 1) * (unsigned long long) (maxChunk.y - minChunk.y + 1);
+
+	// Visit whichever is fewer of the chunks on screen and the chunks that hold pieces
+	if (levelChunks.size() < numVisible) {
+		for (std::unordered_map<std::int64_t, ChunkIndex::Chunk>::const_iterator i = levelChunks.begin();
+			i != levelChunks.end(); ++i
 		) {
-			for (std::map<
-					sf::Vector2i, MoveMarker*, VectorUtils::cmpVectorLexicographically
-				>::iterator j = i->second->begin();
-				j != i->second->end();
-				++j
+			const sf::Vector2i chunkPos = ChunkIndex::getChunk(i->first);
+			if (
+				chunkPos.x >= minChunk.x && chunkPos.x <= maxChunk.x &&
+				chunkPos.y >= minChunk.y && chunkPos.y <= maxChunk.y
 			) {
-				if (!j->second->canMove(game->controller->curTeamHasMoved()) && !displayDebugData) continue;
-				drawTile(j->first.x, j->first.y, MOVE_MARKER_COLOR);
+				drawChunk(frame, chunkPos, level, i->second);
 			}
 		}
-    }
+	} else {
+		for (int x = minChunk.x; x <= maxChunk.x; x++) {
+			for (int y = minChunk.y; y <= maxChunk.y; y++) {
+				std::unordered_map<std::int64_t, ChunkIndex::Chunk>::const_iterator found =
+					levelChunks.find(ChunkIndex::getKey(sf::Vector2i(x, y)));
+				if (found != levelChunks.end()) {
+					drawChunk(frame, sf::Vector2i(x, y), level, found->second);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Draw a chunk of pieces into a frame, in the blend of its teams' colors weighted by their number of pieces. The
+ * more densely the pieces fill the chunk, the more opaque it is.
+ *
+ * @param frame    the frame to draw to
+ * @param chunkPos the position of the chunk in chunks
+ * @param level    the level of the chunk, whose width is 2^level tiles
+ * @param chunk    the pieces in the chunk
+ */
+void Renderer::drawChunk(
+	Frame& frame, sf::Vector2i chunkPos, unsigned int level, const ChunkIndex::Chunk& chunk
+) const {
+	const int chunkSize = 1 << level;
+
+	// Blend the team colors
+	float r = 0, g = 0, b = 0;
+	for (std::vector<std::pair<unsigned int, unsigned int>>::const_iterator i = chunk.teams.begin();
+		i != chunk.teams.end(); ++i
+	) {
+		const sf::Color teamColor = getTeamColor(teams, i->first);
+		r += teamColor.r * i->second;
+		g += teamColor.g * i->second;
+		b += teamColor.b * i->second;
+	}
+
+	frame.piecesDrawn += chunk.count;
+	const float density = chunk.count / (float) (chunkSize * chunkSize);
+	const sf::Color color(
+		r / chunk.count, g / chunk.count, b / chunk.count,
+		LOD_MIN_ALPHA + (255 - LOD_MIN_ALPHA) * std::min(1.f, 2 * std::sqrt(density))
+	);
+
+	appendTile(frame.densityVertices, sf::Vector2f(
+		tileStartPos.x + tileSize * (chunkPos.x * chunkSize - cameraPos.x + dimensionsInTiles.x / 2),
+		tileStartPos.y + tileSize * (chunkPos.y * chunkSize - cameraPos.y + dimensionsInTiles.y / 2)
+	), tileSize * chunkSize, color);
+}
+
+/**
+ * Draw tile overlays into a frame
+ */
+void Renderer::drawOverlays(Frame& frame) {
+	Metrics::Timer timer(Metrics::DRAW_OVERLAYS);
+	const sf::Vector2i mousePos = getMouseTilePosition();
+	Piece* selectedPiece = game->controller->getSelectedPiece();
+
+	// Draw selection overlay, which is only rebuilt when it may have changed
+	if (highlightsChanged) {
+		buildHighlights();
+		highlightsChanged = false;
+	}
+
+	if (frame.highlightVersion != highlightVersion) {
+		frame.highlightVertices = highlightVertices;
+		frame.highlightVersion = highlightVersion;
+	}
+
+	frame.cursorVertices.clear();
+
+	// Tiles cannot be hovered while zoomed out
+	if (isZoomedOut()) {
+		return;
+	}
 
     // Draw mouse overlay
 
@@ -109,131 +229,254 @@ void Renderer::drawOverlays() const {
 
 		// Only the piece on the current turn's team is selectable
 		if (hoveredPiece == nullptr || !game->controller->canMove(hoveredPiece->team)) {
-			drawTile(mousePos.x, mousePos.y, MOUSE_INVALID_COLOR);
+			drawTile(frame, mousePos.x, mousePos.y, MOUSE_INVALID_COLOR);
 		} else {
-			drawTile(mousePos.x, mousePos.y, MOUSE_VALID_COLOR);
+			drawTile(frame, mousePos.x, mousePos.y, MOUSE_VALID_COLOR);
 		}
 
 	// If a piece is selected, only valid move positions should be selectable
     } else {
 		if (game->pieceTracker->getValidMove(selectedPiece, mousePos) != nullptr) {
-			drawTile(mousePos.x, mousePos.y, MOUSE_VALID_COLOR);
+			drawTile(frame, mousePos.x, mousePos.y, MOUSE_VALID_COLOR);
 		} else {
-			drawTile(mousePos.x, mousePos.y, MOUSE_INVALID_COLOR);
+			drawTile(frame, mousePos.x, mousePos.y, MOUSE_INVALID_COLOR);
 		}
     }
 
     // Check if debug data should be drawn
     if (displayDebugData) {
-		drawTile(mousePos.x, mousePos.y, MOUSE_DEBUG_COLOR);
+		drawTile(frame, mousePos.x, mousePos.y, MOUSE_DEBUG_COLOR);
     }
 }
 
+/**
+ * Rebuild the overlay for the selected piece and its possible moves
+ */
+void Renderer::buildHighlights() {
+	highlightVertices.clear();
+	highlightVersion++;
+
+	// The moves are not drawn while zoomed out
+	Piece* selectedPiece = game->controller->getSelectedPiece();
+	if (selectedPiece == nullptr || isZoomedOut()) {
+		return;
+	}
+
+	highlightTile(selectedPiece->getPos().x, selectedPiece->getPos().y, PIECE_SELECTED_COLOR);
+
+	// Add the possible moves
+	for (std::map<const MoveDef*, std::map<
+			sf::Vector2i, MoveMarker*, VectorUtils::cmpVectorLexicographically>*
+		>::iterator i = selectedPiece->moveTracker->moveMarkers->begin();
+		i != selectedPiece->moveTracker->moveMarkers->end();
+		++i
+	) {
+		for (std::map<
+				sf::Vector2i, MoveMarker*, VectorUtils::cmpVectorLexicographically
+			>::iterator j = i->second->begin();
+			j != i->second->end();
+			++j
+		) {
+			if (!j->second->canMove(game->controller->curTeamHasMoved()) && !displayDebugData) continue;
+			highlightTile(j->first.x, j->first.y, MOVE_MARKER_COLOR);
+		}
+	}
+}
+
 /**
  * Draw debug text
  *
  * @param s   the text to draw
  * @param row the level at which to draw the text
  */
-void Renderer::drawDebugText(const std::string& s, const unsigned int row) const {
+void Renderer::drawDebugText(const std::string& s, const unsigned int row) {
 	const unsigned int FONT_SIZE = 20;
-	sf::Text label(s, debugFont, FONT_SIZE);
-	label.setFillColor(sf::Color::White);
-	label.setPosition(0, row * FONT_SIZE);
-	window->draw(label);
+
+	// Keep the text for each row, which only rebuilds its geometry when its string changes
+	while (debugTexts.size() <= row) {
+		debugTexts.push_back(sf::Text("", debugFont, FONT_SIZE));
+		debugTexts.back().setFillColor(sf::Color::White);
+		debugTexts.back().setPosition(0, (debugTexts.size() - 1) * FONT_SIZE);
+	}
+
+	debugTexts[row].setString(s);
+	target->draw(debugTexts[row]);
 }
 
 /**
- * Draw a game piece
+ * Draw a game piece into a frame, from the atlas if it has a texture or as a circle otherwise
  *
- * @param x the x position to draw to
- * @param y the y position to draw to
- * @param c the color to fill with
+ * @param frame the frame to draw to
+ * @param p     the piece to draw
  */
-void Renderer::drawPiece(Piece* p) const {
-	// Get the team color
-	sf::Color teamColor = sf::Color::White;
-	std::map<
-		const unsigned int,
-		std::pair<const std::string,
-		sf::Color>
-	>::iterator teamIter = teams->find(p->team);
-	if (teamIter != teams->end()) {
-		teamColor = teamIter->second.second;
-	}
-
-	std::map<std::string, sf::Texture*>::iterator it = textures->find(p->pieceDef->name);
-	if (it == textures->end() || it->second == nullptr) {
-		sf::CircleShape s(tileSize / 2);
-		s.setFillColor(teamColor);
-
-		s.setPosition(
-			tileStartPos.x + tileSize * (p->pos.x - cameraPos.x + dimensionsInTiles.x / 2),
-			tileStartPos.y + tileSize * (p->pos.y - cameraPos.y + dimensionsInTiles.y / 2)
-		);
-
-		window->draw(s);
-	} else {
-        sf::Sprite s;
-        s.setTexture(*(it->second));
-        s.setColor(teamColor);
-        s.setScale(sf::Vector2f(tileSize / 16, tileSize / 16));
-        s.setPosition(
-			tileStartPos.x + tileSize * (p->pos.x - cameraPos.x + dimensionsInTiles.x / 2),
-			tileStartPos.y + tileSize * (p->pos.y - cameraPos.y + dimensionsInTiles.y / 2)
-		);
+void Renderer::drawPiece(Frame& frame, Piece* p) const {
+	const sf::Color teamColor = getTeamColor(teams, p->team);
+	const sf::Vector2f pos(
+		tileStartPos.x + tileSize * (p->pos.x - cameraPos.x + dimensionsInTiles.x / 2),
+		tileStartPos.y + tileSize * (p->pos.y - cameraPos.y + dimensionsInTiles.y / 2)
+	);
 
-        window->draw(s);
+	std::map<std::string, sf::IntRect>::const_iterator it = pieceRegions->find(p->pieceDef->name);
+	if (it == pieceRegions->end()) {
+		frame.circles.push_back(std::make_pair(pos, teamColor));
+	} else {
+		appendPiece(frame.pieceVertices, pos, tileSize / 16, it->second, teamColor);
 	}
 }
 
 /**
- * Draw the tile at (x,y)
+ * Draw the tile at (x,y) into a frame
+ *
+ * @param frame the frame to draw to
+ * @param x     the x position to draw to
+ * @param y     the y position to draw to
+ * @param c     the color to fill with
+ */
+void Renderer::drawTile(Frame& frame, const int x, const int y, const sf::Color c) const {
+	appendTile(frame.cursorVertices, sf::Vector2f(
+		tileStartPos.x + tileSize * (x - cameraPos.x + dimensionsInTiles.x / 2),
+		tileStartPos.y + tileSize * (y - cameraPos.y + dimensionsInTiles.y / 2)
+	), tileSize, c);
+}
+
+/**
+ * Add the tile at (x,y) to the selection overlay
  *
  * @param x the x position to draw to
  * @param y the y position to draw to
  * @param c the color to fill with
  */
-void Renderer::drawTile(const int x, const int y, const sf::Color c) const {
-    sf::RectangleShape s(sf::Vector2f(tileSize, tileSize));
-    s.setFillColor(c);
-	s.setPosition(
+void Renderer::highlightTile(const int x, const int y, const sf::Color c) {
+	appendTile(highlightVertices, sf::Vector2f(
 		tileStartPos.x + tileSize * (x - cameraPos.x + dimensionsInTiles.x / 2),
 		tileStartPos.y + tileSize * (y - cameraPos.y + dimensionsInTiles.y / 2)
-	);
-
-	window->draw(s);
+	), tileSize, c);
 }
 
 /**
- * Draw debug data
+ * Write the debug data into a frame
  */
-void Renderer::drawDebug() const {
+void Renderer::drawDebug(Frame& frame) const {
+	Metrics::Timer timer(Metrics::DRAW_DEBUG);
 	sf::Vector2f mousePos = getMousePosition();
 
 	std::string s;
-	int row = 0;
 
 	s = "Camera position: (" + std::to_string(cameraPos.x) + ", " + std::to_string(cameraPos.y) + ")";
-	drawDebugText(s, row++);
+	frame.debugLines.push_back(s);
 	s = "Mouse position: (" + std::to_string(mousePos.x) + ", " + std::to_string(mousePos.y) + ")";
-	drawDebugText(s, row++);
+	frame.debugLines.push_back(s);
 	s = "Tile size: " + std::to_string(tileSize);
-	drawDebugText(s, row++);
+	frame.debugLines.push_back(s);
 
 	Piece* selectedPiece = game->controller->getSelectedPiece();
 	if (selectedPiece == nullptr) {
 		s = "Selected piece: null";
-		drawDebugText(s, row++);
+		frame.debugLines.push_back(s);
 	} else {
 		s = "Selected piece: " + selectedPiece->pieceDef->name;
-		drawDebugText(s, row++);
+		frame.debugLines.push_back(s);
 		s = "Selected piece dir: " + std::to_string(selectedPiece->dir);
-		drawDebugText(s, row++);
+		frame.debugLines.push_back(s);
 		s = "Selected piece pos: (" + std::to_string(selectedPiece->pos.x) + ", " + std::to_string(selectedPiece->pos.y) + ")";
-		drawDebugText(s, row++);
+		frame.debugLines.push_back(s);
 		s = "Selected piece team: " + teams->find(selectedPiece->team)->second.first;
-		drawDebugText(s, row++);
+		frame.debugLines.push_back(s);
+	}
+
+	// Draw the probes that have been called
+	for (unsigned int i = 0; i < Metrics::NUM_PROBES; i++) {
+		s = Metrics::summarize((Metrics::Probe) i);
+		if (!s.empty()) {
+			frame.debugLines.push_back(s);
+		}
+	}
+}
+
+/**
+ * Add a frame's measurements to the performance HUD and draw it in the top right corner of the window
+ *
+ * @param frame        the frame being drawn
+ * @param renderMillis the time taken to draw the frame before the HUD
+ */
+void Renderer::drawHud(const Frame& frame, float renderMillis) {
+	Metrics::Timer timer(Metrics::DRAW_HUD);
+	const std::uint64_t allocations = Metrics::getAllocations();
+	hud.record(PerformanceHud::Sample{
+		frameTimer.restart().asMicroseconds() / 1000.f, frame.simMillis, renderMillis, allocations - lastAllocations,
+		frame.moveMarkers, frame.listeners, frame.pieces, frame.piecesDrawn
+	});
+	lastAllocations = allocations;
+
+	hud.draw(*target, sf::Vector2f(frame.windowSize.x - hud.getWidth(), 0));
+}
+
+/**
+ * Draw a frame to the window, or to the texture when drawing offscreen
+ */
+void Renderer::drawFrame(const Frame& frame) {
+	Trace::Span span("draw");
+	sf::Clock renderTimer;
+
+	// Match the view to the size of the window
+	if (frame.windowSize != viewSize) {
+		target->setView(sf::View(sf::FloatRect(0, 0, frame.windowSize.x, frame.windowSize.y)));
+		viewSize = frame.windowSize;
+	}
+
+	target->clear(BACKGROUND_COLOR);
+
+	// Draw every tile of the board in one call, shifted to the camera
+	sf::Transform shift;
+	shift.translate(frame.boardShift);
+	target->draw(frame.boardVertices, sf::RenderStates(shift));
+
+	// Draw the overlays
+	target->draw(frame.highlightVertices);
+	target->draw(frame.cursorVertices);
+
+	// Draw the pieces
+	target->draw(frame.densityVertices);
+	if (frame.pieceVertices.getVertexCount() > 0) {
+		target->draw(frame.pieceVertices, sf::RenderStates(pieceAtlas));
+	}
+
+	for (std::vector<std::pair<sf::Vector2f, sf::Color>>::const_iterator i = frame.circles.begin();
+		i != frame.circles.end(); ++i
+	) {
+		sf::CircleShape s(frame.tileSize / 2);
+		s.setFillColor(i->second);
+		s.setPosition(i->first);
+		target->draw(s);
+	}
+
+	// Draw the menu and debug data
+	if (frame.displayMenu) {
+		drawUILayers();
+	}
+
+	for (unsigned int row = 0; row < frame.debugLines.size(); row++) {
+		drawDebugText(frame.debugLines[row], row);
+	}
+
+	if (frame.displayHud) {
+		drawHud(frame, renderTimer.getElapsedTime().asMicroseconds() / 1000.f);
+	}
+
+	{
+		Metrics::Timer timer(Metrics::DRAW_DISPLAY);
+		if (window != nullptr) {
+			window->display();
+		} else {
+			offscreen->display();
+		}
+	}
+
+	// Record how long the input took to reach the screen
+	if (frame.hasInput) {
+		Metrics::record(Metrics::INPUT_LATENCY, std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - frame.inputTime
+		).count());
 	}
 }
 
@@ -249,13 +492,41 @@ void Renderer::drawDebug() const {
 Renderer::Renderer(Game* g, sf::RenderWindow* w) :
 	game{g},
 	window{w},
+	offscreen{nullptr},
+	target{w},
 	textures{nullptr},
 	uiTextures{nullptr},
-	teams{nullptr}
+	pieceAtlas{nullptr},
+	pieceRegions{nullptr},
+	teams{nullptr},
+	boardVertices{sf::Quads},
+	highlightVertices{sf::Quads},
+	hud{debugFont}
 {
 	window->setFramerateLimit(MAX_FRAMERATE);
 }
 
+/**
+ * Constructor for drawing offscreen, with no framerate limit. The cursor is taken to be in the middle of the texture.
+ *
+ * @param t The texture to draw to
+ */
+Renderer::Renderer(Game* g, sf::RenderTexture* t) :
+	game{g},
+	window{nullptr},
+	offscreen{t},
+	target{t},
+	textures{nullptr},
+	uiTextures{nullptr},
+	pieceAtlas{nullptr},
+	pieceRegions{nullptr},
+	teams{nullptr},
+	boardVertices{sf::Quads},
+	highlightVertices{sf::Quads},
+	hud{debugFont}
+{
+}
+
 /**
  * Destructor
  */
@@ -273,14 +544,24 @@ Renderer::~Renderer() {
 		textures = nullptr;
 	}
 
+	// Delete the atlas
+	if (pieceAtlas != nullptr) {
+		delete pieceAtlas;
+		delete pieceRegions;
+		pieceAtlas = nullptr;
+		pieceRegions = nullptr;
+	}
+
 	// Delete the teams
     if (teams != nullptr) {
         delete teams;
 		teams = nullptr;
     }
 
-	game   = nullptr;
-	window = nullptr;
+	game      = nullptr;
+	window    = nullptr;
+	offscreen = nullptr;
+	target    = nullptr;
 }
 
 
@@ -299,25 +580,28 @@ void Renderer::onStartup(
 	uiTextures = uiTextures_;
 	teams = teams_;
 
-	// Load resources
-	debugFont.loadFromFile(FONT_DIRECTORY + DEBUG_FONT_FILENAME);
+	// Load resources, which are kept when another board is loaded since frames may be drawn from them on another
+	// thread. The piece textures are packed into one atlas.
+	if (pieceAtlas == nullptr) {
+		debugFont.loadFromFile(FONT_DIRECTORY + DEBUG_FONT_FILENAME);
+		pieceRegions = new std::map<std::string, sf::IntRect>();
+		pieceAtlas = ResourceLoader::packTextures(textures, pieceRegions);
+	}
 
 	// Set up window icon
 	std::map<std::string, sf::Texture*>::iterator iconIter = textures->find(WINDOW_ICON);
-	if (iconIter != textures->end()) {
+	if (window != nullptr && iconIter != textures->end()) {
 		sf::Texture* t = iconIter->second;
 		window->setIcon(t->getSize().x, t->getSize().y, t->copyToImage().getPixelsPtr());
 	}
 
-	onResize(window->getSize().x, window->getSize().y);
+	onResize(target->getSize().x, target->getSize().y);
 }
 
 /**
  * Handle window resizing
  */
 void Renderer::onResize(const unsigned int width, const unsigned int height) {
-    window->setView(sf::View(sf::FloatRect(0, 0, width, height)));
-
 	// Find the dimensions of the window in tiles, padded on each edge
 	dimensionsInTiles.x = 2 * (TILE_PADDING + std::floor(width / tileSize / 2.f));
 	dimensionsInTiles.y = 2 * (TILE_PADDING + std::floor(height / tileSize / 2.f));
@@ -328,6 +612,15 @@ void Renderer::onResize(const unsigned int width, const unsigned int height) {
 	tileStartPos.x = (width / 2.f) - tileSize * (dimensionsInTiles.x / 2.f);
 	tileStartPos.y = (height / 2.f) - tileSize * (dimensionsInTiles.y / 2.f);
 
+	// The tiles are too small to draw when zoomed out
+	if (isZoomedOut()) {
+		boardVertices.clear();
+	} else {
+		buildBoard(boardVertices, dimensionsInTiles, parity, tileSize, FOREGROUND_COLOR);
+	}
+
+	boardVersion++;
+
 	// Shift the tile start position to centre on the camera
 	onCameraMove();
 }
@@ -338,6 +631,7 @@ void Renderer::onResize(const unsigned int width, const unsigned int height) {
 void Renderer::onCameraMove() {
 	cameraShift.x = - tileSize * std::fmod(cameraPos.x, 2.f);
 	cameraShift.y = - tileSize * std::fmod(cameraPos.y, 2.f);
+	highlightsChanged = true;
 	needsRedraw = true;
 }
 
@@ -345,7 +639,13 @@ void Renderer::onCameraMove() {
  * Zoom the camera
  */
 void Renderer::onZoom(const float delta) {
-	tileSize += delta;
+	// Zoom by a pixel for each step while the tiles are drawn, and by a factor below that so that the whole range of
+	// tile sizes can be crossed
+	if (tileSize + delta >= LOD_TILE_SIZE) {
+		tileSize += delta;
+	} else {
+		tileSize *= std::pow(LOD_ZOOM_FACTOR, delta);
+	}
 
 	if (delta > 0) {
 		tileSize = std::min(tileSize, MAX_TILE_SIZE);
@@ -353,7 +653,32 @@ void Renderer::onZoom(const float delta) {
 		tileSize = std::max(tileSize, MIN_TILE_SIZE);
 	}
 
-	onResize(window->getSize().x, window->getSize().y);
+	onResize(target->getSize().x, target->getSize().y);
+}
+
+/**
+ * Handle input that needs to be drawn, so that the time until it is on screen can be measured
+ */
+void Renderer::onInput() {
+	if (!inputPending) {
+		inputPending = true;
+		inputTime = std::chrono::steady_clock::now();
+	}
+}
+
+/**
+ * Handle the rules being run, so that the time spent on them can be shown with the next frame
+ */
+void Renderer::onSimulated(const float millis) {
+	simMillis += millis;
+}
+
+/**
+ * Handle the selection or the pieces changing
+ */
+void Renderer::onBoardChange() {
+	highlightsChanged = true;
+	needsRedraw = true;
 }
 
 
@@ -364,7 +689,7 @@ void Renderer::onZoom(const float delta) {
  * Get the cursor's exact tile coordinates
  */
 sf::Vector2f Renderer::getMousePosition() const {
-	sf::Vector2i screenPos = sf::Mouse::getPosition(*window);
+	sf::Vector2i screenPos = getMouseScreenPos();
 
 	return sf::Vector2f(
 		(screenPos.x - tileStartPos.x) / tileSize + cameraPos.x - dimensionsInTiles.x / 2,
@@ -376,12 +701,7 @@ sf::Vector2f Renderer::getMousePosition() const {
  * Get the cursor's tile coordinates
  */
 sf::Vector2i Renderer::getMouseTilePosition() const {
-	sf::Vector2i screenPos = sf::Mouse::getPosition(*window);
-
-	return sf::Vector2i(
-		std::floor((screenPos.x - tileStartPos.x) / tileSize + cameraPos.x - dimensionsInTiles.x / 2),
-		std::floor((screenPos.y - tileStartPos.y) / tileSize + cameraPos.y - dimensionsInTiles.y / 2)
-	);
+	return getTilePos(sf::Vector2f(getMouseScreenPos()));
 }
 
 /**
@@ -395,9 +715,9 @@ bool Renderer::shouldGenerate(sf::Vector2i baseVector, sf::Vector2i pos) const {
 	const sf::Vector2i screenPos = getScreenPos(pos);
 
 	const int leftBoundary = -tileSize;
-	const int rightBoundary = (int) window->getSize().x;
+	const int rightBoundary = (int) target->getSize().x;
 	const int topBoundary = -tileSize;
-	const int bottomBoundary = (int) window->getSize().y;
+	const int bottomBoundary = (int) target->getSize().y;
 
 	const bool insideX =
 		(baseVector.x < 0 && screenPos.x > leftBoundary) ||
@@ -414,6 +734,11 @@ bool Renderer::shouldGenerate(sf::Vector2i baseVector, sf::Vector2i pos) const {
  * Determine whether a move marker should generate another move marker
  */
 bool Renderer::shouldGenerate(const MoveMarker* terminal) const {
+	// Move markers are not extended while zoomed out, since the screen may span far more tiles than can be generated
+	if (isZoomedOut()) {
+		return false;
+	}
+
 	return shouldGenerate(terminal->getBaseVector(), terminal->getNextPos());
 }
 
@@ -421,6 +746,11 @@ bool Renderer::shouldGenerate(const MoveMarker* terminal) const {
  * Determine whether a move marker should be deleted
  */
 bool Renderer::shouldDelete(const MoveMarker* terminal) const {
+	// Move markers are kept while zoomed out, so that they do not need to be generated again when zooming back in
+	if (isZoomedOut()) {
+		return false;
+	}
+
 	return
 		(terminal->getPrev() != nullptr) &&
 		!(shouldGenerate(terminal->getBaseVector(), terminal->getPrev()->getPos()));
@@ -451,11 +781,28 @@ void Renderer::moveCamera(const sf::Vector2f translationVec) {
 	setCameraPos(cameraPos + translationVec);
 }
 
+/**
+ * Set the tile size, within the range that can be zoomed to
+ */
+void Renderer::setTileSize(const float size) {
+	tileSize = std::max(MIN_TILE_SIZE, std::min(size, MAX_TILE_SIZE));
+	onResize(target->getSize().x, target->getSize().y);
+}
+
+/**
+ * Toggle the performance HUD
+ */
+void Renderer::toggleHud() {
+	displayHud ^= 1;
+	needsRedraw = true;
+}
+
 /**
  * Toggle displaying debug data
  */
 void Renderer::toggleDisplayDebugData() {
 	displayDebugData ^= 1;
+	highlightsChanged = true;
 	needsRedraw = true;
 }
 
@@ -467,22 +814,259 @@ void Renderer::toggleDisplayDebugData() {
  * Draw the board and pieces
  */
 void Renderer::draw() {
+	prepareFrame();
+	presentFrame();
+}
+
+/**
+ * Build a frame from the game state and publish it to be drawn, if a redraw is needed
+ */
+void Renderer::prepareFrame() {
 	// Do nothing if a redraw isn't needed
 	if (!needsRedraw) {
 		return;
 	}
 
-	window->clear(BACKGROUND_COLOR);
-	drawBoard();
-	drawOverlays();
-	drawPieces();
-	drawUILayers();
+	Trace::Span span("prepare");
+	Frame& frame = frames.getWriteBuffer();
+	frame.windowSize = target->getSize();
+	drawBoard(frame);
+	drawOverlays(frame);
+	drawPieces(frame);
+	frame.displayMenu = displayMenu;
 
 	// Draw debug data
+	frame.debugLines.clear();
 	if (displayDebugData) {
-		drawDebug();
+		drawDebug(frame);
 	}
 
-	window->display();
+	// Count what the performance HUD shows
+	frame.displayHud = displayHud;
+	frame.simMillis = simMillis;
+	simMillis = 0;
+	if (displayHud) {
+		frame.pieces = game->pieceTracker->pieces->size();
+		frame.moveMarkers = Metrics::read(Metrics::MOVE_MARKERS);
+		frame.listeners = game->controller->getNumListeners();
+	}
+
+	// Pass on the earliest input that has not been drawn
+	frame.hasInput = inputPending;
+	frame.inputTime = inputTime;
+	inputPending = false;
+
+	frames.publish();
 	needsRedraw = false;
+
+	// Taking the lock makes sure that the drawing thread is either waiting or will see the frame
+	{
+		std::lock_guard<std::mutex> lock(presentMutex);
+	}
+
+	framePublished.notify_one();
+}
+
+/**
+ * Draw the latest published frame, unless it has already been drawn
+ *
+ * @return true if a frame was drawn
+ */
+bool Renderer::presentFrame() {
+	if (!frames.update()) {
+		return false;
+	}
+
+	drawFrame(frames.getReadBuffer());
+	return true;
+}
+
+/**
+ * Wait until a frame is published that has not been drawn, or until drawing is stopped
+ *
+ * @return false if drawing was stopped
+ */
+bool Renderer::waitForFrame() {
+	std::unique_lock<std::mutex> lock(presentMutex);
+	framePublished.wait(lock, [this]{ return presentStopped || frames.isFresh(); });
+	return !presentStopped;
+}
+
+/**
+ * Stop the thread that draws the frames from waiting for another one
+ */
+void Renderer::stopPresenting() {
+	{
+		std::lock_guard<std::mutex> lock(presentMutex);
+		presentStopped = true;
+	}
+
+	framePublished.notify_one();
+}
+
+/**
+ * Fill a vertex array with a quad for each coloured tile of a checkerboard, so that it can be drawn in one call
+ *
+ * @param vertices   the vertex array to fill
+ * @param dimensions the dimensions of the board in tiles
+ * @param parity     the parity of x + y for the coloured tiles
+ * @param tileSize   the width and height of a tile
+ * @param color      the colour of the tiles
+ */
+void Renderer::buildBoard(
+	sf::VertexArray& vertices, sf::Vector2u dimensions, unsigned int parity, float tileSize, sf::Color color
+) {
+	vertices.setPrimitiveType(sf::Quads);
+	vertices.clear();
+
+	for (unsigned int x = 0; x < dimensions.x; x++) {
+		for (unsigned int y = 0; y < dimensions.y; y++) {
+			// Determine whether the tile needs to be colored
+			if ((x + y) % 2 == parity) {
+				appendTile(vertices, sf::Vector2f(tileSize * x, tileSize * y), tileSize, color);
+			}
+		}
+	}
+}
+
+/**
+ * Append a quad for a tile
+ *
+ * @param vertices the vertex array to append to
+ * @param pos      the top left corner of the tile on screen
+ * @param tileSize the width and height of the tile
+ * @param color    the color to fill with
+ */
+void Renderer::appendTile(sf::VertexArray& vertices, sf::Vector2f pos, float tileSize, sf::Color color) {
+	vertices.append(sf::Vertex(pos, color));
+	vertices.append(sf::Vertex(pos + sf::Vector2f(tileSize, 0), color));
+	vertices.append(sf::Vertex(pos + sf::Vector2f(tileSize, tileSize), color));
+	vertices.append(sf::Vertex(pos + sf::Vector2f(0, tileSize), color));
+}
+
+/**
+ * Append a quad for a piece, textured with its region of the atlas
+ *
+ * @param vertices the vertex array to append to
+ * @param pos      the top left corner of the piece on screen
+ * @param scale    the scale of the texture
+ * @param region   the region of the atlas that holds the piece's texture
+ * @param color    the team color to tint the texture with
+ */
+void Renderer::appendPiece(
+	sf::VertexArray& vertices, sf::Vector2f pos, float scale, const sf::IntRect& region, sf::Color color
+) {
+	const float width = region.width * scale;
+	const float height = region.height * scale;
+	const float left = region.left;
+	const float top = region.top;
+	const float right = left + region.width;
+	const float bottom = top + region.height;
+
+	vertices.append(sf::Vertex(pos, color, sf::Vector2f(left, top)));
+	vertices.append(sf::Vertex(pos + sf::Vector2f(width, 0), color, sf::Vector2f(right, top)));
+	vertices.append(sf::Vertex(pos + sf::Vector2f(width, height), color, sf::Vector2f(right, bottom)));
+	vertices.append(sf::Vertex(pos + sf::Vector2f(0, height), color, sf::Vector2f(left, bottom)));
+}
+
+/**
+ * Get the color of a team
+ *
+ * @param teams the names and colors of the teams
+ * @param team  the team to get the color of
+ *
+ * @return the team's color, or white if there is no such team
+ */
+sf::Color Renderer::getTeamColor(
+	const std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams, unsigned int team
+) {
+	std::map<const unsigned int, std::pair<const std::string, sf::Color>>::const_iterator teamIter = teams->find(team);
+	return (teamIter == teams->end()) ? (sf::Color::White) : (teamIter->second.second);
+}
+
+/**
+ * Draw the board and the visible pieces to a target, laid out around the camera as the renderer lays out a window of
+ * the same size. Pieces without a texture are drawn as circles. Nothing is drawn over the board or the pieces.
+ *
+ * @param target    the target to draw to, which is cleared first
+ * @param pieces    the pieces on the board, sorted by column
+ * @param teams     the names and colors of the teams
+ * @param atlas     the atlas of piece textures
+ * @param regions   the region of the atlas that holds each piece's texture
+ * @param cameraPos the tile at the centre of the target
+ * @param tileSize  the width and height of a tile
+ */
+void Renderer::drawPosition(
+	sf::RenderTarget& target,
+	const std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces,
+	const std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams,
+	const sf::Texture* atlas, const std::map<std::string, sf::IntRect>* regions,
+	sf::Vector2f cameraPos, float tileSize
+) {
+	const sf::Vector2u size = target.getSize();
+	target.setView(sf::View(sf::FloatRect(0, 0, size.x, size.y)));
+	target.clear(BACKGROUND_COLOR);
+
+	// Lay out the tiles as onResize and onCameraMove do
+	const sf::Vector2u dimensions(
+		2 * (TILE_PADDING + std::floor(size.x / tileSize / 2.f)),
+		2 * (TILE_PADDING + std::floor(size.y / tileSize / 2.f))
+	);
+	const unsigned int parity = ((dimensions.x + dimensions.y) / 2) % 2;
+	const sf::Vector2f tileStartPos(
+		(size.x / 2.f) - tileSize * (dimensions.x / 2.f),
+		(size.y / 2.f) - tileSize * (dimensions.y / 2.f)
+	);
+
+	// Draw the board, shifted to the camera
+	sf::VertexArray vertices(sf::Quads);
+	buildBoard(vertices, dimensions, parity, tileSize, FOREGROUND_COLOR);
+
+	sf::Transform shift;
+	shift.translate(tileStartPos + sf::Vector2f(
+		- tileSize * std::fmod(cameraPos.x, 2.f),
+		- tileSize * std::fmod(cameraPos.y, 2.f)
+	));
+	target.draw(vertices, sf::RenderStates(shift));
+
+	// Find the tiles on the target
+	const sf::Vector2i minTile(
+		std::floor(-tileStartPos.x / tileSize + cameraPos.x - dimensions.x / 2),
+		std::floor(-tileStartPos.y / tileSize + cameraPos.y - dimensions.y / 2)
+	);
+	const sf::Vector2i maxTile(
+		std::floor((size.x - tileStartPos.x) / tileSize + cameraPos.x - dimensions.x / 2),
+		std::floor((size.y - tileStartPos.y) / tileSize + cameraPos.y - dimensions.y / 2)
+	);
+
+	// Draw the visible pieces in each column, from the atlas in one call unless they have no texture
+	vertices.clear();
+	for (int x = minTile.x; x <= maxTile.x; x++) {
+		for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::const_iterator it =
+				pieces->lower_bound(sf::Vector2i(x, minTile.y));
+			it != pieces->end() && it->first.x == x && it->first.y <= maxTile.y;
+			++it
+		) {
+			const Piece* p = it->second;
+			const sf::Color teamColor = getTeamColor(teams, p->team);
+			const sf::Vector2f pos(
+				tileStartPos.x + tileSize * (p->pos.x - cameraPos.x + dimensions.x / 2),
+				tileStartPos.y + tileSize * (p->pos.y - cameraPos.y + dimensions.y / 2)
+			);
+
+			std::map<std::string, sf::IntRect>::const_iterator region = regions->find(p->pieceDef->name);
+			if (region == regions->end()) {
+				sf::CircleShape s(tileSize / 2);
+				s.setFillColor(teamColor);
+				s.setPosition(pos);
+				target.draw(s);
+			} else {
+				appendPiece(vertices, pos, tileSize / 16, region->second, teamColor);
+			}
+		}
+	}
+
+	if (vertices.getVertexCount() > 0) {
+		target.draw(vertices, sf::RenderStates(atlas));
+	}
 }
@@ -2,8 +2,19 @@
 #define CHESS_RENDERER_H
 
 #include <SFML/Graphics.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 #include "game.h"
+#include "ui/performanceHud.h"
+#include "utils/chunkIndex.h"
+#include "utils/tripleBuffer.h"
+#include "utils/vectorUtils.h"
 
 // Forward declarations
 class Game;
@@ -16,12 +27,62 @@ class WindowLayer;
 // Class declaration
 class Renderer {
 private:
+	// Helper structs
+
+	/**
+	 * Everything that is drawn in a frame. It is built from the game state on the thread that runs the game, and is
+	 * only read after it has been published, so it can be drawn on another thread.
+	 */
+	struct Frame {
+		sf::Vector2u windowSize;
+		float tileSize = 0;
+
+		// The board and the selection overlay, which are copied when they have changed since the frame was last built
+		unsigned int boardVersion = 0;
+		unsigned int highlightVersion = 0;
+		sf::VertexArray boardVertices{sf::Quads};
+		sf::VertexArray highlightVertices{sf::Quads};
+		sf::Vector2f boardShift;
+
+		// The visible pieces, which are drawn from the atlas unless they have no texture, or a cell for each chunk of
+		// pieces when zoomed out
+		sf::VertexArray pieceVertices{sf::Quads};
+		sf::VertexArray densityVertices{sf::Quads};
+		std::vector<std::pair<sf::Vector2f, sf::Color>> circles;
+
+		// The hovered tile, the menu and the debug data
+		sf::VertexArray cursorVertices{sf::Quads};
+		bool displayMenu = false;
+		std::vector<std::string> debugLines;
+
+		// The counts for the performance HUD, and the time spent on the rules since the last frame was built
+		bool displayHud = false;
+		std::size_t piecesDrawn = 0;
+		std::size_t pieces = 0;
+		std::size_t moveMarkers = 0;
+		std::size_t listeners = 0;
+		float simMillis = 0;
+
+		// The time of the earliest input that the frame is the first to draw, if any
+		bool hasInput = false;
+		std::chrono::steady_clock::time_point inputTime;
+	};
+
 	// Configuration constants
-	const unsigned int TILE_PADDING  = 3;
+	static const unsigned int TILE_PADDING = 3;
 	const unsigned int MAX_FRAMERATE = 60;
-	const float MIN_TILE_SIZE =  16.f;
+	const float MIN_TILE_SIZE =   0.01f;
 	const float MAX_TILE_SIZE = 256.f;
 
+	/**
+	 * Below this tile size, the tiles, pieces and moves are no longer drawn, and a cell is drawn for each chunk of
+	 * pieces instead. The chunks are the smallest that are at least LOD_CELL_SIZE pixels wide.
+	 */
+	const float LOD_TILE_SIZE   = 16.f;
+	const float LOD_CELL_SIZE   = 16.f;
+	const float LOD_ZOOM_FACTOR =  1.25f;
+	const unsigned int LOD_MIN_ALPHA = 96;
+
 	// Resources
 	const std::string FONT_DIRECTORY      = "res/font/";
 	const std::string DEBUG_FONT_FILENAME = "OpenSans-Regular.ttf";
@@ -29,8 +90,8 @@ private:
 
 	const std::string WINDOW_ICON = "King";
 
-	const sf::Color BACKGROUND_COLOR     = sf::Color(  0,   0,   0, 255);
-	const sf::Color FOREGROUND_COLOR     = sf::Color( 50,  50,  50, 255);
+	static const sf::Color BACKGROUND_COLOR;
+	static const sf::Color FOREGROUND_COLOR;
 	const sf::Color MOUSE_DEBUG_COLOR    = sf::Color(255, 255, 255, 100);
 	const sf::Color MOUSE_VALID_COLOR    = sf::Color(  0, 255,   0, 100);
 	const sf::Color MOUSE_INVALID_COLOR  = sf::Color(255,   0,   0, 100);
@@ -40,36 +101,92 @@ private:
 	// Flags
 	bool displayDebugData = false;
 	bool displayMenu = false;
+	bool displayHud = false;
+	bool highlightsChanged = true;
+	bool inputPending = false;
 
 	// Members
 	Game* game;
+
+	// The window, or the texture when drawing offscreen, and whichever of them is drawn to
 	sf::RenderWindow* window;
+	sf::RenderTexture* offscreen;
+	sf::RenderTarget* target;
 
 	std::map<std::string, sf::Texture*>* textures;
 	std::map<std::string, sf::Texture*>* uiTextures;
+	sf::Texture* pieceAtlas;
+	std::map<std::string, sf::IntRect>* pieceRegions;
 	std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams;
 	std::vector<WindowLayer*> layers;
 
 	unsigned int parity;
 	float tileSize = 50;
 
+	// The time of the earliest input that has not been drawn yet
+	std::chrono::steady_clock::time_point inputTime;
+
 	sf::Vector2u dimensionsInTiles;
 	sf::Vector2f tileStartPos;
 	sf::Vector2f cameraShift;
 	sf::Vector2f cameraPos;
 
+	/**
+	 * The coloured tiles of the board, relative to the start position. Only rebuilt when the window is resized or
+	 * zoomed, since moving the camera only shifts them.
+	 */
+	sf::VertexArray boardVertices;
+	unsigned int boardVersion = 0;
+
+	/**
+	 * The selected piece and its moves, only rebuilt when the selection, the board or the camera changes
+	 */
+	sf::VertexArray highlightVertices;
+	unsigned int highlightVersion = 0;
+
+	/**
+	 * The frames passed from the thread that builds them to the thread that draws them
+	 */
+	TripleBuffer<Frame> frames;
+
+	// Wakes the thread that draws the frames when a frame is published or drawing stops
+	std::mutex presentMutex;
+	std::condition_variable framePublished;
+	bool presentStopped = false;
+
+	// The time spent on the rules since the last frame was built
+	float simMillis = 0;
+
+	// The window size that the view was last set for, which is only used by the thread that draws the frames
+	sf::Vector2u viewSize;
+
+	// The text for the debug data and the performance HUD, which is kept between frames so that its geometry is only
+	// rebuilt when it changes. Only used by the thread that draws the frames.
+	std::vector<sf::Text> debugTexts;
+	PerformanceHud hud;
+	sf::Clock frameTimer;
+	std::uint64_t lastAllocations = 0;
+
 	// Utility methods
 	sf::Vector2i getScreenPos(sf::Vector2i pos) const;
+	sf::Vector2i getTilePos(sf::Vector2f screenPos) const;
+	sf::Vector2i getMouseScreenPos() const;
 
-	void drawBoard() const;
-	void drawPieces() const;
-	void drawOverlays() const;
+	void drawBoard(Frame& frame) const;
+	void drawPieces(Frame& frame) const;
+	void drawDensity(Frame& frame) const;
+	void drawChunk(Frame& frame, sf::Vector2i chunkPos, unsigned int level, const ChunkIndex::Chunk& chunk) const;
+	void drawOverlays(Frame& frame);
+	void buildHighlights();
 	void drawUILayers() const;
 
-	void drawDebugText(const std::string& s, const unsigned int row) const;
-	void drawPiece(Piece* p) const;
-	void drawTile(const int x, const int y, const sf::Color c) const;
-	void drawDebug() const;
+	void drawDebugText(const std::string& s, const unsigned int row);
+	void drawPiece(Frame& frame, Piece* p) const;
+	void drawTile(Frame& frame, const int x, const int y, const sf::Color c) const;
+	void highlightTile(const int x, const int y, const sf::Color c);
+	void drawDebug(Frame& frame) const;
+	void drawHud(const Frame& frame, float renderMillis);
+	void drawFrame(const Frame& frame);
 
 public:
 	// Flags
@@ -77,6 +194,7 @@ public:
 
 	// Constructors
 	Renderer(Game* g, sf::RenderWindow* w);
+	Renderer(Game* g, sf::RenderTexture* t);
 	~Renderer();
 
 	// Event handlers
@@ -88,6 +206,9 @@ public:
 	void onResize(const unsigned int width, const unsigned int height);
 	void onCameraMove();
 	void onZoom(const float delta);
+	void onBoardChange();
+	void onInput();
+	void onSimulated(float millis);
 
 	// Accessors
 	sf::Vector2f getMousePosition() const;
@@ -100,10 +221,20 @@ public:
         return displayMenu;
 	};
 
+	/**
+	 * Whether the view is zoomed out far enough that chunks of pieces are drawn instead of the tiles and pieces. Move
+	 * markers are not extended or deleted and the board cannot be clicked while it is.
+	 */
+	inline bool isZoomedOut() const {
+		return tileSize < LOD_TILE_SIZE;
+	}
+
 	// Mutators
 	void setCameraPos(const sf::Vector2f pos);
 	void moveCamera(const sf::Vector2f translationVec);
+	void setTileSize(const float size);
 	void toggleDisplayDebugData();
+	void toggleHud();
 	void toggleMenu();
 
 	void addLayer(WindowLayer* layer) {
@@ -112,6 +243,47 @@ public:
 
 	// Utility methods
 	void draw();
+	void prepareFrame();
+	bool presentFrame();
+	bool waitForFrame();
+	void stopPresenting();
+
+	/**
+	 * Fill a vertex array with a quad for each coloured tile of a checkerboard
+	 */
+	static void buildBoard(
+		sf::VertexArray& vertices, sf::Vector2u dimensions, unsigned int parity, float tileSize, sf::Color color
+	);
+
+	/**
+	 * Append a quad for a tile
+	 */
+	static void appendTile(sf::VertexArray& vertices, sf::Vector2f pos, float tileSize, sf::Color color);
+
+	/**
+	 * Append a quad for a piece, textured with its region of the atlas
+	 */
+	static void appendPiece(
+		sf::VertexArray& vertices, sf::Vector2f pos, float scale, const sf::IntRect& region, sf::Color color
+	);
+
+	/**
+	 * Get the color of a team, or white if there is no such team
+	 */
+	static sf::Color getTeamColor(
+		const std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams, unsigned int team
+	);
+
+	/**
+	 * Draw the board and the pieces on it to a target without a game, as the renderer draws them in a frame
+	 */
+	static void drawPosition(
+		sf::RenderTarget& target,
+		const std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces,
+		const std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams,
+		const sf::Texture* atlas, const std::map<std::string, sf::IntRect>* regions,
+		sf::Vector2f cameraPos, float tileSize
+	);
 };
 
 #endif // CHESS_RENDERER_H
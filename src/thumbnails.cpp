@@ -0,0 +1,164 @@
+#include "thumbnails.h"
+
+#include <iostream>
+#include <thread>
+#include <tuple>
+#include "renderer.h"
+#include "components/piece.h"
+#include "io/boardLoader.h"
+#include "io/pieceDefLoader.h"
+#include "io/resourceLoader.h"
+
+// Helpers
+
+/**
+ * Render boards until the batch is finished, reusing one render texture for all of them
+ */
+void Thumbnails::renderBoards(
+	const std::vector<std::string>* boardFileNames, const std::vector<std::string>* imageFileNames,
+	std::atomic<unsigned int>* nextBoard, Result* result
+) const {
+	sf::RenderTexture target;
+	const bool created = target.create(size.x, size.y);
+
+	for (unsigned int i = (*nextBoard)++; i < boardFileNames->size(); i = (*nextBoard)++) {
+		if (created && render(target, (*boardFileNames)[i], (*imageFileNames)[i])) {
+			result->images++;
+		} else {
+			result->failures++;
+		}
+	}
+}
+
+
+
+// Constructors
+
+/**
+ * Constructor, which loads the piece definitions and packs their textures into an atlas
+ *
+ * @param texturesDirectory the directory that holds a texture for each piece definition
+ * @param cameraPos_        the tile at the centre of each image
+ * @param tileSize_         the width and height of a tile in pixels
+ * @param size_             the dimensions of each image in pixels
+ *
+ * @throw ResourceLoader::FileFormatException if the piece definitions are invalid
+ * @throw ResourceLoader::IOException if the piece definitions cannot be opened
+ */
+Thumbnails::Thumbnails(
+	const std::string& pieceDefsFileName, const std::string& texturesDirectory, sf::Vector2f cameraPos_,
+	float tileSize_, sf::Vector2u size_
+) :
+	cameraPos{cameraPos_},
+	tileSize{tileSize_},
+	size{size_},
+	pieceDefs{PieceDefLoader::loadPieceDefs(pieceDefsFileName)}
+{
+	std::vector<std::string>* names = new std::vector<std::string>();
+	for (std::map<std::string, const PieceDef*>::const_iterator i = pieceDefs->begin(); i != pieceDefs->end(); ++i) {
+		names->push_back(i->first);
+	}
+
+	textures = ResourceLoader::loadTextures(names, texturesDirectory, ".png");
+	regions = new std::map<std::string, sf::IntRect>();
+	atlas = ResourceLoader::packTextures(textures, regions);
+	delete names;
+}
+
+/**
+ * Destructor
+ */
+Thumbnails::~Thumbnails() {
+	delete atlas;
+	delete regions;
+	for (std::map<std::string, sf::Texture*>::iterator i = textures->begin(); i != textures->end(); ++i) {
+		delete i->second;
+	}
+	delete textures;
+
+	for (std::map<std::string, const PieceDef*>::iterator i = pieceDefs->begin(); i != pieceDefs->end(); ++i) {
+		delete i->second;
+	}
+	delete pieceDefs;
+}
+
+
+
+// Methods
+
+/**
+ * Render a saved board to an image
+ *
+ * @param target        the render texture to draw to, which sets the size of the image
+ * @param boardFileName the saved board
+ * @param imageFileName the image to write, whose extension sets its format
+ *
+ * @return false if the board could not be loaded or the image could not be written
+ */
+bool Thumbnails::render(
+	sf::RenderTexture& target, const std::string& boardFileName, const std::string& imageFileName
+) const {
+	std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams;
+	unsigned int curTurn;
+	std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces;
+	try {
+		std::tie(teams, curTurn, pieces) = BoardLoader::loadBoard(boardFileName, pieceDefs);
+	} catch (const std::exception& e) {
+		// Write the message in one call, so that it is not interleaved with the messages of other threads
+		std::cerr << ("Failed to load " + boardFileName + ": " + e.what() + "\n");
+		return false;
+	}
+
+	Renderer::drawPosition(target, pieces, teams, atlas, regions, cameraPos, tileSize);
+	target.display();
+	const bool saved = target.getTexture().copyToImage().saveToFile(imageFileName);
+
+	// Clean up
+	for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::iterator i = pieces->begin();
+		i != pieces->end(); ++i
+	) {
+		delete i->second;
+	}
+	delete pieces;
+	delete teams;
+
+	return saved;
+}
+
+/**
+ * Render a batch of saved boards split between threads, each with its own render texture
+ *
+ * @param boardFileNames the saved boards
+ * @param imageFileNames the image to write for each board
+ */
+Thumbnails::Result Thumbnails::run(
+	const std::vector<std::string>& boardFileNames, const std::vector<std::string>& imageFileNames,
+	unsigned int numThreads
+) const {
+	if (numThreads == 0) {
+		numThreads = 1;
+	}
+
+	std::vector<Result> results(numThreads, Result{0, 0});
+	std::vector<std::thread> threads;
+	std::atomic<unsigned int> nextBoard(0);
+
+	for (unsigned int i = 0; i < numThreads; i++) {
+		threads.push_back(std::thread(
+			&Thumbnails::renderBoards, this, &boardFileNames, &imageFileNames, &nextBoard, &results[i]
+		));
+	}
+
+	for (std::vector<std::thread>::iterator i = threads.begin(); i != threads.end(); ++i) {
+		i->join();
+	}
+
+	// Combine the results
+	Result result{0, 0};
+	for (std::vector<Result>::const_iterator i = results.begin(); i != results.end(); ++i) {
+		result.images += i->images;
+		result.failures += i->failures;
+	}
+
+	return result;
+}
@@ -0,0 +1,62 @@
+#ifndef CHESS_THUMBNAILS_H
+#define CHESS_THUMBNAILS_H
+
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+#include "components/pieceDef.h"
+
+// Class declaration
+
+/**
+ * Renders saved boards to images without a game window, drawing them as the renderer would draw a window of the same
+ * size. The piece definitions and textures are loaded once and shared by every thread.
+ */
+class Thumbnails {
+public:
+	// Helper structs
+
+	/**
+	 * The number of boards that were rendered and that could not be rendered
+	 */
+	struct Result {
+		unsigned int images;
+		unsigned int failures;
+	};
+
+private:
+	// Members
+	const sf::Vector2f cameraPos;
+	const float tileSize;
+	const sf::Vector2u size;
+
+	std::map<std::string, const PieceDef*>* pieceDefs;
+	std::map<std::string, sf::Texture*>* textures;
+	sf::Texture* atlas;
+	std::map<std::string, sf::IntRect>* regions;
+
+	// Helpers
+	void renderBoards(
+		const std::vector<std::string>* boardFileNames, const std::vector<std::string>* imageFileNames,
+		std::atomic<unsigned int>* nextBoard, Result* result
+	) const;
+
+public:
+	// Constructors
+	Thumbnails(
+		const std::string& pieceDefsFileName, const std::string& texturesDirectory, sf::Vector2f cameraPos_,
+		float tileSize_, sf::Vector2u size_
+	);
+	~Thumbnails();
+
+	// Methods
+	bool render(sf::RenderTexture& target, const std::string& boardFileName, const std::string& imageFileName) const;
+	Result run(
+		const std::vector<std::string>& boardFileNames, const std::vector<std::string>& imageFileNames,
+		unsigned int numThreads
+	) const;
+};
+
+#endif // CHESS_THUMBNAILS_H
@@ -0,0 +1,121 @@
+#include <SFML/Graphics.hpp>
+#include <iostream>
+#include <map>
+#include <string>
+#include <tuple>
+#include "../components/piece.h"
+#include "../components/pieceDef.h"
+#include "../io/binaryBoard.h"
+#include "../io/boardLoader.h"
+#include "../io/pieceDefLoader.h"
+#include "../io/resourceLoader.h"
+#include "../utils/vectorUtils.h"
+
+// Helpers
+
+/**
+ * Write a board in the text format, in the same way as the game saves it
+ */
+std::string boardToString(
+	const std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams,
+	unsigned int curTurn,
+	const std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces
+) {
+	// List the teams starting from the team to move, in the same way as the controller
+	std::string output = "[[";
+	std::map<const unsigned int, std::pair<const std::string, sf::Color>>::const_iterator team = teams->find(curTurn);
+	for (unsigned int i = 0; i < teams->size(); i++, ++team) {
+		if (team == teams->end()) {
+			team = teams->begin();
+		}
+
+		const sf::Color color = team->second.second;
+		output += "[" + std::to_string(team->first) + "," + team->second.first + ",[" +
+			std::to_string(color.r) + "," + std::to_string(color.g) + "," +
+			std::to_string(color.b) + "," + std::to_string(color.a) + ",],],\n";
+	}
+
+	output += "]," + std::to_string(curTurn) + ",[\n";
+	for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::const_iterator i =
+		pieces->begin(); i != pieces->end(); ++i
+	) {
+		output += i->second->toString() + ",\n";
+	}
+
+	return output + "],\n]";
+}
+
+/**
+ * Converts a board between the text and binary formats, in the direction given by the extensions of the files
+ *
+ * Usage: convertBoard <in.chess|in.chessb> <out.chessb|out.chess> [--defs pieces.def]
+ */
+int main(int argc, char* argv[]) {
+	if (argc != 3 && argc != 5) {
+		std::cerr << "Usage: " << argv[0] << " <in.chess|in.chessb> <out.chessb|out.chess> [--defs pieces.def]" <<
+			std::endl;
+		return 1;
+	}
+
+	const std::string inFileName = argv[1];
+	const std::string outFileName = argv[2];
+	std::string defsFile = "res/pieces.def";
+	if (argc == 5) {
+		if (std::string(argv[3]) != "--defs") {
+			std::cerr << "Invalid option: " << argv[3] << " " << argv[4] << std::endl;
+			return 1;
+		}
+
+		defsFile = argv[4];
+	}
+
+	const bool fromBinary = ResourceLoader::isValidFileName(inFileName, BinaryBoard::getExtension());
+	const bool toBinary = ResourceLoader::isValidFileName(outFileName, BinaryBoard::getExtension());
+	if (fromBinary == toBinary) {
+		std::cerr << "Exactly one of the files must have the extension " << BinaryBoard::getExtension() << std::endl;
+		return 1;
+	}
+
+	// Load the board
+	std::map<std::string, const PieceDef*>* pieceDefs;
+	std::map<const unsigned int, std::pair<const std::string, sf::Color>>* teams;
+	unsigned int curTurn;
+	std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>* pieces;
+	try {
+		pieceDefs = PieceDefLoader::loadPieceDefs(defsFile);
+		std::tie(teams, curTurn, pieces) = (fromBinary) ?
+			(BinaryBoard::loadBoard(inFileName, pieceDefs)) : (BoardLoader::loadBoard(inFileName, pieceDefs));
+	} catch (const std::exception& e) {
+		std::cerr << "Failed to load: " << e.what() << std::endl;
+		return 1;
+	}
+
+	// Save it in the other format
+	try {
+		if (toBinary) {
+			BinaryBoard::saveBoard(outFileName, teams, curTurn, pieces);
+		} else {
+			ResourceLoader::write(outFileName, boardToString(teams, curTurn, pieces));
+		}
+	} catch (const std::exception& e) {
+		std::cerr << "Failed to save: " << e.what() << std::endl;
+		return 1;
+	}
+
+	std::cout << pieces->size() << " pieces and " << teams->size() << " teams written to " << outFileName << std::endl;
+
+	// Clean up
+	for (std::map<sf::Vector2i, Piece*, VectorUtils::cmpVectorLexicographically>::iterator i = pieces->begin();
+		i != pieces->end(); ++i
+	) {
+		delete i->second;
+	}
+	delete pieces;
+	delete teams;
+	for (std::map<std::string, const PieceDef*>::iterator i = pieceDefs->begin(); i != pieceDefs->end(); ++i) {
+		delete i->second;
+	}
+	delete pieceDefs;
+
+	return 0;
+}
@@ -0,0 +1,100 @@
+#include <SFML/Graphics.hpp>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "../engine/boardFile.h"
+#include "../engine/playout.h"
+#include "../engine/position.h"
+
+/**
+ * Headless batch playouts for checking the balance of a setup
+ *
+ * Usage: playout <board.chess> [--games G] [--threads T] [--plies P] [--policy random|captures]
+ *                [--seed S] [--margin M] [--defs pieces.def]
+ */
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " <board.chess> [--games G] [--threads T] [--plies P] " <<
+			"[--policy random|captures] [--seed S] [--margin M] [--defs pieces.def]" << std::endl;
+		return 1;
+	}
+
+	const std::string boardFileName = argv[1];
+	unsigned int numGames = 1000;
+	unsigned int numThreads = std::thread::hardware_concurrency();
+	unsigned int maxPlies = 400;
+	Playout::Policy policy = Playout::CAPTURES;
+	unsigned int seed = 0;
+	unsigned int margin = 4;
+	std::string defsFile = "res/pieces.def";
+
+	// Read the options
+	for (int i = 2; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		const std::string value = argv[i + 1];
+		if (option == "--games") {
+			numGames = std::strtoul(value.c_str(), nullptr, 10);
+		} else if (option == "--threads") {
+			numThreads = std::strtoul(value.c_str(), nullptr, 10);
+		} else if (option == "--plies") {
+			maxPlies = std::strtoul(value.c_str(), nullptr, 10);
+		} else if (option == "--policy" && (value == "random" || value == "captures")) {
+			policy = (value == "random") ? (Playout::RANDOM) : (Playout::CAPTURES);
+		} else if (option == "--seed") {
+			seed = std::strtoul(value.c_str(), nullptr, 10);
+		} else if (option == "--margin") {
+			margin = std::strtoul(value.c_str(), nullptr, 10);
+		} else if (option == "--defs") {
+			defsFile = value;
+		} else {
+			std::cerr << "Invalid option: " << option << " " << value << std::endl;
+			return 1;
+		}
+	}
+
+	if (numThreads == 0) {
+		numThreads = 1;
+	}
+
+	// Load the board
+	BoardFile* boardFile;
+	try {
+		boardFile = new BoardFile(boardFileName, defsFile);
+	} catch (const std::exception& e) {
+		std::cerr << "Failed to load: " << e.what() << std::endl;
+		return 1;
+	}
+
+	const Position position = boardFile->getPosition(margin);
+	std::cout << "Playing " << numGames << " games of up to " << maxPlies << " moves with " <<
+		numThreads << " threads" << std::endl;
+
+	// Play
+	sf::Clock timer;
+	const Playout::Result result = Playout(position, policy, maxPlies, seed).run(numGames, numThreads);
+	const float seconds = timer.getElapsedTime().asSeconds();
+
+	// Report the outcomes
+	const double numPlayed = (result.games == 0) ? (1) : (result.games);
+	std::cout << std::fixed << std::setprecision(1);
+	for (std::size_t i = 0; i < result.wins.size(); i++) {
+		std::cout << std::setw(12) << std::left << position.getTeams()[i].name <<
+			std::setw(8) << std::right << result.wins[i] << std::setw(7) << (100 * result.wins[i] / numPlayed) << "%" <<
+			std::endl;
+	}
+	std::cout << std::setw(12) << std::left << "Draw" <<
+		std::setw(8) << std::right << result.draws << std::setw(7) << (100 * result.draws / numPlayed) << "%" << std::endl;
+	std::cout << std::setw(12) << std::left << "Timeout" <<
+		std::setw(8) << std::right << result.timeouts << std::setw(7) << (100 * result.timeouts / numPlayed) << "%" <<
+		std::endl;
+
+	std::cout << result.games << " games, " << (result.plies / numPlayed) << " moves per game, " <<
+		((seconds > 0) ? (result.games / seconds) : (0)) << " games/s" << std::endl;
+
+	// Clean up
+	delete boardFile;
+
+	return 0;
+}
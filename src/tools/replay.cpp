@@ -0,0 +1,106 @@
+#include <SFML/Graphics.hpp>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include "../components/pieceDef.h"
+#include "../engine/journalReplay.h"
+#include "../io/pieceDefLoader.h"
+
+/**
+ * Reconstructs a ply from a game journal and reports how quickly plies can be replayed
+ *
+ * Usage: replay <game.journal> [--ply N] [--seeks S] [--seed S] [--defs pieces.def]
+ */
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " <game.journal> [--ply N] [--seeks S] [--seed S] [--defs pieces.def]" <<
+			std::endl;
+		return 1;
+	}
+
+	const std::string journalFileName = argv[1];
+	bool hasPly = false;
+	unsigned int ply = 0;
+	unsigned int numSeeks = 1000;
+	unsigned int seed = 0;
+	std::string defsFile = "res/pieces.def";
+
+	// Read the options
+	for (int i = 2; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		const std::string value = argv[i + 1];
+		if (option == "--ply") {
+			hasPly = true;
+			ply = std::strtoul(value.c_str(), nullptr, 10);
+		} else if (option == "--seeks") {
+			numSeeks = std::strtoul(value.c_str(), nullptr, 10);
+		} else if (option == "--seed") {
+			seed = std::strtoul(value.c_str(), nullptr, 10);
+		} else if (option == "--defs") {
+			defsFile = value;
+		} else {
+			std::cerr << "Invalid option: " << option << " " << value << std::endl;
+			return 1;
+		}
+	}
+
+	// Load the journal
+	std::map<std::string, const PieceDef*>* pieceDefs;
+	JournalReplay* replay;
+	try {
+		pieceDefs = PieceDefLoader::loadPieceDefs(defsFile);
+		replay = new JournalReplay(journalFileName, pieceDefs);
+	} catch (const std::exception& e) {
+		std::cerr << "Failed to load: " << e.what() << std::endl;
+		return 1;
+	}
+
+	const unsigned int lastPly = replay->getLastPly();
+	if (!hasPly) {
+		ply = lastPly;
+	}
+
+	// Print the requested ply
+	if (!replay->seek(ply)) {
+		std::cerr << "The journal ends at ply " << lastPly << std::endl;
+		return 1;
+	}
+
+	std::cout << replay->boardToString() << std::endl;
+
+	// Replay the whole game from the first board
+	std::cerr << std::fixed << std::setprecision(1);
+	sf::Clock timer;
+	replay->seek(0, false);
+	replay->seek(lastPly, false);
+	const float replaySeconds = timer.getElapsedTime().asSeconds();
+
+	std::cerr << lastPly << " plies, " << replay->getNumCheckpoints() << " checkpoints" << std::endl;
+	std::cerr << "Replayed from the start at " << ((replaySeconds > 0) ? (lastPly / replaySeconds) : (0)) <<
+		" plies/s" << std::endl;
+
+	// Seek to random plies from their nearest checkpoints
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<unsigned int> randomPly(0, lastPly);
+	timer.restart();
+	for (unsigned int i = 0; i < numSeeks; i++) {
+		replay->seek(randomPly(random));
+	}
+	const float seekSeconds = timer.getElapsedTime().asSeconds();
+
+	if (numSeeks > 0) {
+		std::cerr << std::setprecision(3) << numSeeks << " random seeks, " << (1000 * seekSeconds / numSeeks) <<
+			" ms each" << std::endl;
+	}
+
+	// Clean up
+	delete replay;
+	for (std::map<std::string, const PieceDef*>::iterator i = pieceDefs->begin(); i != pieceDefs->end(); ++i) {
+		delete i->second;
+	}
+	delete pieceDefs;
+
+	return 0;
+}
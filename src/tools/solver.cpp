@@ -0,0 +1,79 @@
+#include <SFML/Graphics.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "../engine/boardFile.h"
+#include "../engine/mateSearch.h"
+#include "../engine/position.h"
+
+/**
+ * Headless mate-in-N solver
+ *
+ * Usage: solver <board.chess> <N> [--threads T] [--margin M] [--defs pieces.def]
+ */
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		std::cerr << "Usage: " << argv[0] << " <board.chess> <N> [--threads T] [--margin M] [--defs pieces.def]" << std::endl;
+		return 1;
+	}
+
+	const std::string boardFileName = argv[1];
+	const unsigned int maxMoves = std::strtoul(argv[2], nullptr, 10);
+	unsigned int numThreads = std::thread::hardware_concurrency();
+	unsigned int margin = 2;
+	std::string defsFile = "res/pieces.def";
+
+	// Read the options
+	for (int i = 3; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		if (option == "--threads") {
+			numThreads = std::strtoul(argv[i + 1], nullptr, 10);
+		} else if (option == "--margin") {
+			margin = std::strtoul(argv[i + 1], nullptr, 10);
+		} else if (option == "--defs") {
+			defsFile = argv[i + 1];
+		} else {
+			std::cerr << "Unknown option: " << option << std::endl;
+			return 1;
+		}
+	}
+
+	// Load the board
+	BoardFile* boardFile;
+	try {
+		boardFile = new BoardFile(boardFileName, defsFile);
+	} catch (const std::exception& e) {
+		std::cerr << "Failed to load: " << e.what() << std::endl;
+		return 1;
+	}
+
+	const Position position = boardFile->getPosition(margin);
+	std::cout << "Searching for a win in " << maxMoves << " for " << boardFile->getTeamName(position.getCurTurn()) <<
+		" with " << ((numThreads == 0) ? (1) : (numThreads)) << " threads" << std::endl;
+
+	// Search
+	sf::Clock timer;
+	const MateSearch::Result result = MateSearch(position, numThreads).solve(maxMoves);
+	const float seconds = timer.getElapsedTime().asSeconds();
+
+	if (result.found) {
+		std::cout << "Win in " << result.numMoves << ":" << std::endl;
+		for (std::vector<std::string>::const_iterator i = result.line.begin(); i != result.line.end(); ++i) {
+			std::cout << "  " << *i << std::endl;
+		}
+	} else {
+		std::cout << "No forced win in " << maxMoves << std::endl;
+	}
+
+	std::cout << result.nodes << " nodes in " << seconds << "s";
+	if (seconds > 0) {
+		std::cout << " (" << (unsigned long long) (result.nodes / seconds) << " nodes/s)";
+	}
+	std::cout << std::endl;
+
+	// Clean up
+	delete boardFile;
+
+	return result.found ? 0 : 2;
+}
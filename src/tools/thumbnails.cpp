@@ -0,0 +1,134 @@
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <dirent.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../thumbnails.h"
+#include "../io/resourceLoader.h"
+
+/**
+ * Headless batch rendering of saved boards to PNG images. Given a directory, every .chess file in it is rendered;
+ * given a .chess file, only that file is. Each image is named after its board and written to the output directory,
+ * which defaults to the directory of the boards.
+ *
+ * Usage: thumbnails <saves directory | board.chess> [--out DIR] [--camera-x X] [--camera-y Y] [--tile-size T]
+ *                   [--width W] [--height H] [--threads T] [--defs pieces.def]
+ */
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " <saves directory | board.chess> [--out DIR] [--camera-x X] " <<
+			"[--camera-y Y] [--tile-size T] [--width W] [--height H] [--threads T] [--defs pieces.def]" << std::endl;
+		return 1;
+	}
+
+	const std::string input = argv[1];
+	std::string outDirectory;
+	sf::Vector2f cameraPos;
+	float tileSize = 16;
+	sf::Vector2u size(256, 256);
+	unsigned int numThreads = std::thread::hardware_concurrency();
+	std::string defsFile = "res/pieces.def";
+
+	// Read the options
+	for (int i = 2; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		const std::string value = argv[i + 1];
+		if (option == "--out") {
+			outDirectory = value;
+		} else if (option == "--camera-x") {
+			cameraPos.x = std::strtof(value.c_str(), nullptr);
+		} else if (option == "--camera-y") {
+			cameraPos.y = std::strtof(value.c_str(), nullptr);
+		} else if (option == "--tile-size") {
+			tileSize = std::strtof(value.c_str(), nullptr);
+		} else if (option == "--width") {
+			size.x = std::strtoul(value.c_str(), nullptr, 10);
+		} else if (option == "--height") {
+			size.y = std::strtoul(value.c_str(), nullptr, 10);
+		} else if (option == "--threads") {
+			numThreads = std::strtoul(value.c_str(), nullptr, 10);
+		} else if (option == "--defs") {
+			defsFile = value;
+		} else {
+			std::cerr << "Invalid option: " << option << " " << value << std::endl;
+			return 1;
+		}
+	}
+
+	if (tileSize <= 0 || size.x == 0 || size.y == 0) {
+		std::cerr << "The tile size and image dimensions must be positive" << std::endl;
+		return 1;
+	}
+
+	if (numThreads == 0) {
+		numThreads = 1;
+	}
+
+	// Find the boards
+	std::vector<std::string> boardNames;
+	std::string inDirectory;
+	if (ResourceLoader::isValidFileName(input, ".chess")) {
+		const std::size_t slash = input.find_last_of("/\\");
+		inDirectory = (slash == std::string::npos) ? (".") : (input.substr(0, slash));
+		boardNames.push_back((slash == std::string::npos) ? (input) : (input.substr(slash + 1)));
+	} else {
+		inDirectory = input;
+		DIR* directory = opendir(input.c_str());
+		if (directory == nullptr) {
+			std::cerr << "Could not open " << input << std::endl;
+			return 1;
+		}
+
+		for (dirent* entry = readdir(directory); entry != nullptr; entry = readdir(directory)) {
+			const std::string name = entry->d_name;
+			if (name.length() > 6 && ResourceLoader::isValidFileName(name, ".chess")) {
+				boardNames.push_back(name);
+			}
+		}
+
+		closedir(directory);
+		std::sort(boardNames.begin(), boardNames.end());
+	}
+
+	if (outDirectory.empty()) {
+		outDirectory = inDirectory;
+	}
+
+	// Name each image after its board
+	std::vector<std::string> boardFileNames;
+	std::vector<std::string> imageFileNames;
+	for (std::vector<std::string>::const_iterator i = boardNames.begin(); i != boardNames.end(); ++i) {
+		boardFileNames.push_back(inDirectory + "/" + *i);
+		imageFileNames.push_back(outDirectory + "/" + i->substr(0, i->length() - 6) + ".png");
+	}
+
+	// Load the piece definitions and textures
+	Thumbnails* thumbnails;
+	try {
+		thumbnails = new Thumbnails(defsFile, "res/textures/pieces/", cameraPos, tileSize, size);
+	} catch (const std::exception& e) {
+		std::cerr << "Failed to load: " << e.what() << std::endl;
+		return 1;
+	}
+
+	std::cout << "Rendering " << boardFileNames.size() << " boards at " << size.x << "x" << size.y << " with " <<
+		numThreads << " threads" << std::endl;
+
+	// Render
+	sf::Clock timer;
+	const Thumbnails::Result result = thumbnails->run(boardFileNames, imageFileNames, numThreads);
+	const float seconds = timer.getElapsedTime().asSeconds();
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << result.images << " images, " << result.failures << " failed, " <<
+		((seconds > 0) ? (result.images / seconds) : (0)) << " images/s" << std::endl;
+
+	// Clean up
+	delete thumbnails;
+
+	return (result.failures == 0) ? (0) : (2);
+}
@@ -47,7 +47,7 @@ public:
 	virtual void draw(
 		const std::map<std::string, sf::Texture*>* textures,
 		const sf::Font font,
-		sf::RenderWindow* window
+		sf::RenderTarget* target
 	) {
 		sf::RectangleShape s(sf::Vector2f(dimensions.x, dimensions.y));
 		s.setPosition(pos.x, pos.y);
@@ -58,13 +58,13 @@ public:
 		} else {
 			s.setTexture(i->second);
 		}
-        window->draw(s);
+        target->draw(s);
 
         sf::Text t(text, font, 20);
         t.setOrigin(t.getLocalBounds().width / 2., t.getLocalBounds().height);
         t.setPosition(pos.x + dimensions.x / 2., pos.y + dimensions.y / 2.);
         t.setFillColor(sf::Color::Black);
-        window->draw(t);
+        target->draw(t);
 	}
 };
 
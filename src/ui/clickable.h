@@ -17,7 +17,7 @@ public:
     virtual void draw(
 		const std::map<std::string, sf::Texture*>* textures,
 		const sf::Font font,
-		sf::RenderWindow* window
+		sf::RenderTarget* target
 	) = 0;
 };
 
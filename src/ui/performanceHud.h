@@ -0,0 +1,195 @@
+#ifndef UI_PERFORMANCE_HUD_H
+#define UI_PERFORMANCE_HUD_H
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+/**
+ * A graph of the recent frame times, with the time spent on the rules and on drawing, the number of move markers,
+ * action listeners and pieces, and the heap allocations for each frame.
+ *
+ * The graph is rebuilt for every frame, but the text is only changed a few times a second, to the averages since it
+ * last changed, so its geometry is rebuilt no more often than that.
+ */
+class PerformanceHud {
+public:
+	// Helper structs
+
+	/**
+	 * The measurements for one frame
+	 */
+	struct Sample {
+		float frameMillis;
+		float simMillis;
+		float renderMillis;
+		std::uint64_t allocations;
+		std::size_t moveMarkers;
+		std::size_t listeners;
+		std::size_t pieces;
+		std::size_t piecesDrawn;
+	};
+
+private:
+	// Constants
+	static const unsigned int NUM_SAMPLES = 120;
+	static const unsigned int NUM_LINES = 5;
+	const unsigned int FONT_SIZE = 14;
+	const float BAR_WIDTH     = 2.f;
+	const float GRAPH_HEIGHT  = 60.f;
+	const float GRAPH_MILLIS  = 50.f;
+	const float TARGET_MILLIS = 1000.f / 60.f;
+	const sf::Time REFRESH_INTERVAL = sf::milliseconds(250);
+
+	const sf::Color BACKGROUND_COLOR = sf::Color(  0,   0,   0, 160);
+	const sf::Color FAST_COLOR       = sf::Color(  0, 255,   0, 200);
+	const sf::Color SLOW_COLOR       = sf::Color(255,   0,   0, 200);
+	const sf::Color TARGET_COLOR     = sf::Color(255, 255,   0, 200);
+
+	// Members
+
+	// The recent frame times, oldest first from the next one to be replaced
+	float frameMillis[NUM_SAMPLES] = {};
+	unsigned int nextSample = 0;
+
+	// The measurements added up since the text last changed
+	Sample total = {};
+	float maxFrameMillis = 0;
+	unsigned int numFrames = 0;
+	sf::Clock refreshTimer;
+
+	sf::VertexArray graph;
+	sf::Text lines[NUM_LINES];
+
+	// Helpers
+
+	/**
+	 * Rebuild the graph, with a bar for each frame and a line at the target frame time
+	 */
+	inline void buildGraph() {
+		const float width = NUM_SAMPLES * BAR_WIDTH;
+		graph.clear();
+		appendQuad(sf::Vector2f(0, 0), sf::Vector2f(width, GRAPH_HEIGHT + NUM_LINES * FONT_SIZE), BACKGROUND_COLOR);
+
+		for (unsigned int i = 0; i < NUM_SAMPLES; i++) {
+			const float millis = frameMillis[(nextSample + i) % NUM_SAMPLES];
+			const float height = GRAPH_HEIGHT * std::min(1.f, millis / GRAPH_MILLIS);
+			appendQuad(
+				sf::Vector2f(i * BAR_WIDTH, GRAPH_HEIGHT - height), sf::Vector2f(BAR_WIDTH, height),
+				(millis > TARGET_MILLIS) ? (SLOW_COLOR) : (FAST_COLOR)
+			);
+		}
+
+		appendQuad(sf::Vector2f(0, GRAPH_HEIGHT * (1 - TARGET_MILLIS / GRAPH_MILLIS)), sf::Vector2f(width, 1), TARGET_COLOR);
+	}
+
+	/**
+	 * Append a quad to the graph
+	 */
+	inline void appendQuad(sf::Vector2f corner, sf::Vector2f size, sf::Color color) {
+		graph.append(sf::Vertex(corner, color));
+		graph.append(sf::Vertex(corner + sf::Vector2f(size.x, 0), color));
+		graph.append(sf::Vertex(corner + size, color));
+		graph.append(sf::Vertex(corner + sf::Vector2f(0, size.y), color));
+	}
+
+	/**
+	 * Change the text to the averages since it last changed
+	 */
+	inline void refreshText(const Sample& latest) {
+		std::ostringstream s;
+		s << std::fixed << std::setprecision(2);
+
+		s << "Frame: " << (total.frameMillis / numFrames) << " ms, max " << maxFrameMillis << " ms";
+		lines[0].setString(s.str());
+		s.str("");
+		s << "Rules: " << (total.simMillis / numFrames) << " ms, drawing: " << (total.renderMillis / numFrames) << " ms";
+		lines[1].setString(s.str());
+		s.str("");
+		s << "Move markers: " << latest.moveMarkers << ", listeners: " << latest.listeners;
+		lines[2].setString(s.str());
+		s.str("");
+		s << "Pieces: " << latest.pieces << ", drawn: " << latest.piecesDrawn;
+		lines[3].setString(s.str());
+		s.str("");
+		s << "Allocations: " << std::setprecision(1) << ((float) total.allocations / numFrames) << " per frame";
+		lines[4].setString(s.str());
+	}
+
+public:
+	// Constructors
+
+	/**
+	 * Constructor
+	 *
+	 * @param font the font for the text, which may be loaded later
+	 */
+	inline PerformanceHud(const sf::Font& font) :
+		graph{sf::Quads}
+	{
+		for (unsigned int i = 0; i < NUM_LINES; i++) {
+			lines[i].setFont(font);
+			lines[i].setCharacterSize(FONT_SIZE);
+			lines[i].setFillColor(sf::Color::White);
+			lines[i].setPosition(0, GRAPH_HEIGHT + i * FONT_SIZE);
+		}
+
+		buildGraph();
+	}
+
+	// Accessors
+
+	/**
+	 * Get the width of the HUD
+	 */
+	inline float getWidth() const {
+		return NUM_SAMPLES * BAR_WIDTH;
+	}
+
+	// Methods
+
+	/**
+	 * Add the measurements for a frame
+	 */
+	inline void record(const Sample& sample) {
+		frameMillis[nextSample] = sample.frameMillis;
+		nextSample = (nextSample + 1) % NUM_SAMPLES;
+		buildGraph();
+
+		total.frameMillis += sample.frameMillis;
+		total.simMillis += sample.simMillis;
+		total.renderMillis += sample.renderMillis;
+		total.allocations += sample.allocations;
+		maxFrameMillis = std::max(maxFrameMillis, sample.frameMillis);
+		numFrames++;
+
+		if (refreshTimer.getElapsedTime() >= REFRESH_INTERVAL) {
+			refreshText(sample);
+			total = Sample{};
+			maxFrameMillis = 0;
+			numFrames = 0;
+			refreshTimer.restart();
+		}
+	}
+
+	/**
+	 * Draw the graph in one call, then the text
+	 *
+	 * @param target the target to draw to
+	 * @param pos    the top left corner of the HUD
+	 */
+	inline void draw(sf::RenderTarget& target, sf::Vector2f pos) const {
+		sf::Transform shift;
+		shift.translate(pos);
+
+		target.draw(graph, sf::RenderStates(shift));
+		for (unsigned int i = 0; i < NUM_LINES; i++) {
+			target.draw(lines[i], sf::RenderStates(shift));
+		}
+	}
+};
+
+#endif // UI_PERFORMANCE_HUD_H
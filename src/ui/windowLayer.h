@@ -34,10 +34,10 @@ public:
     virtual void draw(
 		const std::map<std::string, sf::Texture*>* textures,
 		const sf::Font font,
-		sf::RenderWindow* window
+		sf::RenderTarget* target
 	) {
 		for (std::vector<Clickable*>::iterator i = clickables.begin(); i != clickables.end(); ++i) {
-            (*i)->draw(textures, font, window);
+            (*i)->draw(textures, font, target);
     	}
     }
 };
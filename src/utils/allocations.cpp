@@ -0,0 +1,39 @@
+#include <cstdlib>
+#include <new>
+#include "metrics.h"
+
+// Allocation counting
+
+/**
+ * Count every heap allocation made with new, including the allocations made for arrays. This replaces the global
+ * operator new, so it is only linked into the targets that report allocations.
+ */
+void* operator new(std::size_t size) {
+	Metrics::countAllocation();
+	void* p = std::malloc((size == 0) ? (1) : (size));
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+
+	return p;
+}
+
+void* operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+	std::free(p);
+}
@@ -0,0 +1,130 @@
+#ifndef CHESS_CHUNK_INDEX_H
+#define CHESS_CHUNK_INDEX_H
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Class declaration
+
+/**
+ * Counts the pieces in square chunks of the board, for each team, at every power of two chunk size between
+ * 2^MIN_LEVEL and 2^MAX_LEVEL tiles. A zoomed out view can then be drawn from one cell per chunk, without visiting
+ * the pieces. Adding or removing a piece updates one chunk at each level.
+ */
+class ChunkIndex {
+public:
+	// Constants
+	static const unsigned int MIN_LEVEL = 1;
+	static const unsigned int MAX_LEVEL = 14;
+
+	// Helper structs
+
+	/**
+	 * The number of pieces in a chunk, and the number of them on each team
+	 */
+	struct Chunk {
+		unsigned int count = 0;
+		std::vector<std::pair<unsigned int, unsigned int>> teams;
+	};
+
+private:
+	// Members
+
+	/**
+	 * The chunks that hold pieces at each level, keyed by their position in chunks
+	 */
+	std::unordered_map<std::int64_t, Chunk> levels[MAX_LEVEL + 1];
+
+public:
+	// Helpers
+
+	/**
+	 * Get the key of a chunk
+	 */
+	static inline std::int64_t getKey(const sf::Vector2i chunk) {
+		return (static_cast<std::int64_t>(chunk.x) << 32) ^ static_cast<std::uint32_t>(chunk.y);
+	}
+
+	/**
+	 * Get the position of a key's chunk
+	 */
+	static inline sf::Vector2i getChunk(const std::int64_t key) {
+		return sf::Vector2i(key >> 32, static_cast<std::int32_t>(key));
+	}
+
+	/**
+	 * Get the chunk that contains a position at a level. Shifting rounds towards negative infinity, so the chunks on
+	 * either side of zero are the same size.
+	 */
+	static inline sf::Vector2i getChunk(const sf::Vector2i pos, const unsigned int level) {
+		return sf::Vector2i(pos.x >> level, pos.y >> level);
+	}
+
+	// Accessors
+
+	/**
+	 * Get the chunks that hold pieces at a level
+	 */
+	inline const std::unordered_map<std::int64_t, Chunk>& getChunks(const unsigned int level) const {
+		return levels[level];
+	}
+
+	// Methods
+
+	/**
+	 * Count a piece in the chunks that contain its position
+	 */
+	inline void add(const sf::Vector2i pos, const unsigned int team) {
+		for (unsigned int level = MIN_LEVEL; level <= MAX_LEVEL; level++) {
+			Chunk& chunk = levels[level][getKey(getChunk(pos, level))];
+			chunk.count++;
+
+			std::vector<std::pair<unsigned int, unsigned int>>::iterator i = chunk.teams.begin();
+			while (i != chunk.teams.end() && i->first != team) ++i;
+			if (i == chunk.teams.end()) {
+				chunk.teams.push_back(std::make_pair(team, 1));
+			} else {
+				i->second++;
+			}
+		}
+	}
+
+	/**
+	 * Stop counting a piece in the chunks that contain its position, dropping the chunks that are left empty
+	 */
+	inline void remove(const sf::Vector2i pos, const unsigned int team) {
+		for (unsigned int level = MIN_LEVEL; level <= MAX_LEVEL; level++) {
+			std::unordered_map<std::int64_t, Chunk>::iterator found = levels[level].find(getKey(getChunk(pos, level)));
+			if (found == levels[level].end()) continue;
+
+			Chunk& chunk = found->second;
+			if (--chunk.count == 0) {
+				levels[level].erase(found);
+				continue;
+			}
+
+			for (std::vector<std::pair<unsigned int, unsigned int>>::iterator i = chunk.teams.begin();
+				i != chunk.teams.end(); ++i
+			) {
+				if (i->first == team) {
+					if (--i->second == 0) chunk.teams.erase(i);
+					break;
+				}
+			}
+		}
+	}
+
+	/**
+	 * Stop counting every piece
+	 */
+	inline void clear() {
+		for (unsigned int level = MIN_LEVEL; level <= MAX_LEVEL; level++) {
+			levels[level].clear();
+		}
+	}
+};
+
+#endif // CHESS_CHUNK_INDEX_H
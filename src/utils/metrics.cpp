@@ -0,0 +1,285 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+	// Helper structs
+
+	/**
+	 * The counters for every probe. Only the owning thread writes to them, so they are updated with plain loads and
+	 * stores, and are atomic only so that they can be read from other threads.
+	 */
+	struct Counters {
+		std::atomic<std::uint64_t> count[Metrics::NUM_PROBES]{};
+		std::atomic<std::uint64_t> totalNanos[Metrics::NUM_PROBES]{};
+		std::atomic<std::uint64_t> maxNanos[Metrics::NUM_PROBES]{};
+		std::atomic<std::uint64_t> buckets[Metrics::NUM_PROBES][Metrics::NUM_BUCKETS]{};
+		std::atomic<std::int64_t> gauges[Metrics::NUM_GAUGES]{};
+	};
+
+	class ThreadCounters;
+
+	/**
+	 * The counters of the threads that are running, and the totals of the threads that have finished
+	 */
+	struct Registry {
+		std::mutex mutex;
+		std::vector<const ThreadCounters*> threads;
+		Counters finished;
+		std::atomic<std::uint64_t> finishedAllocations{0};
+	};
+
+	// Helpers
+
+	inline void add(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+	inline void add(std::atomic<std::int64_t>& counter, std::int64_t value) {
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+	inline void raise(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+		if (value > counter.load(std::memory_order_relaxed)) {
+			counter.store(value, std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * Add the counters for a probe to a histogram
+	 */
+	void addTo(Metrics::Histogram& histogram, const Counters& counters, Metrics::Probe probe) {
+		histogram.count += counters.count[probe].load(std::memory_order_relaxed);
+		histogram.totalNanos += counters.totalNanos[probe].load(std::memory_order_relaxed);
+		histogram.maxNanos = std::max(histogram.maxNanos, counters.maxNanos[probe].load(std::memory_order_relaxed));
+		for (unsigned int i = 0; i < Metrics::NUM_BUCKETS; i++) {
+			histogram.buckets[i] += counters.buckets[probe][i].load(std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * Get the registry, which is created the first time that a thread records anything
+	 */
+	Registry& getRegistry() {
+		static Registry registry;
+		return registry;
+	}
+
+	/**
+	 * The heap allocations made by this thread. It is constant initialised, so that counting an allocation does not
+	 * allocate, and is registered with the rest of the thread's counters the first time that the thread allocates.
+	 */
+	thread_local std::atomic<std::uint64_t> threadAllocations{0};
+	thread_local bool allocationsRegistered = false;
+
+	/**
+	 * The counters for one thread, which are registered for as long as the thread runs
+	 */
+	class ThreadCounters {
+	public:
+		Counters counters;
+		const std::atomic<std::uint64_t>* const allocations;
+
+		ThreadCounters() :
+			allocations{&threadAllocations}
+		{
+			Registry& registry = getRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			registry.threads.push_back(this);
+		}
+
+		/**
+		 * Destructor, which keeps the thread's counters in the totals for finished threads
+		 */
+		~ThreadCounters() {
+			Registry& registry = getRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			for (unsigned int probe = 0; probe < Metrics::NUM_PROBES; probe++) {
+				add(registry.finished.count[probe], counters.count[probe].load(std::memory_order_relaxed));
+				add(registry.finished.totalNanos[probe], counters.totalNanos[probe].load(std::memory_order_relaxed));
+				raise(registry.finished.maxNanos[probe], counters.maxNanos[probe].load(std::memory_order_relaxed));
+				for (unsigned int i = 0; i < Metrics::NUM_BUCKETS; i++) {
+					add(registry.finished.buckets[probe][i], counters.buckets[probe][i].load(std::memory_order_relaxed));
+				}
+			}
+
+			for (unsigned int gauge = 0; gauge < Metrics::NUM_GAUGES; gauge++) {
+				add(registry.finished.gauges[gauge], counters.gauges[gauge].load(std::memory_order_relaxed));
+			}
+
+			add(registry.finishedAllocations, allocations->load(std::memory_order_relaxed));
+			registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+		}
+	};
+
+	thread_local ThreadCounters threadCounters;
+
+	const char* const PROBE_NAMES[Metrics::NUM_PROBES] = {
+		"execute enter", "execute leave", "execute move", "execute destroy", "execute nothing",
+		"camera change",
+		"notify",
+		"get move markers",
+		"draw board", "draw overlays", "draw pieces", "draw ui", "draw debug", "draw hud", "draw display",
+		"wait", "input latency",
+		"load file", "load piece defs", "load textures", "load board", "load initialize"
+	};
+}
+
+// Helpers
+
+/**
+ * Get an upper bound on the given fraction of the calls, in nanoseconds
+ */
+std::uint64_t Metrics::Histogram::percentile(double fraction) const {
+	const std::uint64_t target = std::max<std::uint64_t>(1, fraction * count + 0.5);
+	std::uint64_t seen = 0;
+	for (unsigned int i = 0; i < NUM_BUCKETS; i++) {
+		seen += buckets[i];
+		if (seen >= target) {
+			return i == 0 ? 0 : std::min(std::uint64_t(1) << i, maxNanos);
+		}
+	}
+
+	return maxNanos;
+}
+
+// Public API
+
+/**
+ * Get the name of a probe
+ */
+const char* Metrics::getName(Probe probe) {
+	return PROBE_NAMES[probe];
+}
+
+/**
+ * Record one call to a probe on the calling thread
+ */
+void Metrics::record(Probe probe, std::uint64_t nanos) {
+	Counters& counters = threadCounters.counters;
+	add(counters.count[probe], 1);
+	add(counters.totalNanos[probe], nanos);
+	raise(counters.maxNanos[probe], nanos);
+
+	// Find the power of two above the time taken
+	const unsigned int bucket = nanos == 0 ? 0 : 64 - __builtin_clzll(nanos);
+	add(counters.buckets[probe][std::min(bucket, NUM_BUCKETS - 1)], 1);
+}
+
+/**
+ * Add up the counters for a probe over every thread
+ */
+Metrics::Histogram Metrics::read(Probe probe) {
+	Histogram histogram{};
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	addTo(histogram, registry.finished, probe);
+	for (std::vector<const ThreadCounters*>::const_iterator i = registry.threads.begin(); i != registry.threads.end();
+		++i
+	) {
+		addTo(histogram, (*i)->counters, probe);
+	}
+
+	return histogram;
+}
+
+/**
+ * Change a gauge by an amount on the calling thread
+ */
+void Metrics::adjust(Gauge gauge, std::int64_t delta) {
+	add(threadCounters.counters.gauges[gauge], delta);
+}
+
+/**
+ * Add up the changes to a gauge over every thread. A thread's changes may be negative, when it destroys what another
+ * thread created.
+ */
+std::int64_t Metrics::read(Gauge gauge) {
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	std::int64_t value = registry.finished.gauges[gauge].load(std::memory_order_relaxed);
+	for (std::vector<const ThreadCounters*>::const_iterator i = registry.threads.begin(); i != registry.threads.end();
+		++i
+	) {
+		value += (*i)->counters.gauges[gauge].load(std::memory_order_relaxed);
+	}
+
+	return value;
+}
+
+/**
+ * Count a heap allocation on the calling thread
+ */
+void Metrics::countAllocation() {
+	add(threadAllocations, 1);
+
+	// Using the thread's counters for the first time registers them, which allocates, so the flag is set first to
+	// count those allocations without registering again
+	if (!allocationsRegistered) {
+		allocationsRegistered = true;
+		static_cast<void>(threadCounters);
+	}
+}
+
+/**
+ * Get the number of heap allocations made so far on every thread. The allocations that a thread makes after its
+ * counters are destroyed, as it finishes, are not counted.
+ */
+std::uint64_t Metrics::getAllocations() {
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	std::uint64_t value = registry.finishedAllocations.load(std::memory_order_relaxed);
+	for (std::vector<const ThreadCounters*>::const_iterator i = registry.threads.begin(); i != registry.threads.end();
+		++i
+	) {
+		value += (*i)->allocations->load(std::memory_order_relaxed);
+	}
+
+	return value;
+}
+
+/**
+ * Get a one line summary of a probe, or an empty string if it has not been called
+ */
+std::string Metrics::summarize(Probe probe) {
+	const Histogram histogram = read(probe);
+	if (histogram.count == 0) return "";
+
+	std::ostringstream s;
+	s << std::fixed << std::setprecision(1);
+	s << getName(probe) << ": " << histogram.count << " calls, mean " << (histogram.mean() / 1000) << " us, p99 " <<
+		(histogram.percentile(0.99) / 1000.) << " us";
+	return s.str();
+}
+
+/**
+ * Get a table of every probe with its histogram. Each bucket is written as the upper bound of the time taken in
+ * nanoseconds and the number of calls.
+ */
+std::string Metrics::toString() {
+	std::ostringstream s;
+	s << std::fixed << std::setprecision(3);
+	s << "probe,count,total ms,mean us,p50 us,p99 us,max us,buckets" << std::endl;
+	for (unsigned int probe = 0; probe < NUM_PROBES; probe++) {
+		const Histogram histogram = read((Probe) probe);
+		s << getName((Probe) probe) << "," << histogram.count << "," << (histogram.totalNanos / 1e6) << "," <<
+			(histogram.mean() / 1e3) << "," << (histogram.percentile(0.5) / 1e3) << "," <<
+			(histogram.percentile(0.99) / 1e3) << "," << (histogram.maxNanos / 1e3) << ",";
+
+		for (unsigned int i = 0; i < NUM_BUCKETS; i++) {
+			if (histogram.buckets[i] == 0) continue;
+			s << " " << (i == 0 ? 0 : std::uint64_t(1) << i) << ":" << histogram.buckets[i];
+		}
+
+		s << std::endl;
+	}
+
+	return s.str();
+}
+
@@ -0,0 +1,146 @@
+#ifndef CHESS_METRICS_H
+#define CHESS_METRICS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Class declaration
+
+/**
+ * Counters and latency histograms for the hot paths of the game, cheap enough to leave on in release builds.
+ *
+ * Each thread records into its own counters, so recording never takes a lock. Reading adds up the counters of every
+ * thread, including threads that have finished.
+ */
+class Metrics {
+public:
+	// Helper enums
+
+	/**
+	 * The places that are timed
+	 */
+	enum Probe {
+		EXECUTE_ENTER, EXECUTE_LEAVE, EXECUTE_MOVE, EXECUTE_DESTROY, EXECUTE_NOTHING,
+		CAMERA_CHANGE,
+		NOTIFY,
+		GET_MOVE_MARKERS,
+		DRAW_BOARD, DRAW_OVERLAYS, DRAW_PIECES, DRAW_UI, DRAW_DEBUG, DRAW_HUD, DRAW_DISPLAY,
+		WAIT, INPUT_LATENCY,
+		LOAD_FILE, LOAD_PIECE_DEFS, LOAD_TEXTURES, LOAD_BOARD, LOAD_INITIALIZE,
+		NUM_PROBES
+	};
+
+	/**
+	 * The things that are counted as they are created and destroyed
+	 */
+	enum Gauge {
+		MOVE_MARKERS,
+		NUM_GAUGES
+	};
+
+	// Constants
+
+	/**
+	 * Bucket 0 counts calls that took no time, and bucket i counts calls that took from 2^(i-1) up to 2^i ns. The last
+	 * bucket also counts anything slower.
+	 */
+	static const unsigned int NUM_BUCKETS = 40;
+
+	// Helper structs
+
+	/**
+	 * The counters for one probe, added up over every thread
+	 */
+	struct Histogram {
+		std::uint64_t count;
+		std::uint64_t totalNanos;
+		std::uint64_t maxNanos;
+		std::uint64_t buckets[NUM_BUCKETS];
+
+		/**
+		 * Get an upper bound on the given fraction of the calls, in nanoseconds
+		 */
+		std::uint64_t percentile(double fraction) const;
+
+		/**
+		 * Get the mean time taken, in nanoseconds
+		 */
+		inline double mean() const {
+			return count == 0 ? 0 : (double) totalNanos / count;
+		}
+	};
+
+	/**
+	 * Times a scope and records it when it ends
+	 */
+	class Timer {
+	private:
+		const Probe probe;
+		const std::chrono::steady_clock::time_point start;
+
+	public:
+		// Constructors
+		inline Timer(Probe probe_) :
+			probe{probe_},
+			start{std::chrono::steady_clock::now()}
+		{
+		}
+
+		inline ~Timer() {
+			record(probe, std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - start
+			).count());
+		}
+	};
+
+	// Public API
+
+	/**
+	 * Get the name of a probe
+	 */
+	static const char* getName(Probe probe);
+
+	/**
+	 * Record one call to a probe on the calling thread
+	 */
+	static void record(Probe probe, std::uint64_t nanos);
+
+	/**
+	 * Add up the counters for a probe over every thread
+	 */
+	static Histogram read(Probe probe);
+
+	/**
+	 * Change a gauge by an amount on the calling thread
+	 */
+	static void adjust(Gauge gauge, std::int64_t delta);
+
+	/**
+	 * Add up the changes to a gauge over every thread
+	 */
+	static std::int64_t read(Gauge gauge);
+
+	/**
+	 * Count a heap allocation on the calling thread. Allocations are only counted in the targets that link
+	 * allocations.cpp, which replaces operator new.
+	 */
+	static void countAllocation();
+
+	/**
+	 * Get the number of heap allocations made so far on every thread
+	 */
+	static std::uint64_t getAllocations();
+
+	/**
+	 * Get a one line summary of a probe, or an empty string if it has not been called
+	 */
+	static std::string summarize(Probe probe);
+
+	/**
+	 * Get a table of every probe with its histogram
+	 */
+	static std::string toString();
+};
+
+#endif // CHESS_METRICS_H
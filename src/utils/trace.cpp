@@ -0,0 +1,170 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+	// Helper structs
+
+	/**
+	 * One span, with times in nanoseconds. The fields are atomic so that they can be read while the owning thread
+	 * overwrites them.
+	 */
+	struct Slot {
+		std::atomic<const char*> name{nullptr};
+		std::atomic<std::int64_t> start{0};
+		std::atomic<std::int64_t> duration{0};
+	};
+
+	/**
+	 * A ring buffer of spans that is only written by one thread at a time
+	 */
+	struct Buffer {
+		const unsigned int id;
+		std::atomic<std::uint64_t> written{0};
+		Slot slots[Trace::SPANS_PER_THREAD];
+
+		Buffer(unsigned int id_) : id{id_} {}
+	};
+
+	/**
+	 * Every buffer that has been created, and the buffers that are not used by a thread
+	 */
+	struct Registry {
+		std::mutex mutex;
+		std::vector<Buffer*> buffers;
+		std::vector<Buffer*> unused;
+
+		~Registry() {
+			for (std::vector<Buffer*>::iterator i = buffers.begin(); i != buffers.end(); ++i) {
+				delete *i;
+			}
+		}
+	};
+
+	/**
+	 * A span copied out of a buffer
+	 */
+	struct Copy {
+		const char* name;
+		std::int64_t start;
+		std::int64_t duration;
+	};
+
+	// Helpers
+
+	/**
+	 * Get the registry, which is created the first time that a thread records a span
+	 */
+	Registry& getRegistry() {
+		static Registry registry;
+		return registry;
+	}
+
+	/**
+	 * The buffer used by a thread for as long as it runs
+	 */
+	class ThreadBuffer {
+	public:
+		Buffer* buffer;
+
+		ThreadBuffer() {
+			Registry& registry = getRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			if (registry.unused.empty()) {
+				buffer = new Buffer(registry.buffers.size());
+				registry.buffers.push_back(buffer);
+			} else {
+				buffer = registry.unused.back();
+				registry.unused.pop_back();
+			}
+		}
+
+		~ThreadBuffer() {
+			Registry& registry = getRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			registry.unused.push_back(buffer);
+		}
+	};
+
+	thread_local ThreadBuffer threadBuffer;
+
+	inline std::int64_t toNanos(std::chrono::steady_clock::time_point time) {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+	}
+}
+
+// Public API
+
+/**
+ * Record a span on the calling thread
+ */
+void Trace::record(
+	const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end
+) {
+	Buffer* buffer = threadBuffer.buffer;
+	const std::uint64_t index = buffer->written.load(std::memory_order_relaxed);
+	Slot& slot = buffer->slots[index % SPANS_PER_THREAD];
+	slot.name.store(name, std::memory_order_relaxed);
+	slot.start.store(toNanos(start), std::memory_order_relaxed);
+	slot.duration.store(toNanos(end) - toNanos(start), std::memory_order_relaxed);
+
+	// Publish the span
+	buffer->written.store(index + 1, std::memory_order_release);
+}
+
+/**
+ * Get the spans kept for every thread as Chrome trace event JSON, with times in microseconds
+ *
+ * Threads keep recording while their buffers are copied, so any span that may have been overwritten during the copy
+ * is left out.
+ */
+std::string Trace::toJson() {
+	std::ostringstream s;
+	s << std::fixed << std::setprecision(3);
+	s << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	bool first = true;
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	for (std::vector<Buffer*>::const_iterator i = registry.buffers.begin(); i != registry.buffers.end(); ++i) {
+		const Buffer* buffer = *i;
+
+		// Copy the spans that have been published
+		const std::uint64_t end = buffer->written.load(std::memory_order_acquire);
+		const std::uint64_t begin = end > SPANS_PER_THREAD ? end - SPANS_PER_THREAD : 0;
+		std::vector<Copy> spans;
+		spans.reserve(end - begin);
+		for (std::uint64_t j = begin; j < end; j++) {
+			const Slot& slot = buffer->slots[j % SPANS_PER_THREAD];
+			spans.push_back(Copy{
+				slot.name.load(std::memory_order_relaxed),
+				slot.start.load(std::memory_order_relaxed),
+				slot.duration.load(std::memory_order_relaxed)
+			});
+		}
+
+		// Leave out the spans that were overwritten while copying
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const std::uint64_t overwritten = buffer->written.load(std::memory_order_relaxed);
+		const std::uint64_t valid = overwritten >= SPANS_PER_THREAD ? overwritten - SPANS_PER_THREAD + 1 : 0;
+
+		// Name the thread
+		s << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id <<
+			",\"args\":{\"name\":\"thread " << buffer->id << "\"}}";
+		first = false;
+
+		for (std::uint64_t j = std::max(begin, valid); j < end; j++) {
+			const Copy& span = spans[j - begin];
+			s << ",\n{\"name\":\"" << span.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id <<
+				",\"ts\":" << (span.start / 1e3) << ",\"dur\":" << (span.duration / 1e3) << "}";
+		}
+	}
+
+	s << "\n]}\n";
+	return s.str();
+}
@@ -0,0 +1,64 @@
+#ifndef CHESS_TRACE_H
+#define CHESS_TRACE_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Class declaration
+
+/**
+ * A timeline of the most recent spans on each thread, which can be written as Chrome trace event JSON and opened in
+ * a trace viewer such as Perfetto or chrome://tracing.
+ *
+ * Each thread writes its spans into its own ring buffer without taking a lock, overwriting the oldest spans once it
+ * is full. The buffers of finished threads are reused by new threads, so they keep their spans until then.
+ */
+class Trace {
+public:
+	// Constants
+
+	/**
+	 * The number of spans kept for each thread
+	 */
+	static const unsigned int SPANS_PER_THREAD = 1 << 14;
+
+	// Helper classes
+
+	/**
+	 * Records a scope as a span when it ends. The name must outlive the trace, so it should be a string literal.
+	 */
+	class Span {
+	private:
+		const char* const name;
+		const std::chrono::steady_clock::time_point start;
+
+	public:
+		// Constructors
+		inline Span(const char* name_) :
+			name{name_},
+			start{std::chrono::steady_clock::now()}
+		{
+		}
+
+		inline ~Span() {
+			record(name, start, std::chrono::steady_clock::now());
+		}
+	};
+
+	// Public API
+
+	/**
+	 * Record a span on the calling thread
+	 */
+	static void record(
+		const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end
+	);
+
+	/**
+	 * Get the spans kept for every thread as Chrome trace event JSON
+	 */
+	static std::string toJson();
+};
+
+#endif // CHESS_TRACE_H
@@ -0,0 +1,90 @@
+#ifndef CHESS_TRIPLE_BUFFER_H
+#define CHESS_TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// Class declaration
+
+/**
+ * Three buffers that pass values from one writing thread to one reading thread without taking a lock. The writer
+ * always has a buffer to fill, and the reader always has the latest complete buffer to read, so neither waits for the
+ * other. Values that the reader does not take before the next one is published are skipped.
+ */
+template <typename T>
+class TripleBuffer {
+private:
+	// Constants
+
+	/**
+	 * Set in the shared index when the buffer that it refers to has been published and not yet taken
+	 */
+	static const unsigned int FRESH = 4;
+
+	// Members
+	T buffers[3];
+
+	/**
+	 * The buffer that is passed between the threads, which is neither being written nor read
+	 */
+	std::atomic<unsigned int> shared;
+
+	unsigned int writing;
+	unsigned int reading;
+
+public:
+	// Constructors
+	inline TripleBuffer() :
+		shared{2},
+		writing{0},
+		reading{1}
+	{
+	}
+
+	// Writer API
+
+	/**
+	 * Get the buffer to fill, which keeps whatever was written to it three publishes ago
+	 */
+	inline T& getWriteBuffer() {
+		return buffers[writing];
+	}
+
+	/**
+	 * Publish the buffer that was filled, and take the shared buffer to fill next
+	 */
+	inline void publish() {
+		writing = shared.exchange(writing | FRESH, std::memory_order_acq_rel) & ~FRESH;
+	}
+
+	// Reader API
+
+	/**
+	 * Whether a buffer has been published that has not been taken yet
+	 */
+	inline bool isFresh() const {
+		return (shared.load(std::memory_order_relaxed) & FRESH) != 0;
+	}
+
+	/**
+	 * Take the latest published buffer, if there is one that has not been taken yet
+	 *
+	 * @return true if a new buffer was taken
+	 */
+	inline bool update() {
+		if (!isFresh()) {
+			return false;
+		}
+
+		reading = shared.exchange(reading, std::memory_order_acq_rel) & ~FRESH;
+		return true;
+	}
+
+	/**
+	 * Get the buffer that was taken last
+	 */
+	inline const T& getReadBuffer() const {
+		return buffers[reading];
+	}
+};
+
+#endif // CHESS_TRIPLE_BUFFER_H
@@ -0,0 +1,85 @@
+#include "workerPool.h"
+
+// Helpers
+
+/**
+ * Wait for tasks and take part in the ones that need this worker, until the pool is destroyed
+ */
+void WorkerPool::work(unsigned int index) {
+	unsigned int seen = 0;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		taskStarted.wait(lock, [this, seen]{ return stopping || generation != seen; });
+		if (stopping) break;
+
+		seen = generation;
+		if (index > numJoining) continue;
+
+		lock.unlock();
+		(*task)(index);
+		lock.lock();
+
+		if (--numBusy == 0) {
+			taskFinished.notify_one();
+		}
+	}
+}
+
+
+
+// Constructors
+
+WorkerPool::WorkerPool() :
+	task{nullptr},
+	numJoining{0},
+	numBusy{0},
+	generation{0},
+	stopping{false}
+{
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+
+	taskStarted.notify_all();
+	for (std::vector<std::thread>::iterator i = workers.begin(); i != workers.end(); ++i) {
+		i->join();
+	}
+}
+
+
+
+// Methods
+
+/**
+ * Run a task on the calling thread and on workers, and wait for all of them to finish it
+ */
+void WorkerPool::run(unsigned int numThreads, const std::function<void(unsigned int)>& task_) {
+	if (numThreads < 2) {
+		task_(0);
+		return;
+	}
+
+	// Start the workers that have not been needed before
+	while (workers.size() < numThreads - 1) {
+		workers.push_back(std::thread(&WorkerPool::work, this, workers.size() + 1));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		task = &task_;
+		numJoining = numThreads - 1;
+		numBusy = numThreads - 1;
+		generation++;
+	}
+
+	taskStarted.notify_all();
+	task_(0);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	taskFinished.wait(lock, [this]{ return numBusy == 0; });
+	task = nullptr;
+}
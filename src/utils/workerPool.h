@@ -0,0 +1,60 @@
+#ifndef CHESS_WORKER_POOL_H
+#define CHESS_WORKER_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Class declaration
+
+/**
+ * Threads that are started once and kept waiting between tasks, so that splitting a task between threads only costs
+ * waking them. Workers are started the first time that a task needs them, so a pool that is only given tasks for one
+ * thread never starts any.
+ */
+class WorkerPool {
+private:
+	// Members
+	std::vector<std::thread> workers;
+
+	// The task being run, and the number of workers taking part in it and still running it
+	const std::function<void(unsigned int)>* task;
+	unsigned int numJoining;
+	unsigned int numBusy;
+
+	// Counts the tasks, so that the workers can tell when there is a new one
+	unsigned int generation;
+	bool stopping;
+
+	std::mutex mutex;
+	std::condition_variable taskStarted;
+	std::condition_variable taskFinished;
+
+	// Helpers
+
+	/**
+	 * Wait for tasks and take part in the ones that need this worker, until the pool is destroyed
+	 *
+	 * @param index the index that this worker passes to the tasks, starting from 1
+	 */
+	void work(unsigned int index);
+
+public:
+	// Constructors
+	WorkerPool();
+	~WorkerPool();
+
+	// Methods
+
+	/**
+	 * Run a task on the calling thread and on workers, and wait for all of them to finish it. The task is given the
+	 * index of the thread that runs it, which is 0 for the calling thread.
+	 *
+	 * @param numThreads the number of threads to run the task on, including the calling thread
+	 */
+	void run(unsigned int numThreads, const std::function<void(unsigned int)>& task_);
+};
+
+#endif // CHESS_WORKER_POOL_H